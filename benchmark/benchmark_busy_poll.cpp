@@ -0,0 +1,97 @@
+#include "uvio/core.hpp"
+#include "uvio/net.hpp"
+#include "uvio/sync.hpp"
+
+using namespace uvio;
+using namespace uvio::net;
+using namespace uvio::sync;
+
+// TCP ping-pong over loopback between a server on worker 0 and a client on
+// worker 1, with the loops blocking in poll against busy polling.
+// Usage: benchmark_busy_poll [rounds] [busy_poll_us]
+
+constexpr int PORT{12351};
+
+auto elapsed_ns(std::chrono::steady_clock::time_point start) -> double {
+    return static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count());
+}
+
+auto server(TcpListener &listener, std::size_t rounds) -> Task<> {
+    auto stream = (co_await listener.accept()).value();
+    std::array<char, 8> buf{};
+    for (std::size_t i = 0; i < rounds; i++) {
+        if (auto ret = co_await stream.read_exact(buf); !ret) {
+            co_return;
+        }
+        if (auto ret = co_await stream.write(buf); !ret) {
+            co_return;
+        }
+    }
+}
+
+auto client(Latch &done, std::size_t rounds) -> Task<> {
+    auto stream = (co_await TcpStream::connect("127.0.0.1", PORT)).value();
+    std::array<char, 8> buf{};
+    for (std::size_t i = 0; i < rounds; i++) {
+        if (auto ret = co_await stream.write(buf); !ret) {
+            break;
+        }
+        if (auto ret = co_await stream.read_exact(buf); !ret) {
+            break;
+        }
+    }
+    done.count_down();
+}
+
+auto bench(std::string_view name, std::size_t rounds, RuntimeOptions options) {
+    Runtime runtime{2, std::move(options)};
+    auto    start = std::chrono::steady_clock::now();
+    runtime.block_on([](Runtime &runtime, std::size_t rounds) -> Task<> {
+        TcpListener listener;
+        if (auto ret = listener.bind("127.0.0.1", PORT); !ret) {
+            co_return;
+        }
+        Latch done{1};
+        runtime.spawn_on(1, client(done, rounds));
+        co_await server(listener, rounds);
+        co_await done.wait();
+    }(runtime, rounds));
+    auto ns = elapsed_ns(start);
+
+    std::chrono::nanoseconds spin_time{0};
+    std::chrono::nanoseconds work_time{0};
+    std::size_t              parks = 0;
+    for (std::size_t id = 0; id < runtime.num_workers(); id++) {
+        auto stats = runtime.worker_stats(id);
+        spin_time += stats.spin_time;
+        work_time += stats.work_time;
+        parks += stats.parks;
+    }
+    console.info("{}: {:.1f} ns/round trip, spin {} ms, work {} ms, {} parks",
+                 name,
+                 ns / static_cast<double>(rounds),
+                 spin_time.count() / 1'000'000,
+                 work_time.count() / 1'000'000,
+                 parks);
+}
+
+auto main(int argc, char **argv) -> int {
+    std::size_t rounds = 100'000;
+    std::size_t busy_poll_us = 50;
+    if (argc > 1) {
+        rounds = std::stoul(argv[1]);
+    }
+    if (argc > 2) {
+        busy_poll_us = std::stoul(argv[2]);
+    }
+
+    bench("blocking  ", rounds, RuntimeOptions{});
+    bench("busy poll ",
+          rounds,
+          RuntimeOptions{
+              .busy_poll = std::chrono::microseconds{busy_poll_us},
+          });
+}
@@ -0,0 +1,81 @@
+#include "uvio/core.hpp"
+#include "uvio/sync.hpp"
+
+using namespace uvio;
+using namespace uvio::sync;
+
+// Throughput of `channel` and `unbounded_channel`: one producer per worker
+// sends to a consumer on worker 0, small capacities make the producers wait.
+// Usage: benchmark_channel [num_workers] [values_per_producer]
+
+auto elapsed_ns(std::chrono::steady_clock::time_point start) -> double {
+    return static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count());
+}
+
+template <typename S>
+auto produce(S sender, std::size_t count) -> Task<> {
+    for (std::size_t i = 0; i < count; i++) {
+        if (auto ret = co_await sender.send(i); !ret) {
+            co_return;
+        }
+    }
+}
+
+template <typename S, typename R>
+auto consume(Runtime &runtime, S sender, R receiver, std::size_t count)
+    -> Task<> {
+    for (std::size_t i = 0; i < runtime.num_workers(); i++) {
+        runtime.spawn_on(i, produce(sender, count));
+    }
+    {
+        auto dropped = std::move(sender);
+    }
+    std::size_t sum = 0;
+    while (true) {
+        auto ret = co_await receiver.recv();
+        if (!ret) {
+            break;
+        }
+        sum += *ret;
+    }
+    assert(sum == runtime.num_workers() * count * (count - 1) / 2);
+}
+
+template <typename MakeChannel>
+auto bench(std::string_view name,
+           std::size_t      num_workers,
+           std::size_t      count,
+           MakeChannel    &&make_channel) {
+    Runtime runtime{num_workers};
+    auto [sender, receiver] = make_channel();
+    auto start = std::chrono::steady_clock::now();
+    runtime.block_on(
+        consume(runtime, std::move(sender), std::move(receiver), count));
+    console.info("{}: {:.1f} ns/value",
+                 name,
+                 elapsed_ns(start) / static_cast<double>(num_workers * count));
+}
+
+auto main(int argc, char **argv) -> int {
+    std::size_t num_workers = 4;
+    std::size_t count = 1'000'000;
+    if (argc > 1) {
+        num_workers = std::stoul(argv[1]);
+    }
+    if (argc > 2) {
+        count = std::stoul(argv[2]);
+    }
+
+    bench("channel(16)        ", num_workers, count, [] {
+        return channel<std::size_t>(16);
+    });
+    bench("channel(1024)      ", num_workers, count, [] {
+        return channel<std::size_t>(1024);
+    });
+    bench("unbounded_channel()", num_workers, count, [] {
+        return unbounded_channel<std::size_t>();
+    });
+}
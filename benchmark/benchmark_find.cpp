@@ -0,0 +1,122 @@
+#include "uvio/core.hpp"
+#include "uvio/io.hpp"
+
+using namespace uvio;
+using uvio::io::detail::StreamBuffer;
+
+// Delimiter search on header-sized inputs: std::string_view::find() against
+// uvio::detail::find_flag(), then the searches of a
+// read_until("\r\n\r\n") on headers arriving `chunk` bytes at a time,
+// rescanning from the start after every read against resuming.
+// Usage: benchmark_find [rounds] [chunk]
+
+auto elapsed_ns(std::chrono::steady_clock::time_point start) -> double {
+    return static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count());
+}
+
+auto make_headers(std::size_t size) -> std::string {
+    std::string headers{"GET /index.html HTTP/1.1\r\nHost: localhost\r\n"};
+    for (int i = 0; headers.size() + 4 < size; i++) {
+        headers += "X-Header-" + std::to_string(i) + ": "
+                   + std::string(40, static_cast<char>('a' + i % 26)) + "\r\n";
+    }
+    headers.resize(size - 4);
+    headers += "\r\n\r\n";
+    return headers;
+}
+
+template <typename F>
+auto measure(std::size_t rounds, F &&f) -> double {
+    std::size_t sum = 0;
+    auto        start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < rounds; i++) {
+        sum += f();
+        // Keeps the searches from being hoisted out of the loop
+        asm volatile("" ::: "memory");
+    }
+    auto ns = elapsed_ns(start) / static_cast<double>(rounds);
+    if (sum == 0) {
+        console.info("not found");
+    }
+    return ns;
+}
+
+auto bench_search(std::size_t size, std::size_t rounds) {
+    auto             headers = make_headers(size);
+    std::string_view view{headers};
+
+    auto std_find = measure(rounds, [&] {
+        return view.find("\r\n\r\n");
+    });
+    auto uvio_find = measure(rounds, [&] {
+        return uvio::detail::find_flag(view, "\r\n\r\n");
+    });
+    console.info("{:>5} B: std::string_view::find {:>7.1f} ns, find_flag "
+                 "{:>7.1f} ns",
+                 size,
+                 std_find,
+                 uvio_find);
+}
+
+// Headers fed `chunk` bytes at a time, searched after every chunk
+template <typename Search>
+auto feed(const std::string &headers, std::size_t chunk, Search &&search)
+    -> std::size_t {
+    StreamBuffer buffer{headers.size()};
+    std::size_t  from = 0;
+    for (std::size_t offset = 0; offset < headers.size(); offset += chunk) {
+        buffer.read_from(std::string_view{headers}.substr(offset, chunk));
+        if (auto pos = search(buffer, from); pos != std::string_view::npos) {
+            return pos;
+        }
+        from = uvio::io::detail::resume_search_at(
+            static_cast<std::size_t>(buffer.r_remaining()),
+            "\r\n\r\n");
+    }
+    return 0;
+}
+
+auto bench_read_until(std::size_t size, std::size_t chunk, std::size_t rounds) {
+    auto headers = make_headers(size);
+    auto rescan = measure(rounds, [&] {
+        return feed(headers, chunk, [](StreamBuffer &buffer, std::size_t) {
+            auto readable = buffer.r_slice();
+            return std::string_view{readable.data(), readable.size()}.find(
+                "\r\n\r\n");
+        });
+    });
+    auto resume = measure(rounds, [&] {
+        return feed(headers,
+                    chunk,
+                    [](StreamBuffer &buffer, std::size_t from) {
+                        return buffer.find("\r\n\r\n", from);
+                    });
+    });
+    console.info("{:>5} B in {} B reads: rescan {:>8.1f} ns, resume {:>8.1f} "
+                 "ns",
+                 size,
+                 chunk,
+                 rescan,
+                 resume);
+}
+
+auto main(int argc, char **argv) -> int {
+    std::size_t rounds = 100'000;
+    std::size_t chunk = 64;
+    if (argc > 1) {
+        rounds = std::stoul(argv[1]);
+    }
+    if (argc > 2) {
+        chunk = std::stoul(argv[2]);
+    }
+
+    for (std::size_t size : {256, 1024, 4096, 16384}) {
+        bench_search(size, rounds);
+    }
+    for (std::size_t size : {256, 1024, 4096, 16384}) {
+        bench_read_until(size, chunk, rounds / 10);
+    }
+}
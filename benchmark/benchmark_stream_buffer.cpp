@@ -0,0 +1,107 @@
+#include "uvio/core.hpp"
+#include "uvio/io.hpp"
+
+using namespace uvio;
+using uvio::io::detail::StreamBuffer;
+
+// A stream of fixed-size messages parsed out of a read buffer the way
+// ImplBufRead::read_exact() does it, with a flat buffer compacted by copying
+// against the mirrored ring. Socket reads are simulated by copies of between
+// `chunk / 2` and `chunk` bytes.
+// Usage: benchmark_stream_buffer [buffer_size] [chunk] [total_mib]
+
+auto elapsed_ns(std::chrono::steady_clock::time_point start) -> double {
+    return static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count());
+}
+
+struct Source {
+    std::vector<char> data_;
+    std::size_t       pos_{0};
+    std::size_t       chunk_;
+    std::size_t       reads_{0};
+
+    // Like TCP reads, not aligned with the messages
+    auto read(std::span<char> buf) -> std::size_t {
+        auto chunk = chunk_ - (reads_ * 1237) % (chunk_ / 2);
+        auto len = (std::min)({buf.size(), chunk, data_.size() - pos_});
+        std::copy_n(data_.data() + pos_, len, buf.data());
+        reads_++;
+        pos_ = (pos_ + len) % data_.size();
+        return len;
+    }
+};
+
+auto bench(std::string_view name,
+           StreamBuffer     buffer,
+           std::size_t      message_size,
+           std::size_t      chunk,
+           std::size_t      total) {
+    Source source{std::vector<char>(1024 * 1024, 'x'), 0, chunk, 0};
+    std::vector<char> message(message_size);
+    auto              exact_bytes = static_cast<int>(message_size);
+    auto              messages = total / message_size;
+    std::size_t       compacted = 0;
+    std::size_t       checksum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < messages; i++) {
+        while (buffer.r_remaining() < exact_bytes) {
+            if (buffer.w_remaining() < exact_bytes) {
+                auto unread = buffer.r_begin();
+                buffer.reset_data();
+                if (buffer.r_begin() != unread) {
+                    compacted += buffer.r_slice().size();
+                }
+            }
+            buffer.w_increase(source.read(buffer.w_slice()));
+        }
+        buffer.write_to(message);
+        checksum += static_cast<std::size_t>(message[message_size / 2]);
+    }
+    auto ns = elapsed_ns(start);
+
+    console.info("{} {:>5} B messages: {:>7.1f} ns/message, {:>5.2f} GiB/s, "
+                 "{:>5.2f} reads/message, {:>7.1f} bytes copied/message ({})",
+                 name,
+                 message_size,
+                 ns / static_cast<double>(messages),
+                 static_cast<double>(messages * message_size) / ns
+                     / 1.073741824,
+                 static_cast<double>(source.reads_)
+                     / static_cast<double>(messages),
+                 static_cast<double>(compacted)
+                     / static_cast<double>(messages),
+                 checksum);
+}
+
+auto main(int argc, char **argv) -> int {
+    std::size_t buffer_size = 64 * 1024;
+    std::size_t chunk = 16 * 1024;
+    std::size_t total_mib = 1024;
+    if (argc > 1) {
+        buffer_size = std::stoul(argv[1]);
+    }
+    if (argc > 2) {
+        chunk = std::stoul(argv[2]);
+    }
+    if (argc > 3) {
+        total_mib = std::stoul(argv[3]);
+    }
+
+    for (std::size_t message_size = 1024; message_size <= buffer_size;
+         message_size *= 2) {
+        bench("flat",
+              StreamBuffer::flat(buffer_size),
+              message_size,
+              chunk,
+              total_mib * 1024 * 1024);
+        bench("ring",
+              StreamBuffer{buffer_size},
+              message_size,
+              chunk,
+              total_mib * 1024 * 1024);
+    }
+}
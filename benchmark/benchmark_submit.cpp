@@ -0,0 +1,100 @@
+#include "uvio/core.hpp"
+#include "uvio/sync.hpp"
+
+using namespace uvio;
+using namespace uvio::sync;
+
+// Round trip of a task run on another worker: `Runtime::submit_to()` over
+// the per-pair SPSC mailboxes, against `spawn_on()` through the shared inbox
+// with the result sent back over a oneshot channel. Every worker runs
+// clients sending their requests to the next worker.
+// Usage: benchmark_submit [num_workers] [clients_per_worker] [rounds]
+
+auto elapsed_ns(std::chrono::steady_clock::time_point start) -> double {
+    return static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count());
+}
+
+auto increment(std::size_t value) -> Task<std::size_t> {
+    co_return value + 1;
+}
+
+auto reply(std::size_t value, OneshotSender<std::size_t> sender) -> Task<> {
+    auto ret = sender.send(co_await increment(value));
+    (void)ret;
+}
+
+auto with_submit_to(Runtime &runtime, Latch &done, std::size_t rounds)
+    -> Task<> {
+    auto        target = (current_worker_id() + 1) % runtime.num_workers();
+    std::size_t value = 0;
+    for (std::size_t i = 0; i < rounds; i++) {
+        value = co_await runtime.submit_to(target, increment(value));
+    }
+    done.count_down();
+}
+
+auto with_spawn_on(Runtime &runtime, Latch &done, std::size_t rounds)
+    -> Task<> {
+    auto        target = (current_worker_id() + 1) % runtime.num_workers();
+    std::size_t value = 0;
+    for (std::size_t i = 0; i < rounds; i++) {
+        auto [sender, receiver] = oneshot<std::size_t>();
+        runtime.spawn_on(target, reply(value, std::move(sender)));
+        value = (co_await receiver.recv()).value();
+    }
+    done.count_down();
+}
+
+template <typename Client>
+auto bench(std::string_view name,
+           std::size_t      num_workers,
+           std::size_t      clients_per_worker,
+           std::size_t      rounds,
+           Client         &&client) {
+    Runtime runtime{num_workers};
+    auto    num_clients = num_workers * clients_per_worker;
+    auto    start = std::chrono::steady_clock::now();
+    runtime.block_on([](Runtime    &runtime,
+                        std::size_t num_clients,
+                        std::size_t rounds,
+                        Client     &client) -> Task<> {
+        Latch done{static_cast<std::ptrdiff_t>(num_clients)};
+        for (std::size_t i = 0; i < num_clients; i++) {
+            runtime.spawn_on(i % runtime.num_workers(),
+                             client(runtime, done, rounds));
+        }
+        co_await done.wait();
+    }(runtime, num_clients, rounds, client));
+    console.info("{}: {:.1f} ns/round trip",
+                 name,
+                 elapsed_ns(start) / static_cast<double>(num_clients * rounds));
+}
+
+auto main(int argc, char **argv) -> int {
+    std::size_t num_workers = 4;
+    std::size_t clients_per_worker = 16;
+    std::size_t rounds = 20'000;
+    if (argc > 1) {
+        num_workers = std::stoul(argv[1]);
+    }
+    if (argc > 2) {
+        clients_per_worker = std::stoul(argv[2]);
+    }
+    if (argc > 3) {
+        rounds = std::stoul(argv[3]);
+    }
+
+    bench("submit_to        ",
+          num_workers,
+          clients_per_worker,
+          rounds,
+          with_submit_to);
+    bench("spawn_on + oneshot",
+          num_workers,
+          clients_per_worker,
+          rounds,
+          with_spawn_on);
+}
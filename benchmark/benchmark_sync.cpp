@@ -0,0 +1,155 @@
+#include "uvio/core.hpp"
+#include "uvio/sync.hpp"
+
+#include <mutex>
+
+using namespace uvio;
+using namespace uvio::sync;
+
+// Lock/unlock cost of `sync::Mutex` and `sync::Semaphore` against
+// `std::mutex`, alone and with every worker of a runtime hammering the same
+// lock from several tasks.
+// Usage: benchmark_sync [num_workers] [tasks_per_worker] [rounds]
+
+auto elapsed_ns(std::chrono::steady_clock::time_point start) -> double {
+    return static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count());
+}
+
+// Keeps the critical section from being optimized away
+std::size_t shared_counter = 0;
+
+auto bench_uncontended(std::size_t rounds) {
+    Mutex      mutex;
+    std::mutex std_mutex;
+    Semaphore  semaphore{1};
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < rounds; i++) {
+        if (mutex.try_lock()) {
+            shared_counter++;
+            mutex.unlock();
+        }
+    }
+    console.info("uncontended sync::Mutex:     {:.1f} ns/op",
+                 elapsed_ns(start) / static_cast<double>(rounds));
+
+    start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < rounds; i++) {
+        if (semaphore.try_acquire()) {
+            shared_counter++;
+            semaphore.release();
+        }
+    }
+    console.info("uncontended sync::Semaphore: {:.1f} ns/op",
+                 elapsed_ns(start) / static_cast<double>(rounds));
+
+    start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < rounds; i++) {
+        std::lock_guard lock{std_mutex};
+        shared_counter++;
+    }
+    console.info("uncontended std::mutex:      {:.1f} ns/op",
+                 elapsed_ns(start) / static_cast<double>(rounds));
+}
+
+auto with_mutex(Mutex &mutex, Latch &done, std::size_t rounds) -> Task<> {
+    for (std::size_t i = 0; i < rounds; i++) {
+        auto guard = co_await mutex.lock();
+        shared_counter++;
+    }
+    done.count_down();
+}
+
+auto with_semaphore(Semaphore &semaphore, Latch &done, std::size_t rounds)
+    -> Task<> {
+    for (std::size_t i = 0; i < rounds; i++) {
+        co_await semaphore.acquire();
+        shared_counter++;
+        semaphore.release();
+    }
+    done.count_down();
+}
+
+// Blocks the whole loop while waiting
+auto with_std_mutex(std::mutex &mutex, Latch &done, std::size_t rounds)
+    -> Task<> {
+    for (std::size_t i = 0; i < rounds; i++) {
+        {
+            std::lock_guard lock{mutex};
+            shared_counter++;
+        }
+        if (i % 64 == 0) {
+            co_await yield();
+        }
+    }
+    done.count_down();
+}
+
+template <typename MakeTask>
+auto bench_contended(std::string_view name,
+                     std::size_t      num_workers,
+                     std::size_t      tasks_per_worker,
+                     std::size_t      rounds,
+                     MakeTask       &&make_task) {
+    Runtime runtime{num_workers};
+    auto    num_tasks = num_workers * tasks_per_worker;
+    auto    start = std::chrono::steady_clock::now();
+    runtime.block_on([](Runtime     &runtime,
+                        std::size_t  num_tasks,
+                        MakeTask    &make_task) -> Task<> {
+        Latch done{static_cast<std::ptrdiff_t>(num_tasks)};
+        for (std::size_t i = 0; i < num_tasks; i++) {
+            runtime.spawn_on(i % runtime.num_workers(), make_task(done));
+        }
+        co_await done.wait();
+    }(runtime, num_tasks, make_task));
+    console.info("contended {}: {:.1f} ns/op",
+                 name,
+                 elapsed_ns(start) / static_cast<double>(num_tasks * rounds));
+}
+
+auto main(int argc, char **argv) -> int {
+    std::size_t num_workers = 4;
+    std::size_t tasks_per_worker = 16;
+    std::size_t rounds = 100'000;
+    if (argc > 1) {
+        num_workers = std::stoul(argv[1]);
+    }
+    if (argc > 2) {
+        tasks_per_worker = std::stoul(argv[2]);
+    }
+    if (argc > 3) {
+        rounds = std::stoul(argv[3]);
+    }
+
+    bench_uncontended(10'000'000);
+
+    Mutex mutex;
+    bench_contended("sync::Mutex    ",
+                    num_workers,
+                    tasks_per_worker,
+                    rounds,
+                    [&mutex, rounds](Latch &done) {
+                        return with_mutex(mutex, done, rounds);
+                    });
+    Semaphore semaphore{1};
+    bench_contended("sync::Semaphore",
+                    num_workers,
+                    tasks_per_worker,
+                    rounds,
+                    [&semaphore, rounds](Latch &done) {
+                        return with_semaphore(semaphore, done, rounds);
+                    });
+    std::mutex std_mutex;
+    bench_contended("std::mutex     ",
+                    num_workers,
+                    tasks_per_worker,
+                    rounds,
+                    [&std_mutex, rounds](Latch &done) {
+                        return with_std_mutex(std_mutex, done, rounds);
+                    });
+    console.info("counter: {}", shared_counter);
+}
@@ -0,0 +1,53 @@
+#include "uvio/core.hpp"
+
+using namespace uvio;
+
+// Cost of awaiting a task returning a heap-allocated payload, which the
+// awaiter used to receive by copy.
+// Usage: benchmark_task [payload_size] [rounds]
+
+auto elapsed_ns(std::chrono::steady_clock::time_point start) -> double {
+    return static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count());
+}
+
+auto make_string(std::size_t size) -> Task<Result<std::string>> {
+    co_return std::string(size, 'x');
+}
+
+auto make_vector(std::size_t size) -> Task<std::vector<std::string>> {
+    std::vector<std::string> lines(size / 64, std::string(64, 'x'));
+    co_return lines;
+}
+
+auto bench(std::size_t payload_size, std::size_t rounds) -> Task<> {
+    std::size_t total = 0;
+    auto        start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < rounds; i++) {
+        total += (co_await make_string(payload_size))->size();
+    }
+    console.info("Task<Result<std::string>>: {:.1f} ns/await",
+                 elapsed_ns(start) / static_cast<double>(rounds));
+
+    start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < rounds; i++) {
+        total += (co_await make_vector(payload_size)).size();
+    }
+    console.info("Task<std::vector<std::string>>: {:.1f} ns/await",
+                 elapsed_ns(start) / static_cast<double>(rounds));
+    console.info("{} bytes", total);
+}
+
+auto main(int argc, char **argv) -> int {
+    std::size_t payload_size = 4096;
+    std::size_t rounds = 1'000'000;
+    if (argc > 1) {
+        payload_size = std::stoul(argv[1]);
+    }
+    if (argc > 2) {
+        rounds = std::stoul(argv[2]);
+    }
+    block_on(bench(payload_size, rounds));
+}
@@ -0,0 +1,152 @@
+#include "uvio/core.hpp"
+#include "uvio/time.hpp"
+
+#include <random>
+
+using namespace uvio;
+using uvio::time::detail::TimerEntry;
+using uvio::time::detail::TimingWheel;
+
+// Arms and cancels millions of timers, on the timing wheel and on one
+// uv_timer_t per timer as `sleep` used to do.
+// Usage: benchmark_timer_wheel [num_timers] [rounds]
+
+static std::size_t fired = 0;
+
+auto elapsed_ns(std::chrono::steady_clock::time_point start) -> double {
+    return static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count());
+}
+
+auto random_timeouts(std::size_t count, uint64_t max) -> std::vector<uint64_t> {
+    std::mt19937                            gen{42};
+    std::uniform_int_distribution<uint64_t> dist{1, max};
+    std::vector<uint64_t>                   timeouts(count);
+    for (auto &timeout : timeouts) {
+        timeout = dist(gen);
+    }
+    return timeouts;
+}
+
+auto bench_wheel_arm_cancel(uv_loop_t                   *loop,
+                            const std::vector<uint64_t> &timeouts,
+                            std::size_t                  rounds) {
+    TimingWheel             wheel{loop};
+    std::vector<TimerEntry> entries(timeouts.size());
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t round = 0; round < rounds; round++) {
+        for (std::size_t i = 0; i < entries.size(); i++) {
+            wheel.arm(entries[i], timeouts[i], [](void *) {}, nullptr);
+        }
+        for (auto &entry : entries) {
+            entry.cancel();
+        }
+    }
+    auto ops = static_cast<double>(timeouts.size() * rounds);
+    console.info("wheel    arm+cancel: {:.1f} ns/timer",
+                 elapsed_ns(start) / ops);
+
+    wheel.close();
+    uv_run(loop, UV_RUN_DEFAULT);
+}
+
+auto bench_uv_timer_arm_cancel(uv_loop_t                   *loop,
+                               const std::vector<uint64_t> &timeouts,
+                               std::size_t                  rounds) {
+    std::vector<uv_timer_t> timers(timeouts.size());
+    for (auto &timer : timers) {
+        uv_timer_init(loop, &timer);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t round = 0; round < rounds; round++) {
+        for (std::size_t i = 0; i < timers.size(); i++) {
+            uv_timer_start(&timers[i], [](uv_timer_t *) {}, timeouts[i], 0);
+        }
+        for (auto &timer : timers) {
+            uv_timer_stop(&timer);
+        }
+    }
+    auto ops = static_cast<double>(timeouts.size() * rounds);
+    console.info("uv_timer start+stop: {:.1f} ns/timer",
+                 elapsed_ns(start) / ops);
+
+    for (auto &timer : timers) {
+        uv_close(reinterpret_cast<uv_handle_t *>(&timer), nullptr);
+    }
+    uv_run(loop, UV_RUN_DEFAULT);
+}
+
+auto bench_wheel_expire(uv_loop_t                   *loop,
+                        const std::vector<uint64_t> &timeouts) {
+    TimingWheel             wheel{loop};
+    std::vector<TimerEntry> entries(timeouts.size());
+
+    fired = 0;
+    uv_update_time(loop);
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < entries.size(); i++) {
+        wheel.arm(entries[i], timeouts[i], [](void *) { fired++; }, nullptr);
+    }
+    uv_run(loop, UV_RUN_DEFAULT);
+    console.info("wheel    expire all: {} timers in {:.1f} ms",
+                 fired,
+                 elapsed_ns(start) / 1e6);
+
+    wheel.close();
+    uv_run(loop, UV_RUN_DEFAULT);
+}
+
+auto bench_uv_timer_expire(uv_loop_t                   *loop,
+                           const std::vector<uint64_t> &timeouts) {
+    std::vector<uv_timer_t> timers(timeouts.size());
+
+    fired = 0;
+    uv_update_time(loop);
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < timers.size(); i++) {
+        uv_timer_init(loop, &timers[i]);
+        uv_timer_start(
+            &timers[i],
+            [](uv_timer_t *) { fired++; },
+            timeouts[i],
+            0);
+    }
+    uv_run(loop, UV_RUN_DEFAULT);
+    console.info("uv_timer expire all: {} timers in {:.1f} ms",
+                 fired,
+                 elapsed_ns(start) / 1e6);
+
+    for (auto &timer : timers) {
+        uv_close(reinterpret_cast<uv_handle_t *>(&timer), nullptr);
+    }
+    uv_run(loop, UV_RUN_DEFAULT);
+}
+
+auto main(int argc, char **argv) -> int {
+    std::size_t num_timers = 1'000'000;
+    std::size_t rounds = 5;
+    if (argc > 1) {
+        num_timers = std::stoul(argv[1]);
+    }
+    if (argc > 2) {
+        rounds = std::stoul(argv[2]);
+    }
+
+    uv_loop_t loop;
+    uv_loop_init(&loop);
+
+    // Idle/keepalive style timeouts, armed and cancelled before they expire
+    auto timeouts = random_timeouts(num_timers, 60'000);
+    bench_wheel_arm_cancel(&loop, timeouts, rounds);
+    bench_uv_timer_arm_cancel(&loop, timeouts, rounds);
+
+    auto short_timeouts = random_timeouts(num_timers, 200);
+    bench_wheel_expire(&loop, short_timeouts);
+    bench_uv_timer_expire(&loop, short_timeouts);
+
+    uv_loop_close(&loop);
+}
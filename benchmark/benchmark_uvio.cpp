@@ -30,12 +30,16 @@ auto process(TcpStream stream) -> Task<> {
     co_return;
 }
 
-auto server() -> Task<> {
+auto server(bool reuse_port) -> Task<> {
     std::string host{"127.0.0.1"};
     int         port{8000};
 
     auto listener = TcpListener();
-    listener.bind(host, port);
+    if (auto ret = listener.bind(host, port, {.reuse_port = reuse_port});
+        !ret) {
+        console.error("{}", ret.error().message());
+        co_return;
+    }
     console.info("Listening on {}:{} ...", host, port);
     while (true) {
         auto stream = (co_await listener.accept()).value();
@@ -43,7 +47,15 @@ auto server() -> Task<> {
     }
 }
 
-auto main() -> int {
+// Usage: benchmark_uvio [num_workers]
+auto main(int argc, char **argv) -> int {
     SET_LOG_LEVEL(LogLevel::WARN);
-    block_on(server());
+    std::size_t num_workers = 1;
+    if (argc > 1) {
+        num_workers = std::stoul(argv[1]);
+    }
+    Runtime runtime{num_workers};
+    runtime.block_on_each([reuse_port = num_workers > 1]() {
+        return server(reuse_port);
+    });
 }
@@ -0,0 +1,78 @@
+#include "uvio/core.hpp"
+#include "uvio/sync.hpp"
+
+using namespace uvio;
+using namespace uvio::sync;
+
+// Skewed load: worker 0 spawns every CPU-bound task with
+// `Runtime::spawn_stealable()`, the other workers start idle. Without work
+// stealing all of them run on worker 0.
+// Usage: benchmark_work_stealing [num_workers] [num_tasks] [task_us]
+
+auto elapsed_ns(std::chrono::steady_clock::time_point start) -> double {
+    return static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count());
+}
+
+auto crunch(std::chrono::microseconds duration, Latch &done) -> Task<> {
+    auto until = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < until) {
+    }
+    done.count_down();
+    co_return;
+}
+
+auto bench(std::string_view          name,
+           std::size_t               num_workers,
+           std::size_t               num_tasks,
+           std::chrono::microseconds duration,
+           bool                      work_stealing) {
+    RuntimeOptions options{.work_stealing = work_stealing};
+    Runtime        runtime{num_workers, options};
+    auto           start = std::chrono::steady_clock::now();
+    runtime.block_on([](Runtime                  &runtime,
+                        std::size_t               num_tasks,
+                        std::chrono::microseconds duration) -> Task<> {
+        Latch done{static_cast<std::ptrdiff_t>(num_tasks)};
+        for (std::size_t i = 0; i < num_tasks; i++) {
+            runtime.spawn_stealable(crunch(duration, done));
+        }
+        co_await done.wait();
+    }(runtime, num_tasks, duration));
+    auto ns = elapsed_ns(start);
+
+    std::size_t stolen = 0;
+    std::size_t failed_steals = 0;
+    for (std::size_t id = 0; id < num_workers; id++) {
+        auto stats = runtime.worker_stats(id);
+        stolen += stats.stolen;
+        failed_steals += stats.failed_steals;
+    }
+    console.info("{}: {:.1f} ms, {:.1f} ns/task, {} stolen, {} failed steals",
+                 name,
+                 ns / 1e6,
+                 ns / static_cast<double>(num_tasks),
+                 stolen,
+                 failed_steals);
+}
+
+auto main(int argc, char **argv) -> int {
+    std::size_t num_workers = 4;
+    std::size_t num_tasks = 10'000;
+    std::size_t task_us = 100;
+    if (argc > 1) {
+        num_workers = std::stoul(argv[1]);
+    }
+    if (argc > 2) {
+        num_tasks = std::stoul(argv[2]);
+    }
+    if (argc > 3) {
+        task_us = std::stoul(argv[3]);
+    }
+
+    auto duration = std::chrono::microseconds{task_us};
+    bench("worker 0 only", num_workers, num_tasks, duration, false);
+    bench("work stealing", num_workers, num_tasks, duration, true);
+}
@@ -0,0 +1,133 @@
+#include "uvio/core.hpp"
+#include "uvio/net.hpp"
+
+using namespace uvio;
+using namespace uvio::net;
+
+// Responses of `message_size` bytes, built fresh for every write, sent over
+// loopback by TcpStream::write() copying them, taking them over, and
+// borrowing them. Then a header in front of a body that is already in
+// memory, joined into one string against TcpStream::write_vectored().
+// Usage: benchmark_write [total_mib]
+
+constexpr int PORT{12351};
+
+enum class Mode {
+    Copy,
+    HandOff,
+    Borrow,
+    Join,
+    Vectored,
+};
+
+auto elapsed_ns(std::chrono::steady_clock::time_point start) -> double {
+    return static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count());
+}
+
+auto send(TcpListener &listener,
+          Mode         mode,
+          std::size_t  message_size,
+          std::size_t  messages) -> Task<> {
+    auto        stream = (co_await listener.accept()).value();
+    std::string prototype(message_size, 'x');
+    // The rest of the message is the body
+    auto head = "HTTP/1.0 200 OK\r\nContent-Length: "
+                + std::to_string(message_size) + "\r\n\r\n";
+    std::string_view body{prototype};
+    body.remove_prefix(head.size());
+
+    for (std::size_t i = 0; i < messages; i++) {
+        Result<std::size_t> ret;
+        switch (mode) {
+        case Mode::Copy: {
+            auto message = prototype;
+            ret = co_await stream.write(message);
+            break;
+        }
+        case Mode::HandOff: {
+            auto message = prototype;
+            ret = co_await stream.write(std::move(message));
+            break;
+        }
+        case Mode::Borrow: {
+            auto message = prototype;
+            ret = co_await stream.write_borrowed(message);
+            break;
+        }
+        case Mode::Join: {
+            auto response = head;
+            response.append(body);
+            ret = co_await stream.write(std::move(response));
+            break;
+        }
+        case Mode::Vectored: {
+            std::array<std::span<const char>, 2> response{head, body};
+            ret = co_await stream.write_vectored(response);
+            break;
+        }
+        }
+        if (!ret) {
+            console.error("write failed: {}", ret.error().message());
+            co_return;
+        }
+    }
+}
+
+auto receive(std::size_t total) -> Task<> {
+    auto stream = (co_await TcpStream::connect("127.0.0.1", PORT)).value();
+    std::vector<char> buf(256 * 1024);
+    for (std::size_t received = 0; received < total;) {
+        auto ret = co_await stream.read(buf);
+        if (!ret) {
+            console.error("read failed: {}", ret.error().message());
+            co_return;
+        }
+        received += ret.value();
+    }
+}
+
+auto bench(std::string_view name,
+           Mode             mode,
+           std::size_t      message_size,
+           std::size_t      total) -> Task<> {
+    auto messages = total / message_size;
+
+    TcpListener listener;
+    if (!listener.bind("127.0.0.1", PORT)) {
+        console.error("bind failed");
+        co_return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    co_await when_all(send(listener, mode, message_size, messages),
+                      receive(messages * message_size));
+    auto ns = elapsed_ns(start);
+
+    console.info("{:<9} {:>7} B messages: {:>9.1f} ns/message, {:>5.2f} GiB/s",
+                 name,
+                 message_size,
+                 ns / static_cast<double>(messages),
+                 static_cast<double>(messages * message_size) / ns
+                     / 1.073741824);
+}
+
+auto main(int argc, char **argv) -> int {
+    std::size_t total_mib = 1024;
+    if (argc > 1) {
+        total_mib = std::stoul(argv[1]);
+    }
+
+    for (std::size_t message_size : {4 * 1024, 64 * 1024, 1024 * 1024}) {
+        auto total = total_mib * 1024 * 1024;
+        block_on(bench("copy", Mode::Copy, message_size, total));
+        block_on(bench("hand-off", Mode::HandOff, message_size, total));
+        block_on(bench("borrow", Mode::Borrow, message_size, total));
+    }
+    for (std::size_t message_size : {4 * 1024, 64 * 1024, 1024 * 1024}) {
+        auto total = total_mib * 1024 * 1024;
+        block_on(bench("join", Mode::Join, message_size, total));
+        block_on(bench("vectored", Mode::Vectored, message_size, total));
+    }
+}
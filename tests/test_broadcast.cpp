@@ -0,0 +1,82 @@
+#include "uvio/core.hpp"
+#include "uvio/sync.hpp"
+
+using namespace uvio;
+using namespace uvio::sync;
+
+constexpr std::size_t ROUNDS{1000};
+
+auto consume(BroadcastReceiver<std::size_t> receiver, Latch &done) -> Task<> {
+    std::size_t expected = 0;
+    while (true) {
+        auto ret = co_await receiver.recv();
+        if (!ret) {
+            assert(ret.error().value() == Error::ChannelClosed);
+            break;
+        }
+        assert(*ret == expected);
+        expected++;
+    }
+    assert(expected == ROUNDS);
+    done.count_down();
+}
+
+auto test(Runtime &runtime) -> Task<> {
+    // Every receiver gets every value, in order
+    {
+        auto [sender, receiver] = broadcast<std::size_t>(ROUNDS);
+        auto  num_receivers = runtime.num_workers();
+        Latch done{static_cast<std::ptrdiff_t>(num_receivers)};
+        runtime.spawn_on(0, consume(std::move(receiver), done));
+        for (std::size_t i = 1; i < num_receivers; i++) {
+            runtime.spawn_on(i, consume(sender.subscribe(), done));
+        }
+        for (std::size_t i = 0; i < ROUNDS; i++) {
+            assert(sender.send(i));
+            if (i % 64 == 0) {
+                co_await yield();
+            }
+        }
+        {
+            auto dropped = std::move(sender);
+        }
+        co_await done.wait();
+    }
+
+    // A lagging receiver skips to the oldest value kept
+    {
+        auto [sender, receiver] = broadcast<int>(2);
+        for (int i = 0; i < 5; i++) {
+            assert(sender.send(i));
+        }
+        auto lagged = co_await receiver.recv();
+        assert(!lagged && lagged.error().value() == Error::ChannelLagged);
+        auto ret = co_await receiver.recv();
+        assert(ret && *ret == 3);
+        ret = receiver.try_recv();
+        assert(ret && *ret == 4);
+        auto empty = receiver.try_recv();
+        assert(!empty && empty.error().value() == Error::ChannelEmpty);
+
+        // Subscribed receivers only see what is sent afterwards
+        auto late = sender.subscribe();
+        assert(sender.send(5));
+        ret = co_await late.recv();
+        assert(ret && *ret == 5);
+    }
+
+    // No receiver left
+    {
+        auto [sender, receiver] = broadcast<int>(1);
+        {
+            auto dropped = std::move(receiver);
+        }
+        auto ret = sender.send(1);
+        assert(!ret && ret.error().value() == Error::ChannelClosed);
+    }
+}
+
+auto main() -> int {
+    Runtime runtime{4};
+    runtime.block_on(test(runtime));
+}
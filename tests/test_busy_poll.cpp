@@ -0,0 +1,85 @@
+#include "uvio/core.hpp"
+#include "uvio/net.hpp"
+#include "uvio/sync.hpp"
+#include "uvio/time.hpp"
+
+using namespace uvio;
+using namespace uvio::net;
+using namespace uvio::sync;
+using namespace uvio::time;
+
+constexpr int         PORT{12350};
+constexpr std::size_t ROUNDS{100};
+
+auto echo_server(TcpListener &listener) -> Task<> {
+    auto stream = (co_await listener.accept()).value();
+    std::array<char, 4> buf{};
+    for (std::size_t i = 0; i < ROUNDS; i++) {
+        auto ret = co_await stream.read_exact(buf);
+        assert(ret);
+        auto nwritten = co_await stream.write(buf);
+        assert(nwritten && nwritten.value() == buf.size());
+    }
+}
+
+auto ping_client(Latch &done) -> Task<> {
+    auto stream = (co_await TcpStream::connect("127.0.0.1", PORT)).value();
+    std::array<char, 4> buf{};
+    for (std::size_t i = 0; i < ROUNDS; i++) {
+        auto nwritten = co_await stream.write(std::string_view{"ping"});
+        assert(nwritten);
+        auto ret = co_await stream.read_exact(buf);
+        assert(ret);
+        assert(std::string_view(buf.data(), buf.size()) == "ping");
+    }
+    done.count_down();
+}
+
+auto test(Runtime &runtime) -> Task<> {
+    TcpListener listener;
+    auto        ret = listener.bind("127.0.0.1", PORT);
+    assert(ret);
+    Latch done{1};
+    runtime.spawn_on(1, ping_client(done));
+    co_await echo_server(listener);
+    co_await done.wait();
+
+    // Longer than the spin budget, the loop blocks
+    co_await sleep(20ms);
+
+#if defined(__linux__)
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    assert(sched_getaffinity(0, sizeof(cpus), &cpus) == 0);
+    assert(CPU_COUNT(&cpus) == 1 && CPU_ISSET(0, &cpus));
+#endif
+}
+
+auto main() -> int {
+    {
+        Runtime runtime{2,
+                        RuntimeOptions{
+                            .busy_poll = 200us,
+                            .cpus = {0},
+                            .socket_busy_poll = 50us,
+                        }};
+        runtime.block_on(test(runtime));
+        for (std::size_t id = 0; id < runtime.num_workers(); id++) {
+            auto stats = runtime.worker_stats(id);
+            console.info("worker {}: spin {} us, work {} us, {} parks",
+                         id,
+                         stats.spin_time.count() / 1000,
+                         stats.work_time.count() / 1000,
+                         stats.parks);
+            assert(stats.spin_time.count() > 0);
+            assert(stats.work_time.count() > 0);
+            assert(stats.parks > 0);
+        }
+    }
+
+    // Blocks in poll by default
+    Runtime runtime{1};
+    runtime.block_on([]() -> Task<> { co_await sleep(5ms); }());
+    auto stats = runtime.worker_stats(0);
+    assert(stats.spin_time.count() == 0 && stats.parks == 0);
+}
@@ -0,0 +1,162 @@
+#include "uvio/core.hpp"
+#include "uvio/io.hpp"
+#include "uvio/net.hpp"
+
+using namespace uvio;
+using namespace uvio::io;
+using namespace uvio::net;
+
+constexpr int PORT{12352};
+
+auto test_bytes_mut() {
+    BytesMut buf{1024};
+    assert(buf.empty() && buf.w_remaining() == 0);
+
+    // Appends spill over into new segments
+    std::string data;
+    for (int i = 0; i < 300; i++) {
+        data += "line " + std::to_string(i) + "\r\n";
+    }
+    buf.append(data);
+    assert(buf.size() == data.size());
+
+    // Flags are found across segments
+    auto pos = buf.find("line 299\r\n");
+    assert(pos == data.find("line 299\r\n"));
+    for (std::size_t split = 1020; split < 1030; split++) {
+        BytesMut    chain{1024};
+        std::string text(split, 'x');
+        text += "\r\n\r\n";
+        chain.append(text);
+        assert(chain.find("\r\n\r\n") == split);
+        assert(chain.find("\r\n\r\nx") == std::string_view::npos);
+    }
+
+    // Bytes in the front segment are shared, others gathered
+    auto first = buf.split_to(10);
+    assert(first.as_string_view() == data.substr(0, 10));
+    auto spanning = buf.split_to(2000);
+    assert(spanning.as_string_view() == data.substr(10, 2000));
+
+    // Copied out across segments
+    std::string rest;
+    buf.append_to(rest, buf.size() - 5);
+    std::array<char, 5> tail{};
+    assert(buf.write_to(tail) == 5 && buf.empty());
+    rest.append(tail.data(), tail.size());
+    assert(first.as_string_view().size() + spanning.size() + rest.size()
+           == data.size());
+    assert(rest == data.substr(2010));
+
+    // Bytes outlive the buffer
+    BytesMut owner{1024};
+    owner.append(std::string_view{"hello world"});
+    auto hello = owner.split_to(5);
+    owner.clear();
+    { BytesMut moved{std::move(owner)}; }
+    auto world = hello.slice(1, 3);
+    assert(hello.as_string_view() == "hello");
+    assert(world.as_string_view() == "ell");
+    auto copy = hello;
+    hello = Bytes{};
+    assert(copy.as_string_view() == "hello" && hello.empty());
+    assert(Bytes::copy_from(std::string_view{"copied"}).as_string_view()
+           == "copied");
+}
+
+auto test_reserve() {
+    BytesMut buf{1024};
+    buf.append(std::string(1000, 'a'));
+    buf.r_increase(900);
+    // 100 unread bytes and 5000 more go in one segment
+    buf.reserve(5000);
+    assert(buf.w_remaining() >= 5000);
+    buf.append(std::string(5000, 'b'));
+    auto frame = buf.split_to(5100);
+    assert(frame.as_string_view() == std::string(100, 'a')
+                                         + std::string(5000, 'b'));
+
+    // A segment that is read through is reused, unless shared
+    BytesMut reused{1024};
+    auto     before = reused.w_slice().data();
+    reused.w_increase(10);
+    reused.r_increase(10);
+    reused.reset_data();
+    assert(reused.w_slice().data() == before);
+    reused.w_increase(10);
+    auto shared = reused.split_to(10);
+    reused.reset_data();
+    assert(reused.w_slice().data() == before + 10);
+    assert(shared.data() == before);
+}
+
+auto server(TcpListener &listener, std::string headers, std::string body)
+    -> Task<> {
+    auto stream = (co_await listener.accept()).value();
+    auto ret = co_await stream.write(headers);
+    assert(ret);
+    ret = co_await stream.write(body);
+    assert(ret);
+    ret = co_await stream.write(headers);
+    assert(ret);
+    ret = co_await stream.write(headers);
+    assert(ret);
+    ret = co_await stream.write(headers);
+    assert(ret);
+}
+
+auto client(std::string headers, std::string body) -> Task<> {
+    auto stream = (co_await TcpStream::connect("127.0.0.1", PORT)).value();
+    auto [read_half, write_half] = std::move(stream).into_split();
+
+    Bytes frame;
+    Bytes payload;
+    {
+        // Small segments, as in HttpFramed
+        TcpReader reader{std::move(read_half), 1024};
+        auto      head = co_await reader.read_bytes_until("\r\n\r\n");
+        assert(head && head->as_string_view() == headers);
+        payload = (co_await reader.read_bytes(body.size())).value();
+        frame = (co_await reader.read_bytes_until("\r\n\r\n")).value();
+
+        // Used to stall once the headers filled the buffer
+        std::string copied;
+        auto        ret = co_await reader.read_until(copied, "\r\n\r\n");
+        assert(ret && copied == headers);
+
+        // Headers larger than the limit fail instead of growing the buffer
+        auto limited = co_await reader.read_bytes_until("\r\n\r\n", 1024);
+        assert(!limited && limited.error().value() == Error::FrameTooLarge);
+        copied.clear();
+        ret = co_await reader.read_until(copied, "\r\n\r\n", 1024);
+        assert(!ret && ret.error().value() == Error::FrameTooLarge);
+        assert(copied.size() < 2 * 1024);
+    }
+    // The frames outlive the reader
+    assert(payload.as_string_view() == body);
+    assert(frame.as_string_view() == headers);
+}
+
+auto test_reader() -> Task<> {
+    std::string headers{"GET / HTTP/1.1\r\n"};
+    for (int i = 0; headers.size() < 10 * 1024; i++) {
+        headers += "X-Header-" + std::to_string(i) + ": " + std::string(64, 'v')
+                   + "\r\n";
+    }
+    headers += "\r\n";
+    std::string body(100 * 1024, 'b');
+    for (std::size_t i = 0; i < body.size(); i += 7) {
+        body[i] = static_cast<char>('a' + i % 26);
+    }
+
+    TcpListener listener;
+    auto        ret = listener.bind("127.0.0.1", PORT);
+    assert(ret);
+    co_await when_all(server(listener, headers, body), client(headers, body));
+}
+
+auto main() -> int {
+    test_bytes_mut();
+    test_reserve();
+    block_on(test_reader());
+}
@@ -0,0 +1,95 @@
+#include "uvio/core.hpp"
+#include "uvio/net.hpp"
+#include "uvio/time.hpp"
+
+using namespace uvio;
+using namespace uvio::net;
+using namespace uvio::time;
+
+auto elapsed_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+}
+
+auto long_sleep() -> Task<Result<void>> {
+    co_return co_await sleep(10s);
+}
+
+auto cancel_after(CancellationSource &source, std::chrono::milliseconds delay)
+    -> Task<> {
+    co_await sleep(delay);
+    source.request_cancellation();
+}
+
+auto delayed(int value, std::chrono::milliseconds delay) -> Task<int> {
+    co_await sleep(delay);
+    co_return value;
+}
+
+auto accept_one(TcpListener &listener) -> Task<Result<void>> {
+    auto stream = co_await listener.accept();
+    if (!stream) {
+        co_return unexpected{stream.error()};
+    }
+    co_return Result<void>{};
+}
+
+auto test() -> Task<> {
+    // The token reaches the awaiter through nested tasks
+    auto start = std::chrono::steady_clock::now();
+    CancellationSource source;
+    spawn(cancel_after(source, 50ms));
+    auto ret = co_await with_cancellation(source.token(), long_sleep());
+    assert(!ret && ret.error().value() == Error::Cancelled);
+    assert(elapsed_since(start) < 1s);
+
+    // Already cancelled, the sleep never starts
+    ret = co_await with_cancellation(source.token(), long_sleep());
+    assert(!ret && ret.error().value() == Error::Cancelled);
+
+    // The loser is cancelled instead of keeping the loop alive
+    start = std::chrono::steady_clock::now();
+    auto any = co_await when_any(delayed(1, 10s), delayed(2, 50ms));
+    console.info("when_any: winner {} after {}ms",
+                 any.index(),
+                 elapsed_since(start).count());
+    assert(any.index() == 1 && std::get<1>(any) == 2);
+    assert(elapsed_since(start) < 1s);
+
+    // Cancelling the caller cancels every child of when_all
+    start = std::chrono::steady_clock::now();
+    CancellationSource group;
+    spawn(cancel_after(group, 50ms));
+    auto [a, b] = co_await with_cancellation(
+        group.token(),
+        when_all(long_sleep(), long_sleep()));
+    assert(!a && !b);
+    assert(elapsed_since(start) < 1s);
+
+    // Aborting a spawned task
+    start = std::chrono::steady_clock::now();
+    auto handle = spawn(long_sleep());
+    co_await sleep(20ms);
+    assert(!handle.is_finished());
+    handle.abort();
+    auto joined = co_await handle;
+    assert(!joined && joined.error().value() == Error::TaskAborted);
+    assert(elapsed_since(start) < 1s);
+
+    // Cancelling a pending accept
+    auto listener = TcpListener();
+    assert(listener.bind("127.0.0.1", 12347));
+    CancellationSource stop;
+    spawn(cancel_after(stop, 50ms));
+    auto accepted = co_await with_cancellation(stop.token(),
+                                               accept_one(listener));
+    assert(!accepted && accepted.error().value() == Error::Cancelled);
+
+    // A refused connection reports an error instead of hanging
+    auto stream = co_await TcpStream::connect("127.0.0.1", 12348);
+    assert(!stream);
+}
+
+auto main() -> int {
+    block_on(test());
+}
@@ -0,0 +1,132 @@
+#include "uvio/core.hpp"
+#include "uvio/sync.hpp"
+
+using namespace uvio;
+using namespace uvio::sync;
+
+constexpr std::size_t ROUNDS{2000};
+
+auto produce(Sender<std::pair<std::size_t, std::size_t>> sender,
+             std::size_t                                 id) -> Task<> {
+    for (std::size_t i = 0; i < ROUNDS; i++) {
+        auto ret = co_await sender.send({id, i});
+        assert(ret);
+    }
+}
+
+auto test_backpressure() -> Task<> {
+    auto [sender, receiver] = channel<std::unique_ptr<int>>(2);
+    assert(sender.try_send(std::make_unique<int>(1)));
+    assert(sender.try_send(std::make_unique<int>(2)));
+    auto value = std::make_unique<int>(3);
+    auto ret = sender.try_send(std::move(value));
+    assert(!ret && ret.error().value() == Error::ChannelFull);
+    // Not moved from
+    assert(value != nullptr);
+
+    // Waits for a free slot
+    Latch sent{1};
+    spawn([](Sender<std::unique_ptr<int>> &sender,
+             std::unique_ptr<int>        &&value,
+             Latch                        &sent) -> Task<> {
+        auto ret = co_await sender.send(std::move(value));
+        assert(ret);
+        sent.count_down();
+    }(sender, std::move(value), sent));
+    co_await yield();
+    assert(!sent.try_wait());
+
+    for (int expected = 1; expected <= 3; expected++) {
+        auto ret = co_await receiver.recv();
+        assert(ret && **ret == expected);
+    }
+    co_await sent.wait();
+    auto empty = receiver.try_recv();
+    assert(!empty && empty.error().value() == Error::ChannelEmpty);
+
+    // Queued values outlive the senders
+    assert(sender.try_send(std::make_unique<int>(4)));
+    {
+        auto dropped = std::move(sender);
+    }
+    auto last = co_await receiver.recv();
+    assert(last && **last == 4);
+    auto closed = co_await receiver.recv();
+    assert(!closed && closed.error().value() == Error::ChannelClosed);
+}
+
+auto test_receiver_gone() -> Task<> {
+    auto [sender, receiver] = channel<int>(1);
+    assert(sender.try_send(1));
+    Latch failed{1};
+    spawn([](Sender<int> &sender, Latch &failed) -> Task<> {
+        auto ret = co_await sender.send(2);
+        assert(!ret && ret.error().value() == Error::ChannelClosed);
+        failed.count_down();
+    }(sender, failed));
+    co_await yield();
+    receiver.close();
+    co_await failed.wait();
+    assert(sender.is_closed());
+}
+
+auto test_across_loops(Runtime &runtime) -> Task<> {
+    auto [sender, receiver] = channel<std::pair<std::size_t, std::size_t>>(8);
+    auto num_producers = runtime.num_workers() * 2;
+    for (std::size_t id = 0; id < num_producers; id++) {
+        runtime.spawn_on(id % runtime.num_workers(), produce(sender, id));
+    }
+    {
+        auto dropped = std::move(sender);
+    }
+
+    // In order from every producer, until the last one is done
+    std::vector<std::size_t> next(num_producers, 0);
+    std::size_t              received = 0;
+    while (true) {
+        auto ret = co_await receiver.recv();
+        if (!ret) {
+            assert(ret.error().value() == Error::ChannelClosed);
+            break;
+        }
+        auto [id, i] = *ret;
+        assert(next[id] == i);
+        next[id]++;
+        received++;
+    }
+    console.info("received {} values", received);
+    assert(received == num_producers * ROUNDS);
+}
+
+auto test_unbounded(Runtime &runtime) -> Task<> {
+    auto [sender, receiver] = unbounded_channel<std::size_t>();
+    Latch done{1};
+    runtime.spawn_on(1,
+                     [](UnboundedSender<std::size_t> sender,
+                        Latch                       &done) -> Task<> {
+                         for (std::size_t i = 0; i < ROUNDS; i++) {
+                             // Never waits
+                             assert(sender.try_send(std::size_t{i}));
+                         }
+                         done.count_down();
+                         co_return;
+                     }(sender, done));
+    co_await done.wait();
+    for (std::size_t i = 0; i < ROUNDS; i++) {
+        auto ret = receiver.try_recv();
+        assert(ret && *ret == i);
+    }
+    assert(receiver.try_recv().error().value() == Error::ChannelEmpty);
+}
+
+auto test(Runtime &runtime) -> Task<> {
+    co_await test_backpressure();
+    co_await test_receiver_gone();
+    co_await test_across_loops(runtime);
+    co_await test_unbounded(runtime);
+}
+
+auto main() -> int {
+    Runtime runtime{4};
+    runtime.block_on(test(runtime));
+}
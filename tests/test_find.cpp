@@ -0,0 +1,101 @@
+#include "uvio/core.hpp"
+#include "uvio/io.hpp"
+
+#include <random>
+
+using namespace uvio;
+using namespace uvio::io;
+using uvio::io::detail::StreamBuffer;
+
+// Every search agrees with std::string_view::find
+auto check(std::string_view haystack, std::string_view flag) {
+    auto expected = haystack.find(flag);
+    assert(uvio::detail::find_flag(haystack, flag) == expected);
+    if (flag.size() == 1) {
+        assert(uvio::detail::find_char(haystack, flag[0]) == expected);
+    }
+#if defined(UVIO_SIMD_FIND)
+    if (flag.size() >= 2 && haystack.size() >= flag.size()) {
+        assert(uvio::detail::find_flag_sse2(haystack.data(),
+                                            haystack.size(),
+                                            flag)
+               == expected);
+        if (uvio::detail::has_avx2()) {
+            assert(uvio::detail::find_flag_avx2(haystack.data(),
+                                                haystack.size(),
+                                                flag)
+                   == expected);
+        }
+    }
+#endif
+}
+
+auto test_random() {
+    std::mt19937                       gen{42};
+    std::uniform_int_distribution<int> chars{0, 3};
+    std::uniform_int_distribution<int> sizes{0, 200};
+    const std::string_view             alphabet{"\r\nab"};
+    const std::string_view             flags[]
+        = {"\r", "\n", "\r\n", "\r\n\r\n", "a\r\nb", "\n\n\n\n\n\n\n\n\n\n"};
+    for (int round = 0; round < 20000; round++) {
+        std::string haystack(sizes(gen), 'x');
+        for (auto &c : haystack) {
+            if (gen() % 4 == 0) {
+                c = alphabet[chars(gen)];
+            }
+        }
+        for (auto flag : flags) {
+            check(haystack, flag);
+        }
+    }
+}
+
+auto test_boundaries() {
+    // The flag at every offset of the SIMD blocks, and cut off at the end
+    for (std::size_t size = 0; size < 100; size++) {
+        for (std::size_t at = 0; at + 4 <= size; at++) {
+            std::string haystack(size, 'h');
+            haystack.replace(at, 4, "\r\n\r\n");
+            check(haystack, "\r\n\r\n");
+            check(haystack, "\n");
+            check(std::string_view{haystack}.substr(0, at + 3), "\r\n\r\n");
+        }
+        check(std::string(size, 'h'), "h");
+        check(std::string(size, 'h'), "hh");
+    }
+    check("", "");
+    check("abc", "");
+}
+
+auto test_resume() {
+    std::string headers{"GET / HTTP/1.1\r\nHost: localhost\r\n\r\nbody"};
+
+    // Searches resume where the previous one left off, across segments
+    BytesMut buf{1024};
+    buf.append(std::string(1022, 'x'));
+    buf.append(headers);
+    auto pos = buf.find("\r\n\r\n");
+    assert(pos == 1022 + headers.find("\r\n\r\n"));
+    assert(buf.find("\r\n\r\n", pos) == pos);
+    assert(buf.find("\r\n\r\n", pos + 1) == std::string_view::npos);
+    assert(buf.find("x", 1000) == 1000);
+    assert(buf.find("xGET / ", 1020) == 1021);
+    assert(buf.find("x", buf.size()) == std::string_view::npos);
+
+    StreamBuffer stream{1024};
+    stream.read_from(headers);
+    pos = stream.find("\r\n\r\n");
+    assert(pos == headers.find("\r\n\r\n"));
+    assert(stream.find("\r\n\r\n", pos + 1) == std::string_view::npos);
+    assert(stream.find("\r\n", 1) == headers.find("\r\n"));
+    assert(stream.find("\r\n", 1000) == std::string_view::npos);
+}
+
+auto main() -> int {
+    test_random();
+    test_boundaries();
+    test_resume();
+#if defined(UVIO_SIMD_FIND)
+    console.info("avx2: {}", uvio::detail::has_avx2());
+#endif
+}
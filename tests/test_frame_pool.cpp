@@ -0,0 +1,37 @@
+#include "uvio/core.hpp"
+
+using namespace uvio;
+
+auto leaf(int n) -> Task<int> {
+    co_return n + 1;
+}
+
+auto middle(int n) -> Task<int> {
+    co_return co_await leaf(n);
+}
+
+auto test(int rounds) -> Task<> {
+    std::int64_t sum = 0;
+    for (int i = 0; i < rounds; i++) {
+        sum += co_await middle(i);
+    }
+    console.info("sum: {}", sum);
+}
+
+auto main() -> int {
+    constexpr int rounds = 1000;
+    auto          before = frame_pool_stats();
+    block_on(test(rounds));
+    auto after = frame_pool_stats();
+
+    auto allocations = after.allocations - before.allocations;
+    auto heap_allocations = after.heap_allocations - before.heap_allocations;
+    console.info("frames: {}, reused: {}, heap allocations: {}",
+                 allocations,
+                 after.reused - before.reused,
+                 heap_allocations);
+    assert(allocations == 2 * rounds + 1);
+    assert(after.deallocations - before.deallocations == allocations);
+    // Only the first frame of each size class hits the global allocator
+    assert(heap_allocations < 10);
+}
@@ -0,0 +1,59 @@
+#include "uvio/core.hpp"
+#include "uvio/time.hpp"
+
+#include <stdexcept>
+
+using namespace uvio;
+using namespace uvio::time;
+
+auto query(int backend) -> Task<int> {
+    co_await sleep(std::chrono::milliseconds{100 * (3 - backend)});
+    console.info("backend {} replied", backend);
+    co_return backend * 10;
+}
+
+auto ready() -> Task<std::string> {
+    co_return std::string{"ready"};
+}
+
+auto test() -> Task<> {
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<JoinHandle<int>> handles;
+    for (int i = 0; i < 3; i++) {
+        handles.push_back(spawn(query(i)));
+    }
+    int sum = 0;
+    for (auto &handle : handles) {
+        sum += (co_await handle).value();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    console.info("sum: {}, elapsed: {}ms",
+                 sum,
+                 std::chrono::duration_cast<std::chrono::milliseconds>(elapsed)
+                     .count());
+    assert(sum == 30);
+    // Queries ran concurrently: about 300ms rather than 600ms
+    assert(elapsed < 500ms);
+
+    // Finished before being awaited
+    auto handle = spawn(ready());
+    assert(handle.is_finished());
+    assert((co_await handle).value() == "ready");
+
+    auto void_handle = spawn([]() -> Task<> {
+        co_await sleep(10ms);
+    }());
+    assert((co_await void_handle).has_value());
+
+    // Detached, the exception is logged rather than lost
+    spawn([]() -> Task<> {
+        co_await sleep(1ms);
+        throw std::runtime_error{"detached"};
+    }());
+    co_await sleep(10ms);
+}
+
+auto main() -> int {
+    block_on(test());
+}
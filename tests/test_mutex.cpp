@@ -0,0 +1,63 @@
+#include "uvio/core.hpp"
+#include "uvio/sync.hpp"
+
+using namespace uvio;
+using namespace uvio::sync;
+
+// Not atomic, only ever touched with the mutex held
+std::size_t      counter = 0;
+std::vector<int> order;
+
+auto increment(Mutex &mutex, Latch &done, std::size_t rounds) -> Task<> {
+    for (std::size_t i = 0; i < rounds; i++) {
+        auto guard = co_await mutex.lock();
+        auto value = counter;
+        if (i % 16 == 0) {
+            co_await yield();
+        }
+        counter = value + 1;
+    }
+    done.count_down();
+}
+
+auto fifo(Mutex &mutex, Latch &done, int id) -> Task<> {
+    auto guard = co_await mutex.lock();
+    order.push_back(id);
+    done.count_down();
+}
+
+auto test(Runtime &runtime) -> Task<> {
+    Mutex mutex;
+
+    // Waiters get the mutex in arrival order
+    Latch fifo_done{5};
+    {
+        auto guard = co_await mutex.lock();
+        assert(!mutex.try_lock());
+        for (int id = 0; id < 5; id++) {
+            spawn(fifo(mutex, fifo_done, id));
+        }
+    }
+    co_await fifo_done.wait();
+    assert((order == std::vector<int>{0, 1, 2, 3, 4}));
+
+    // Contended from every loop
+    constexpr std::size_t TASKS_PER_WORKER{8};
+    constexpr std::size_t ROUNDS{500};
+    auto  num_tasks = runtime.num_workers() * TASKS_PER_WORKER;
+    Latch done{static_cast<std::ptrdiff_t>(num_tasks)};
+    for (std::size_t i = 0; i < num_tasks; i++) {
+        runtime.spawn_on(i % runtime.num_workers(),
+                         increment(mutex, done, ROUNDS));
+    }
+    co_await done.wait();
+    console.info("counter: {}", counter);
+    assert(counter == num_tasks * ROUNDS);
+    assert(mutex.try_lock());
+    mutex.unlock();
+}
+
+auto main() -> int {
+    Runtime runtime{4};
+    runtime.block_on(test(runtime));
+}
@@ -0,0 +1,57 @@
+#include "uvio/core.hpp"
+#include "uvio/sync.hpp"
+
+using namespace uvio;
+using namespace uvio::sync;
+
+auto test(Runtime &runtime) -> Task<> {
+    // Replied from another loop
+    {
+        auto [sender, receiver] = oneshot<std::unique_ptr<int>>();
+        runtime.spawn_on(1,
+                         [](OneshotSender<std::unique_ptr<int>> sender)
+                             -> Task<> {
+                             assert(sender.send(std::make_unique<int>(42)));
+                             co_return;
+                         }(std::move(sender)));
+        auto ret = co_await receiver.recv();
+        assert(ret && **ret == 42);
+    }
+
+    // Sent before waiting
+    {
+        auto [sender, receiver] = oneshot<int>();
+        auto empty = receiver.try_recv();
+        assert(!empty && empty.error().value() == Error::ChannelEmpty);
+        assert(sender.send(1));
+        auto ret = co_await receiver.recv();
+        assert(ret && *ret == 1);
+    }
+
+    // Sender gone without sending
+    {
+        auto [sender, receiver] = oneshot<int>();
+        runtime.spawn_on(2,
+                         [](OneshotSender<int> sender) -> Task<> {
+                             auto dropped = std::move(sender);
+                             co_return;
+                         }(std::move(sender)));
+        auto ret = co_await receiver.recv();
+        assert(!ret && ret.error().value() == Error::ChannelClosed);
+    }
+
+    // Receiver gone
+    {
+        auto [sender, receiver] = oneshot<int>();
+        {
+            auto dropped = std::move(receiver);
+        }
+        auto ret = sender.send(1);
+        assert(!ret && ret.error().value() == Error::ChannelClosed);
+    }
+}
+
+auto main() -> int {
+    Runtime runtime{4};
+    runtime.block_on(test(runtime));
+}
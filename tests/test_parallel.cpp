@@ -0,0 +1,95 @@
+#include "uvio/core.hpp"
+
+#include <numeric>
+#include <ranges>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+using namespace uvio;
+
+auto test() -> Task<> {
+    auto loop_thread = std::this_thread::get_id();
+
+    // Every element visited exactly once, off the loop
+    std::vector<int> values(100000);
+    std::iota(values.begin(), values.end(), 0);
+    std::mutex                mutex;
+    std::set<std::thread::id> threads;
+    auto ret = co_await parallel_for(values, 1000, [&](int &value) {
+        value *= 2;
+        if (value % 10000 == 0) {
+            std::lock_guard lock{mutex};
+            threads.insert(std::this_thread::get_id());
+        }
+    });
+    assert(ret);
+    assert(std::this_thread::get_id() == loop_thread);
+    assert(!threads.contains(loop_thread));
+    for (std::size_t i = 0; i < values.size(); i++) {
+        assert(values[i] == static_cast<int>(2 * i));
+    }
+    console.info("parallel_for ran on {} threads", threads.size());
+
+    auto sum = co_await map_reduce(
+        std::views::iota(std::size_t{0}, std::size_t{1000000}),
+        4096,
+        std::size_t{0},
+        [](std::size_t i) { return i * i % 7; },
+        [](std::size_t a, std::size_t b) { return a + b; });
+    std::size_t expected = 0;
+    for (std::size_t i = 0; i < 1000000; i++) {
+        expected += i * i % 7;
+    }
+    assert(sum && sum.value() == expected);
+
+    // Empty ranges complete right away
+    std::vector<int> empty;
+    assert(co_await parallel_for(empty, 1, [](int &) { assert(false); }));
+    auto zero = co_await map_reduce(
+        empty,
+        1,
+        0,
+        [](int value) { return value; },
+        [](int a, int b) { return a + b; });
+    assert(zero && zero.value() == 0);
+
+    // A temporary range is kept alive by the task until it runs
+    auto stored = map_reduce(
+        std::vector<int>(1000, 1),
+        10,
+        0,
+        [](int value) { return value; },
+        [](int a, int b) { return a + b; });
+    std::vector<int> reused(1000, 2);
+    auto             count = co_await stored;
+    assert(count && count.value() == 1000);
+
+    // The first exception stops the other helpers and is rethrown on the loop
+    auto caught = false;
+    try {
+        co_await parallel_for(values, 10, [](int &value) {
+            if (value == 5000) {
+                throw std::runtime_error{"kernel"};
+            }
+        });
+    } catch (const std::runtime_error &) {
+        caught = true;
+    }
+    assert(caught);
+    assert(std::this_thread::get_id() == loop_thread);
+
+    // Cancelled before it starts
+    CancellationSource source;
+    source.request_cancellation();
+    auto cancelled = co_await with_cancellation(
+        source.token(),
+        [](std::vector<int> &values) -> Task<Result<void>> {
+            co_return co_await parallel_for(values, 1, [](int &) {});
+        }(values));
+    assert(!cancelled && cancelled.error().value() == Error::Cancelled);
+}
+
+auto main() -> int {
+    block_on(test());
+}
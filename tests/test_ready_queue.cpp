@@ -0,0 +1,49 @@
+#include "uvio/core.hpp"
+#include "uvio/time.hpp"
+
+#include <map>
+
+using namespace uvio;
+using namespace uvio::time;
+
+// Loop iteration every sleeper was resumed in
+std::size_t                        iteration = 0;
+std::map<std::size_t, std::size_t> resumed_per_iteration;
+
+auto sleeper() -> Task<> {
+    co_await sleep(50ms);
+    resumed_per_iteration[iteration]++;
+}
+
+auto test() -> Task<> {
+    uv_prepare_t prepare;
+    uv_prepare_init(current_loop(), &prepare);
+    uv_prepare_start(&prepare, [](uv_prepare_t *) { iteration++; });
+
+    constexpr std::size_t NUM_SLEEPERS{1000};
+    std::vector<Task<>>   sleepers;
+    for (std::size_t i = 0; i < NUM_SLEEPERS; i++) {
+        sleepers.push_back(sleeper());
+    }
+    co_await when_all(std::move(sleepers));
+
+    // All timers expire in the same iteration, but at most `BUDGET` sleepers
+    // are resumed per iteration
+    std::size_t total = 0;
+    for (auto [_, count] : resumed_per_iteration) {
+        assert(count <= uvio::detail::ReadyQueue::BUDGET);
+        total += count;
+    }
+    console.info("{} sleepers resumed over {} iterations",
+                 total,
+                 resumed_per_iteration.size());
+    assert(total == NUM_SLEEPERS);
+    assert(resumed_per_iteration.size()
+           >= NUM_SLEEPERS / uvio::detail::ReadyQueue::BUDGET);
+
+    uv_close(reinterpret_cast<uv_handle_t *>(&prepare), nullptr);
+}
+
+auto main() -> int {
+    block_on(test());
+}
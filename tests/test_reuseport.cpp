@@ -0,0 +1,25 @@
+#include "uvio/core.hpp"
+#include "uvio/net.hpp"
+
+using namespace uvio;
+using namespace uvio::net;
+
+auto test() -> Task<> {
+    auto first = TcpListener();
+    auto second = TcpListener();
+    auto third = TcpListener();
+
+    auto ret = first.bind("127.0.0.1", 12346, {.reuse_port = true});
+    assert(ret);
+    ret = second.bind("127.0.0.1", 12346, {.reuse_port = true});
+    assert(ret);
+    ret = third.bind("127.0.0.1", 12346, {.backlog = 128});
+    console.info("bind without SO_REUSEPORT: {}",
+                 ret ? "ok" : ret.error().message());
+    assert(!ret);
+    co_return;
+}
+
+auto main() -> int {
+    block_on(test());
+}
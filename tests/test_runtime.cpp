@@ -0,0 +1,36 @@
+#include "uvio/core.hpp"
+#include "uvio/time.hpp"
+
+#include <set>
+
+using namespace uvio;
+using namespace uvio::time;
+
+std::atomic<std::size_t> finished{0};
+std::mutex               mutex;
+std::set<uv_loop_t *>    loops;
+
+auto task(std::size_t expected_worker_id) -> Task<> {
+    assert(current_worker_id() == expected_worker_id);
+    {
+        std::lock_guard lock{mutex};
+        loops.insert(current_loop());
+    }
+    co_await sleep(100ms);
+    console.info("worker {} woke up", current_worker_id());
+    assert(current_worker_id() == expected_worker_id);
+    finished.fetch_add(1, std::memory_order::relaxed);
+}
+
+auto main() -> int {
+    Runtime runtime{4};
+    runtime.block_on([&runtime]() -> Task<> {
+        for (std::size_t i = 1; i < runtime.num_workers(); i++) {
+            runtime.spawn_on(i, task(i));
+        }
+        co_await task(0);
+    }());
+    console.info("finished: {}, loops: {}", finished.load(), loops.size());
+    assert(finished == runtime.num_workers());
+    assert(loops.size() == runtime.num_workers());
+}
@@ -0,0 +1,87 @@
+#include "uvio/core.hpp"
+#include "uvio/sync.hpp"
+
+using namespace uvio;
+using namespace uvio::sync;
+
+std::atomic<int>         readers{0};
+std::atomic<int>         writers{0};
+std::atomic<std::size_t> max_readers{0};
+std::vector<char>        order;
+
+auto reader(RwLock &lock, Latch &done) -> Task<> {
+    for (int i = 0; i < 50; i++) {
+        auto guard = co_await lock.read();
+        auto now = readers.fetch_add(1) + 1;
+        assert(writers == 0);
+        auto prev = max_readers.load();
+        while (static_cast<std::size_t>(now) > prev
+               && !max_readers.compare_exchange_weak(prev, now)) {
+        }
+        co_await yield();
+        readers.fetch_sub(1);
+    }
+    done.count_down();
+}
+
+auto writer(RwLock &lock, Latch &done) -> Task<> {
+    for (int i = 0; i < 50; i++) {
+        auto guard = co_await lock.write();
+        assert(writers.fetch_add(1) == 0);
+        assert(readers == 0);
+        co_await yield();
+        writers.fetch_sub(1);
+    }
+    done.count_down();
+}
+
+auto ordered(RwLock &lock, Latch &done, char kind) -> Task<> {
+    if (kind == 'w') {
+        auto guard = co_await lock.write();
+        order.push_back(kind);
+    } else {
+        auto guard = co_await lock.read();
+        order.push_back(kind);
+    }
+    done.count_down();
+}
+
+auto test(Runtime &runtime) -> Task<> {
+    RwLock lock;
+
+    // A waiting writer holds back the readers arriving after it
+    Latch ordered_done{4};
+    {
+        auto guard = co_await lock.read();
+        assert(lock.try_read());
+        lock.unlock_read();
+        spawn(ordered(lock, ordered_done, 'w'));
+        assert(!lock.try_read());
+        spawn(ordered(lock, ordered_done, 'r'));
+        spawn(ordered(lock, ordered_done, 'r'));
+        spawn(ordered(lock, ordered_done, 'w'));
+    }
+    co_await ordered_done.wait();
+    assert((order == std::vector<char>{'w', 'r', 'r', 'w'}));
+
+    // Mixed load from every loop
+    auto  num_tasks = runtime.num_workers() * 4;
+    Latch done{static_cast<std::ptrdiff_t>(num_tasks)};
+    for (std::size_t i = 0; i < num_tasks; i++) {
+        auto worker = i % runtime.num_workers();
+        if (i % 4 == 0) {
+            runtime.spawn_on(worker, writer(lock, done));
+        } else {
+            runtime.spawn_on(worker, reader(lock, done));
+        }
+    }
+    co_await done.wait();
+    console.info("max concurrent readers: {}", max_readers.load());
+    assert(lock.try_write());
+    lock.unlock_write();
+}
+
+auto main() -> int {
+    Runtime runtime{4};
+    runtime.block_on(test(runtime));
+}
@@ -0,0 +1,60 @@
+#include "uvio/core.hpp"
+#include "uvio/sync.hpp"
+#include "uvio/time.hpp"
+
+using namespace uvio;
+using namespace uvio::sync;
+using namespace uvio::time;
+
+constexpr std::size_t MAX_CONCURRENT{3};
+
+std::atomic<std::size_t> running{0};
+std::atomic<std::size_t> peak{0};
+
+auto limited(Semaphore &semaphore, Latch &done) -> Task<> {
+    co_await semaphore.acquire();
+    auto now = running.fetch_add(1) + 1;
+    auto prev = peak.load();
+    while (now > prev && !peak.compare_exchange_weak(prev, now)) {
+    }
+    co_await sleep(5ms);
+    running.fetch_sub(1);
+    semaphore.release();
+    done.count_down();
+}
+
+auto test(Runtime &runtime) -> Task<> {
+    Semaphore semaphore{MAX_CONCURRENT};
+    assert(semaphore.available() == MAX_CONCURRENT);
+
+    constexpr std::size_t NUM_TASKS{64};
+    Latch                 done{NUM_TASKS};
+    for (std::size_t i = 0; i < NUM_TASKS; i++) {
+        runtime.spawn_on(i % runtime.num_workers(), limited(semaphore, done));
+    }
+    co_await done.wait();
+    console.info("peak concurrency: {}", peak.load());
+    assert(peak == MAX_CONCURRENT);
+    assert(semaphore.available() == MAX_CONCURRENT);
+
+    // Released permits wake up as many waiters
+    assert(semaphore.try_acquire());
+    assert(semaphore.try_acquire());
+    assert(semaphore.try_acquire());
+    assert(!semaphore.try_acquire());
+    Latch woken{2};
+    for (int i = 0; i < 2; i++) {
+        spawn([](Semaphore &semaphore, Latch &woken) -> Task<> {
+            co_await semaphore.acquire();
+            woken.count_down();
+        }(semaphore, woken));
+    }
+    semaphore.release(3);
+    co_await woken.wait();
+    assert(semaphore.available() == 1);
+}
+
+auto main() -> int {
+    Runtime runtime{4};
+    runtime.block_on(test(runtime));
+}
@@ -0,0 +1,80 @@
+#include "uvio/core.hpp"
+#include "uvio/time.hpp"
+
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+using namespace uvio;
+using namespace uvio::time;
+
+auto elapsed_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+}
+
+auto busy(std::chrono::milliseconds duration) {
+    return [duration]() { std::this_thread::sleep_for(duration); };
+}
+
+auto test() -> Task<> {
+    auto loop_thread = std::this_thread::get_id();
+
+    // Values, move-only ones included, come back on the loop
+    auto value = co_await spawn_blocking([loop_thread]() {
+        assert(std::this_thread::get_id() != loop_thread);
+        return 42;
+    });
+    assert(value && value.value() == 42);
+    assert(std::this_thread::get_id() == loop_thread);
+
+    auto ptr = co_await spawn_blocking(
+        []() { return std::make_unique<std::string>("blocking"); });
+    assert(ptr && *ptr.value() == "blocking");
+
+    auto nothing = co_await execute([]() {});
+    assert(nothing);
+
+    // Exceptions are rethrown on the loop
+    auto caught = false;
+    try {
+        co_await spawn_blocking(
+            []() -> int { throw std::runtime_error{"blocking"}; });
+    } catch (const std::runtime_error &) {
+        caught = true;
+    }
+    assert(caught);
+
+    // Both normal threads are busy, the high-priority lane is not
+    std::vector<JoinHandle<void>> jobs;
+    for (int i = 0; i < 4; i++) {
+        jobs.push_back(spawn([]() -> Task<> {
+            co_await spawn_blocking(busy(300ms));
+        }()));
+    }
+    std::vector<Task<>> probes;
+    probes.push_back([]() -> Task<> {
+        co_await sleep(50ms);
+        auto start = std::chrono::steady_clock::now();
+        co_await spawn_blocking(busy(10ms), work::Lane::High);
+        console.info("high-priority job done in {}ms",
+                     elapsed_since(start).count());
+        assert(elapsed_since(start) < 200ms);
+    }());
+    probes.push_back([]() -> Task<> {
+        // Queued behind the busy threads, cancelled before it starts
+        co_await sleep(50ms);
+        auto ret = co_await timeout(spawn_blocking(busy(10ms)), 50ms);
+        assert(!ret && ret.error().value() == Error::TimedOut);
+    }());
+    co_await when_all(std::move(probes));
+    for (auto &job : jobs) {
+        co_await job;
+    }
+}
+
+auto main() -> int {
+    configure_blocking_pool(
+        {.num_threads = 2, .num_high_priority_threads = 1});
+    block_on(test());
+}
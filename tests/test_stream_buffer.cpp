@@ -0,0 +1,143 @@
+#include "uvio/core.hpp"
+#include "uvio/io.hpp"
+
+using namespace uvio;
+using uvio::io::detail::StreamBuffer;
+
+// Bytes of a stream are numbered, so that any misplaced byte shows up
+auto fill(std::span<char> buf, std::size_t offset) {
+    for (std::size_t i = 0; i < buf.size(); i++) {
+        buf[i] = static_cast<char>((offset + i) % 251);
+    }
+}
+
+auto check(std::span<const char> buf, std::size_t offset) -> bool {
+    for (std::size_t i = 0; i < buf.size(); i++) {
+        if (buf[i] != static_cast<char>((offset + i) % 251)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Messages of various sizes go through the buffer many times over its
+// capacity, the way ImplBufRead uses it
+auto test_stream(StreamBuffer buffer) {
+    assert(buffer.capacity() >= 1024);
+    if (buffer.mirrored()) {
+        assert(std::has_single_bit(buffer.capacity()));
+    }
+
+    std::vector<char> message(buffer.capacity());
+    std::vector<char> incoming(buffer.capacity());
+    std::size_t       written = 0;
+    std::size_t       read = 0;
+    for (std::size_t round = 0; round < 1000; round++) {
+        auto size = 1 + (round * 37) % (buffer.capacity() / 2);
+        if (buffer.w_remaining() < static_cast<int>(size)) {
+            [[maybe_unused]] auto unread = buffer.r_begin();
+            buffer.reset_data();
+            // A ring never moves the unread bytes
+            if (buffer.mirrored()) {
+                assert(buffer.r_begin() == unread);
+            }
+        }
+        if (buffer.w_remaining() < static_cast<int>(size)) {
+            auto len = buffer.write_to(message);
+            assert(check(std::span{message}.first(len), read));
+            read += len;
+        }
+        assert(buffer.w_remaining() >= static_cast<int>(size));
+
+        // Writable bytes are contiguous, wherever they wrap
+        auto writable = buffer.w_slice().first(size);
+        fill(writable, written);
+        buffer.w_increase(size);
+        written += size;
+        assert(check(buffer.r_slice(), read));
+
+        auto len = buffer.write_to(std::span{message}.first(size / 2 + 1));
+        assert(check(std::span{message}.first(len), read));
+        read += len;
+    }
+    auto len = buffer.write_to(message);
+    read += len;
+    assert(read == written && buffer.empty());
+
+    // read_from() stops at the capacity
+    fill(incoming, 0);
+    assert(buffer.read_from(incoming) == buffer.capacity());
+    assert(buffer.w_remaining() == 0);
+    assert(check(buffer.r_slice(), 0));
+}
+
+auto test_find(StreamBuffer buffer) {
+    std::string  filler(buffer.capacity() - 8, 'x');
+
+    // Push the readable bytes across the end of the ring
+    buffer.read_from(filler);
+    buffer.r_increase(filler.size());
+    std::string_view request{"GET / HTTP/1.1\r\n\r\nleftover"};
+    buffer.reset_data();
+    assert(buffer.read_from(request) == request.size());
+
+    auto slice = buffer.find_flag_and_return_slice("\r\n\r\n");
+    assert((std::string_view{slice.data(), slice.size()}
+            == "GET / HTTP/1.1\r\n\r\n"));
+    buffer.r_increase(slice.size());
+    slice = buffer.find_flag_and_return_slice('o');
+    assert((std::string_view{slice.data(), slice.size()} == "lefto"));
+
+    // Bytes past the readable ones are never matched
+    buffer.r_increase(buffer.r_slice().size());
+    assert(buffer.find_flag_and_return_slice("\r\n").empty());
+    assert(buffer.find_flag_and_return_slice('G').empty());
+}
+
+auto test_move() {
+    StreamBuffer buffer{100};
+    std::string  data{"moved bytes"};
+    buffer.read_from(data);
+
+    StreamBuffer moved{std::move(buffer)};
+    assert(buffer.capacity() == 0 && buffer.empty());
+    assert((std::string_view{moved.r_slice().data(), moved.r_slice().size()}
+            == data));
+
+    StreamBuffer other{10};
+    other = std::move(moved);
+    assert(other.r_remaining() == static_cast<int>(data.size()));
+
+    // Without storage
+    StreamBuffer empty;
+    assert(empty.capacity() == 0 && empty.w_slice().empty());
+    empty = std::move(other);
+    assert(empty.r_remaining() == static_cast<int>(data.size()));
+}
+
+auto test_reuse() {
+    // Released mirrors are handed out again, with their stale bytes
+    std::vector<StreamBuffer> buffers;
+    std::string               stale(4096, 'x');
+    for (int i = 0; i < 100; i++) {
+        buffers.emplace_back(4096).read_from(stale);
+    }
+    buffers.clear();
+    for (int i = 0; i < 100; i++) {
+        StreamBuffer buffer{4096};
+        assert(buffer.empty());
+        assert(buffer.find_flag_and_return_slice('x').empty());
+    }
+}
+
+auto main() -> int {
+    test_stream(StreamBuffer{1024});
+    test_find(StreamBuffer{64});
+    // Compacted by copying
+    test_stream(StreamBuffer::flat(1024));
+    test_find(StreamBuffer::flat(64));
+    assert(!StreamBuffer::flat(64).mirrored());
+    test_move();
+    test_reuse();
+    console.info("mirrored: {}", StreamBuffer{1}.mirrored());
+}
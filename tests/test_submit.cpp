@@ -0,0 +1,93 @@
+#include "uvio/core.hpp"
+#include "uvio/sync.hpp"
+#include "uvio/time.hpp"
+
+using namespace uvio;
+using namespace uvio::sync;
+using namespace uvio::time;
+
+// One shard per worker, only ever touched on its own loop
+std::vector<std::unordered_map<std::size_t, std::size_t>> shards;
+
+auto shard_of(Runtime &runtime, std::size_t key) -> std::size_t {
+    return key % runtime.num_workers();
+}
+
+auto put(std::size_t key, std::size_t value) -> Task<> {
+    auto &shard = shards[current_worker_id()];
+    assert(current_worker_id() == key % shards.size());
+    shard[key] = value;
+    co_return;
+}
+
+auto get(std::size_t key) -> Task<std::size_t> {
+    // Suspends on the target loop too
+    co_await yield();
+    auto &shard = shards[current_worker_id()];
+    co_return shard.at(key);
+}
+
+auto client(Runtime &runtime, std::size_t id, Latch &done) -> Task<> {
+    constexpr std::size_t KEYS{500};
+    for (std::size_t i = 0; i < KEYS; i++) {
+        auto key = id * KEYS + i;
+        co_await runtime.submit_to(shard_of(runtime, key), put(key, key * 2));
+    }
+    for (std::size_t i = 0; i < KEYS; i++) {
+        auto key = id * KEYS + i;
+        auto shard = shard_of(runtime, key);
+        auto value = co_await runtime.submit_to(shard, get(key));
+        assert(value == key * 2);
+    }
+    done.count_down();
+}
+
+auto test(Runtime &runtime) -> Task<> {
+    shards.resize(runtime.num_workers());
+
+    // Back on the submitting loop, with timers running on the target one
+    auto worker = co_await runtime.submit_to(2, []() -> Task<std::size_t> {
+        co_await sleep(5ms);
+        co_return current_worker_id();
+    }());
+    assert(worker == 2);
+    assert(current_worker_id() == 0);
+
+    // To itself
+    worker = co_await runtime.submit_to(0, []() -> Task<std::size_t> {
+        co_return current_worker_id();
+    }());
+    assert(worker == 0);
+
+    // Exceptions come back too
+    auto caught = false;
+    try {
+        co_await runtime.submit_to(1, []() -> Task<std::size_t> {
+            throw std::runtime_error{"on worker 1"};
+            co_return 0;
+        }());
+    } catch (const std::runtime_error &) {
+        caught = current_worker_id() == 0;
+    }
+    assert(caught);
+
+    // From every loop to every loop
+    constexpr std::size_t CLIENTS_PER_WORKER{4};
+    auto  num_clients = runtime.num_workers() * CLIENTS_PER_WORKER;
+    Latch done{static_cast<std::ptrdiff_t>(num_clients)};
+    for (std::size_t id = 0; id < num_clients; id++) {
+        runtime.spawn_on(id % runtime.num_workers(), client(runtime, id, done));
+    }
+    co_await done.wait();
+    std::size_t total = 0;
+    for (auto &shard : shards) {
+        total += shard.size();
+    }
+    console.info("{} keys in {} shards", total, shards.size());
+    assert(total == num_clients * 500);
+}
+
+auto main() -> int {
+    Runtime runtime{4};
+    runtime.block_on(test(runtime));
+}
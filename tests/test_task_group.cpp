@@ -0,0 +1,160 @@
+#include "uvio/core.hpp"
+#include "uvio/time.hpp"
+
+using namespace uvio;
+using namespace uvio::time;
+
+auto elapsed_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+}
+
+std::size_t running{0};
+std::size_t max_running{0};
+std::size_t finished{0};
+std::size_t cancelled{0};
+
+auto child(std::chrono::milliseconds delay) -> Task<> {
+    running++;
+    max_running = std::max(max_running, running);
+    if (auto ret = co_await sleep(delay); !ret) {
+        cancelled++;
+    }
+    running--;
+    finished++;
+}
+
+auto failing(std::chrono::milliseconds delay) -> Task<> {
+    co_await sleep(delay);
+    throw std::runtime_error{"failing"};
+}
+
+auto reset() {
+    running = 0;
+    max_running = 0;
+    finished = 0;
+    cancelled = 0;
+}
+
+auto test_bounded() -> Task<> {
+    reset();
+    TaskGroup group{3};
+    for (int i = 0; i < 10; i++) {
+        co_await group.spawn(child(5ms));
+        assert(group.active() <= 3);
+    }
+    co_await group.join();
+    assert(finished == 10);
+    assert(max_running == 3);
+    assert(group.active() == 0);
+
+    // Nothing to wait for
+    co_await group.join();
+}
+
+auto test_try_spawn() -> Task<> {
+    reset();
+    TaskGroup group{2};
+    assert(group.try_spawn(child(5ms)));
+    assert(group.try_spawn(child(5ms)));
+    assert(!group.try_spawn(child(5ms)));
+    co_await group.join();
+    assert(finished == 2);
+    assert(group.try_spawn(child(1ms)));
+    co_await group.join();
+    assert(finished == 3);
+}
+
+auto test_waiting_spawners() -> Task<> {
+    reset();
+    TaskGroup group{1};
+    co_await group.spawn(child(5ms));
+    // Both wait for the slot, and get it in order
+    std::vector<int> order;
+    auto spawner = [](TaskGroup &group, std::vector<int> &order, int id)
+        -> Task<> {
+        co_await group.spawn(child(1ms));
+        order.push_back(id);
+    };
+    co_await when_all(spawner(group, order, 1), [&]() -> Task<> {
+        assert(group.waiting() == 1);
+        co_await spawner(group, order, 2);
+    }());
+    co_await group.join();
+    assert((order == std::vector<int>{1, 2}));
+    assert(finished == 3 && max_running == 1);
+}
+
+auto test_exception() -> Task<> {
+    reset();
+    auto      start = std::chrono::steady_clock::now();
+    TaskGroup group;
+    co_await group.spawn(child(10s));
+    co_await group.spawn(child(10s));
+    co_await group.spawn(failing(5ms));
+    auto caught = false;
+    try {
+        co_await group.join();
+    } catch (const std::runtime_error &) {
+        caught = true;
+    }
+    assert(caught);
+    assert(cancelled == 2);
+    assert(elapsed_since(start) < 1s);
+}
+
+auto test_spawn_after_failure() -> Task<> {
+    reset();
+    auto      start = std::chrono::steady_clock::now();
+    TaskGroup group;
+    co_await group.spawn(failing(1ms));
+    co_await sleep(5ms);
+    // The group stays cancelled, later children start cancelled
+    co_await group.spawn(child(10s));
+    co_await group.spawn(child(10s));
+    auto caught = false;
+    try {
+        co_await group.join();
+    } catch (const std::runtime_error &) {
+        caught = true;
+    }
+    assert(caught);
+    assert(cancelled == 2 && finished == 2);
+    assert(elapsed_since(start) < 1s);
+}
+
+auto test_cancel() -> Task<> {
+    reset();
+    auto      start = std::chrono::steady_clock::now();
+    TaskGroup group;
+    for (int i = 0; i < 5; i++) {
+        co_await group.spawn(child(10s));
+    }
+    co_await sleep(5ms);
+    group.cancel();
+    co_await group.join();
+    assert(cancelled == 5);
+    assert(elapsed_since(start) < 1s);
+
+    // Cancelling the parent cancels the group
+    reset();
+    CancellationSource source;
+    TaskGroup          linked{TaskGroup::UNBOUNDED, source.token()};
+    co_await linked.spawn(child(10s));
+    source.request_cancellation();
+    co_await linked.join();
+    assert(cancelled == 1);
+}
+
+auto test() -> Task<> {
+    co_await test_bounded();
+    co_await test_try_spawn();
+    co_await test_waiting_spawners();
+    co_await test_exception();
+    co_await test_spawn_after_failure();
+    co_await test_cancel();
+}
+
+auto main() -> int {
+    block_on(test());
+}
@@ -0,0 +1,112 @@
+#include "uvio/core.hpp"
+
+using namespace uvio;
+
+// Counts copies and moves of the payload
+struct Payload {
+    static inline std::size_t copies{0};
+    static inline std::size_t moves{0};
+
+    explicit Payload(std::string data)
+        : data_{std::move(data)} {}
+
+    Payload(const Payload &other)
+        : data_{other.data_} {
+        copies++;
+    }
+    Payload(Payload &&other) noexcept
+        : data_{std::move(other.data_)} {
+        moves++;
+    }
+    auto operator=(const Payload &) -> Payload & = delete;
+    auto operator=(Payload &&) -> Payload & = delete;
+
+    std::string data_;
+};
+
+auto make_payload() -> Task<Result<Payload>> {
+    co_return Payload{"payload"};
+}
+
+auto make_unique_int(int value) -> Task<std::unique_ptr<int>> {
+    auto ptr = std::make_unique<int>(value);
+    co_return ptr;
+}
+
+auto make_default() -> Task<std::vector<int>> {
+    co_return {};
+}
+
+auto fail(bool really) -> Task<int> {
+    if (really) {
+        throw std::runtime_error{"fail"};
+    }
+    co_return 1;
+}
+
+auto fail_void() -> Task<> {
+    co_await fail(false);
+    throw std::logic_error{"fail_void"};
+}
+
+auto test() -> Task<> {
+    // Constructed in place, moved out once
+    auto payload = co_await make_payload();
+    assert(payload && payload->data_ == "payload");
+    assert(Payload::copies == 0);
+    console.info("{} copies, {} moves", Payload::copies, Payload::moves);
+
+    // Move-only and not default-constructible
+    auto ptr = co_await make_unique_int(42);
+    assert(ptr && *ptr == 42);
+    auto empty = co_await make_default();
+    assert(empty.empty());
+
+    // Exceptions reach the awaiter, through nested tasks too
+    auto caught = false;
+    try {
+        co_await fail(true);
+    } catch (const std::runtime_error &e) {
+        caught = std::string_view{e.what()} == "fail";
+    }
+    assert(caught);
+    assert(co_await fail(false) == 1);
+
+    caught = false;
+    try {
+        co_await fail_void();
+    } catch (const std::logic_error &) {
+        caught = true;
+    }
+    assert(caught);
+
+    // Through a join handle
+    caught = false;
+    auto handle = spawn(fail(true));
+    try {
+        co_await handle;
+    } catch (const std::runtime_error &) {
+        caught = true;
+    }
+    assert(caught);
+
+    // Through when_all() once every task has finished, and when_any()
+    caught = false;
+    try {
+        co_await when_all(fail(false), fail(true));
+    } catch (const std::runtime_error &) {
+        caught = true;
+    }
+    assert(caught);
+    caught = false;
+    try {
+        co_await when_any(fail(true), fail(false));
+    } catch (const std::runtime_error &) {
+        caught = true;
+    }
+    assert(caught);
+}
+
+auto main() -> int {
+    block_on(test());
+}
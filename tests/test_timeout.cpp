@@ -0,0 +1,110 @@
+#include "uvio/core.hpp"
+#include "uvio/net.hpp"
+#include "uvio/sync.hpp"
+#include "uvio/time.hpp"
+
+using namespace uvio;
+using namespace uvio::net;
+using namespace uvio::sync;
+using namespace uvio::time;
+
+auto elapsed_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+}
+
+auto delayed(int value, std::chrono::milliseconds delay) -> Task<int> {
+    co_await sleep(delay);
+    co_return value;
+}
+
+// Connects and stays silent, neither writing nor reading
+auto idle_client(int port, std::chrono::milliseconds delay) -> Task<> {
+    auto stream = co_await TcpStream::connect("127.0.0.1", port);
+    assert(stream);
+    co_await sleep(delay);
+}
+
+auto test() -> Task<> {
+    auto start = std::chrono::steady_clock::now();
+    auto value = co_await timeout(delayed(1, 10s), 50ms);
+    assert(!value && value.error().value() == Error::TimedOut);
+    assert(elapsed_since(start) < 1s);
+
+    value = co_await timeout(delayed(2, 10ms), 1s);
+    assert(value && value.value() == 2);
+
+    // Any awaitable, the Result of the awaiter is passed through
+    start = std::chrono::steady_clock::now();
+    auto slept = co_await timeout(sleep(10s), 50ms);
+    assert(!slept && slept.error().value() == Error::TimedOut);
+    assert(elapsed_since(start) < 1s);
+
+    auto listener = TcpListener();
+    assert(listener.bind("127.0.0.1", 12349));
+    spawn(idle_client(12349, 500ms));
+    auto stream = (co_await listener.accept()).value();
+
+    std::array<char, 64> buf{};
+    start = std::chrono::steady_clock::now();
+    auto nread = co_await timeout(stream.read(buf), 50ms);
+    assert(!nread && nread.error().value() == Error::TimedOut);
+
+    // Stream deadlines
+    stream.set_read_timeout(50ms);
+    nread = co_await stream.read(buf);
+    assert(!nread && nread.error().value() == Error::TimedOut);
+    assert(elapsed_since(start) < 400ms);
+
+    // The peer never reads, so a large write cannot complete
+    stream.set_write_timeout(100ms);
+    std::string payload(64 * 1024 * 1024, 'x');
+    auto nwritten = co_await stream.write(payload);
+    assert(!nwritten && nwritten.error().value() == Error::TimedOut);
+}
+
+// A deadline cancelled before it expires must not keep the loop alive
+auto test_cancelled_deadline() -> Task<> {
+    auto value = co_await timeout(delayed(3, 10ms), 3s);
+    assert(value && value.value() == 3);
+}
+
+// Waits on the synchronization primitives are given up on timeout and leave
+// them usable
+auto test_sync() -> Task<> {
+    auto start = std::chrono::steady_clock::now();
+
+    auto [sender, receiver] = channel<int>(1);
+    auto received = co_await timeout(receiver.recv(), 50ms);
+    assert(!received && received.error().value() == Error::TimedOut);
+    assert(sender.try_send(1));
+    auto sent = co_await timeout(sender.send(2), 50ms);
+    assert(!sent && sent.error().value() == Error::TimedOut);
+    received = co_await receiver.recv();
+    assert(received && received.value() == 1);
+
+    Semaphore semaphore{0};
+    auto acquired = co_await timeout(semaphore.acquire(), 50ms);
+    assert(!acquired && acquired.error().value() == Error::TimedOut);
+    semaphore.release();
+    assert(semaphore.available() == 1);
+
+    auto [reply, reply_receiver] = oneshot<int>();
+    auto replied = co_await timeout(reply_receiver.recv(), 50ms);
+    assert(!replied && replied.error().value() == Error::TimedOut);
+
+    // The joined task keeps running
+    auto handle = spawn(delayed(4, 200ms));
+    auto joined = co_await timeout(handle, 50ms);
+    assert(!joined && joined.error().value() == Error::TimedOut);
+    assert(elapsed_since(start) < 1s);
+}
+
+auto main() -> int {
+    block_on(test());
+    block_on(test_sync());
+
+    auto start = std::chrono::steady_clock::now();
+    block_on(test_cancelled_deadline());
+    assert(elapsed_since(start) < 1s);
+}
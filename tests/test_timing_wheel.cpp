@@ -0,0 +1,70 @@
+#include "uvio/core.hpp"
+#include "uvio/time.hpp"
+
+#include <random>
+
+using namespace uvio;
+using namespace uvio::time;
+using uvio::time::detail::TimerEntry;
+using uvio::time::detail::TimingWheel;
+
+struct Probe {
+    TimerEntry entry_;
+    uint64_t   deadline_{0};
+    uint64_t   fired_at_{0};
+    bool       fired_{false};
+
+    static auto on_fire(void *data) -> void {
+        auto self = static_cast<Probe *>(data);
+        self->fired_ = true;
+        self->fired_at_ = uv_now(current_loop());
+    }
+};
+
+auto test() -> Task<> {
+    auto &wheel = TimingWheel::current();
+
+    std::mt19937                            gen{42};
+    std::uniform_int_distribution<uint64_t> timeouts{0, 300};
+    std::vector<Probe>                      probes(1000);
+    auto                                    now = uv_now(current_loop());
+    for (auto &probe : probes) {
+        auto timeout = timeouts(gen);
+        probe.deadline_ = now + timeout;
+        wheel.arm(probe.entry_, timeout, Probe::on_fire, &probe);
+    }
+    // Every third entry is cancelled, every fifth one re-armed further away
+    for (std::size_t i = 0; i < probes.size(); i++) {
+        if (i % 3 == 0) {
+            probes[i].entry_.cancel();
+        } else if (i % 5 == 0) {
+            probes[i].deadline_ = now + 400;
+            wheel.arm(probes[i].entry_, 400, Probe::on_fire, &probes[i]);
+        }
+    }
+
+    co_await sleep(600ms);
+
+    for (std::size_t i = 0; i < probes.size(); i++) {
+        auto &probe = probes[i];
+        if (i % 3 == 0) {
+            assert(!probe.fired_);
+            continue;
+        }
+        assert(probe.fired_);
+        assert(probe.fired_at_ >= probe.deadline_);
+        assert(probe.fired_at_ < probe.deadline_ + 100);
+    }
+    assert(wheel.size() == 0);
+
+    // Deadlines beyond the first levels are cascaded down before firing
+    Probe far;
+    far.deadline_ = uv_now(current_loop()) + 5000;
+    wheel.arm(far.entry_, 5000, Probe::on_fire, &far);
+    co_await sleep(5100ms);
+    assert(far.fired_ && far.fired_at_ >= far.deadline_);
+}
+
+auto main() -> int {
+    block_on(test());
+}
@@ -0,0 +1,82 @@
+#include "uvio/core.hpp"
+#include "uvio/sync.hpp"
+
+#include <thread>
+
+using namespace uvio;
+using namespace uvio::sync;
+using uvio::detail::MpscQueue;
+
+auto test_mpsc_queue() {
+    constexpr std::size_t NUM_PRODUCERS{4};
+    constexpr std::size_t NUM_VALUES{100000};
+
+    MpscQueue<std::pair<std::size_t, std::size_t>> queue;
+    std::vector<std::thread>                       producers;
+    for (std::size_t id = 0; id < NUM_PRODUCERS; id++) {
+        producers.emplace_back([&queue, id]() {
+            for (std::size_t i = 0; i < NUM_VALUES; i++) {
+                queue.push({id, i});
+            }
+        });
+    }
+
+    // Values of one producer come out in order
+    std::vector<std::size_t> next(NUM_PRODUCERS, 0);
+    std::size_t              received = 0;
+    while (received < NUM_PRODUCERS * NUM_VALUES) {
+        received += queue.consume([&next](auto &&value) {
+            auto [id, i] = value;
+            assert(next[id] == i);
+            next[id]++;
+        });
+    }
+    for (auto &producer : producers) {
+        producer.join();
+    }
+    assert(queue.empty());
+}
+
+std::atomic<std::size_t> resumed_on_own_loop{0};
+
+auto waiter(Latch &start, Latch &done) -> Task<> {
+    auto worker_id = current_worker_id();
+    auto thread_id = std::this_thread::get_id();
+    co_await start.wait();
+    // Counted down by a plain thread, yet back on this loop
+    if (current_worker_id() == worker_id
+        && std::this_thread::get_id() == thread_id) {
+        resumed_on_own_loop.fetch_add(1, std::memory_order::relaxed);
+    }
+    done.count_down();
+}
+
+auto test_latch(Runtime &runtime) -> Task<> {
+    auto  num_waiters = static_cast<std::ptrdiff_t>(runtime.num_workers() * 8);
+    Latch start{1};
+    Latch done{num_waiters};
+    for (std::ptrdiff_t i = 0; i < num_waiters; i++) {
+        runtime.spawn_on(static_cast<std::size_t>(i) % runtime.num_workers(),
+                         waiter(start, done));
+    }
+
+    std::thread releaser{[&start]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds{100});
+        start.count_down();
+    }};
+    auto thread_id = std::this_thread::get_id();
+    co_await done.wait();
+    assert(std::this_thread::get_id() == thread_id);
+    releaser.join();
+
+    console.info("{} waiters resumed on their own loop",
+                 resumed_on_own_loop.load());
+    assert(resumed_on_own_loop == static_cast<std::size_t>(num_waiters));
+}
+
+auto main() -> int {
+    test_mpsc_queue();
+
+    Runtime runtime{4};
+    runtime.block_on(test_latch(runtime));
+}
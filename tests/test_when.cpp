@@ -0,0 +1,68 @@
+#include "uvio/core.hpp"
+#include "uvio/time.hpp"
+
+using namespace uvio;
+using namespace uvio::time;
+
+auto delayed(int value, std::chrono::milliseconds delay) -> Task<int> {
+    co_await sleep(delay);
+    co_return value;
+}
+
+auto delayed_string(std::chrono::milliseconds delay) -> Task<std::string> {
+    co_await sleep(delay);
+    co_return std::string{"done"};
+}
+
+auto nothing(std::chrono::milliseconds delay) -> Task<> {
+    co_await sleep(delay);
+}
+
+auto elapsed_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+}
+
+auto test() -> Task<> {
+    auto start = std::chrono::steady_clock::now();
+    auto [a, b, c] = co_await when_all(delayed(1, 200ms),
+                                       delayed_string(100ms),
+                                       nothing(150ms));
+    console.info("when_all: {} {} after {}ms",
+                 a,
+                 b,
+                 elapsed_since(start).count());
+    assert(a == 1 && b == "done");
+    assert(elapsed_since(start) < 300ms);
+
+    start = std::chrono::steady_clock::now();
+    std::vector<Task<int>> tasks;
+    for (int i = 0; i < 10; i++) {
+        tasks.push_back(delayed(i, std::chrono::milliseconds{10 * i}));
+    }
+    auto values = co_await when_all(std::move(tasks));
+    assert(values.size() == 10);
+    for (int i = 0; i < 10; i++) {
+        assert(values[i] == i);
+    }
+
+    start = std::chrono::steady_clock::now();
+    auto any = co_await when_any(delayed(1, 300ms),
+                                 delayed_string(50ms),
+                                 nothing(200ms));
+    console.info("when_any: winner {} after {}ms",
+                 any.index(),
+                 elapsed_since(start).count());
+    assert(any.index() == 1 && std::get<1>(any) == "done");
+    assert(elapsed_since(start) < 150ms);
+
+    std::vector<Task<int>> racers;
+    racers.push_back(delayed(7, 100ms));
+    racers.push_back(delayed(8, 10ms));
+    auto [index, value] = co_await when_any(std::move(racers));
+    assert(index == 1 && value == 8);
+}
+
+auto main() -> int {
+    block_on(test());
+}
@@ -0,0 +1,96 @@
+#include "uvio/core.hpp"
+#include "uvio/sync.hpp"
+
+using namespace uvio;
+using namespace uvio::sync;
+
+constexpr std::size_t NUM_TASKS{64};
+
+std::array<std::atomic<std::size_t>, NUM_TASKS> runs{};
+
+// CPU-bound, never suspends
+auto crunch(std::size_t id, Latch &done) -> Task<> {
+    auto until = std::chrono::steady_clock::now()
+                 + std::chrono::milliseconds{2};
+    while (std::chrono::steady_clock::now() < until) {
+    }
+    runs[id].fetch_add(1, std::memory_order::relaxed);
+    done.count_down();
+    co_return;
+}
+
+auto spawn_all(Runtime &runtime) -> Task<> {
+    Latch done{static_cast<std::ptrdiff_t>(NUM_TASKS)};
+    for (std::size_t id = 0; id < NUM_TASKS; id++) {
+        runtime.spawn_stealable(crunch(id, done));
+    }
+    co_await done.wait();
+}
+
+auto reset() -> void {
+    for (auto &count : runs) {
+        count.store(0, std::memory_order::relaxed);
+    }
+}
+
+auto check_ran_once() -> void {
+    for (auto &count : runs) {
+        assert(count.load(std::memory_order::relaxed) == 1);
+    }
+}
+
+auto test_stealing() {
+    reset();
+    Runtime runtime{4, RuntimeOptions{.work_stealing = true}};
+    runtime.block_on(spawn_all(runtime));
+    check_ran_once();
+
+    std::size_t started = 0;
+    std::size_t stolen = 0;
+    for (std::size_t id = 0; id < runtime.num_workers(); id++) {
+        auto stats = runtime.worker_stats(id);
+        console.info("worker {}: spawned {} started {} stolen {} failed {} "
+                     "max depth {}",
+                     id,
+                     stats.spawned,
+                     stats.started,
+                     stats.stolen,
+                     stats.failed_steals,
+                     stats.max_queue_depth);
+        assert(stats.queue_depth == 0);
+        started += stats.started;
+        stolen += stats.stolen;
+    }
+    assert(runtime.worker_stats(0).spawned == NUM_TASKS);
+    assert(runtime.worker_stats(0).max_queue_depth > 0);
+    assert(started == NUM_TASKS);
+    assert(stolen > 0);
+}
+
+auto test_no_stealing() {
+    reset();
+    Runtime runtime{4};
+    runtime.block_on(spawn_all(runtime));
+    check_ran_once();
+    assert(runtime.worker_stats(0).spawned == 0);
+}
+
+// Queued tasks keep worker 0 alive after the first coroutine returned
+auto test_detached() {
+    reset();
+    Runtime runtime{2, RuntimeOptions{.work_stealing = true}};
+    Latch   done{static_cast<std::ptrdiff_t>(NUM_TASKS)};
+    runtime.block_on([](Runtime &runtime, Latch &done) -> Task<> {
+        for (std::size_t id = 0; id < NUM_TASKS; id++) {
+            runtime.spawn_stealable(crunch(id, done));
+        }
+        co_return;
+    }(runtime, done));
+    check_ran_once();
+}
+
+auto main() -> int {
+    test_stealing();
+    test_no_stealing();
+    test_detached();
+}
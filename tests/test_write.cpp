@@ -0,0 +1,159 @@
+#include "uvio/core.hpp"
+#include "uvio/io.hpp"
+#include "uvio/net.hpp"
+#include "uvio/time.hpp"
+
+#include <algorithm>
+#include <memory>
+
+using namespace uvio;
+using namespace uvio::io;
+using namespace uvio::net;
+using namespace std::string_view_literals;
+using namespace std::chrono_literals;
+
+constexpr int PORT{12353};
+
+auto make_payload(std::size_t size, char seed) -> std::string {
+    std::string payload(size, seed);
+    for (std::size_t i = 0; i < payload.size(); i += 13) {
+        payload[i] = static_cast<char>('a' + i % 26);
+    }
+    return payload;
+}
+
+auto server(TcpListener &listener) -> Task<> {
+    auto stream = (co_await listener.accept()).value();
+    auto large = make_payload(256 * 1024, 'l');
+    auto vector = make_payload(100 * 1024, 'v');
+    auto borrowed = make_payload(64 * 1024, 'b');
+
+    // A short string is stored inside the string itself, and moves with it
+    auto ret = co_await stream.write(std::string{"short"});
+    assert(ret && ret.value() == 5);
+
+    // The payload belongs to the write, not to the caller
+    {
+        auto write = stream.write(std::string{large});
+        ret = co_await write;
+        assert(ret && ret.value() == large.size());
+    }
+    ret = co_await stream.write(
+        std::vector<char>{vector.begin(), vector.end()});
+    assert(ret && ret.value() == vector.size());
+
+    // Bytes are shared with the write
+    auto bytes = Bytes::copy_from(std::string_view{"shared bytes"});
+    ret = co_await stream.write(bytes);
+    assert(ret && bytes.as_string_view() == "shared bytes");
+
+    ret = co_await stream.write_borrowed(borrowed);
+    assert(ret && ret.value() == borrowed.size());
+
+    // Slices go out in order without being joined, also more of them than
+    // fit on the stack
+    std::string_view                     head{"HTTP/1.0 200 OK\r\n\r\n"};
+    std::array<std::span<const char>, 3> response{head, large, "end"sv};
+    ret = co_await stream.write_vectored(response);
+    assert(ret && ret.value() == head.size() + large.size() + 3);
+    std::vector<std::span<const char>> digits(20, "0123456789"sv);
+    ret = co_await stream.write_vectored(digits);
+    assert(ret && ret.value() == 200);
+    // Nothing to write succeeds with 0 bytes
+    ret = co_await stream.write_vectored({});
+    assert(ret && ret.value() == 0);
+
+    // The same through the write half, and a writer flushing its buffer
+    auto [read_half, write_half] = std::move(stream).into_split();
+    ret = co_await write_half.write(std::string{"half"});
+    assert(ret);
+    ret = co_await write_half.write_borrowed(std::string_view{"borrowed"});
+    assert(ret);
+    ret = co_await write_half.write_vectored(response);
+    assert(ret);
+
+    TcpWriter writer{std::move(write_half), 1024};
+    ret = co_await writer.write(std::string_view{"buffered"});
+    assert(ret);
+    auto flushed = co_await writer.write_all(large);
+    assert(flushed);
+
+    // Buffered while it fits, then sent along with the buffered bytes
+    std::array<std::span<const char>, 2> small{head, "small"sv};
+    ret = co_await writer.write_vectored(small);
+    assert(ret && ret.value() == head.size() + 5);
+    ret = co_await writer.write_vectored(response);
+    assert(ret && ret.value() == head.size() + large.size() + 3);
+    ret = co_await writer.write(std::string_view{"tail"});
+    assert(ret);
+    flushed = co_await writer.flush();
+    assert(flushed);
+}
+
+auto client(std::string expected) -> Task<> {
+    auto stream = (co_await TcpStream::connect("127.0.0.1", PORT)).value();
+
+    std::string received(expected.size(), '\0');
+    auto        ret = co_await stream.read_exact(received);
+    assert(ret);
+    assert(received == expected);
+}
+
+auto test_write() -> Task<> {
+    auto large = make_payload(256 * 1024, 'l');
+    auto response = "HTTP/1.0 200 OK\r\n\r\n" + large + "end";
+    auto expected = "short" + large + make_payload(100 * 1024, 'v')
+                    + "shared bytes" + make_payload(64 * 1024, 'b') + response;
+    for (int i = 0; i < 20; i++) {
+        expected += "0123456789";
+    }
+    expected += "half" + std::string{"borrowed"} + response + "buffered" + large
+                + "HTTP/1.0 200 OK\r\n\r\nsmall" + response + "tail";
+
+    TcpListener listener;
+    auto        ret = listener.bind("127.0.0.1", PORT);
+    assert(ret);
+    co_await when_all(server(listener), client(expected));
+}
+
+// The peer only starts reading once the write has timed out and the borrowed
+// buffer has been overwritten and freed
+auto timed_out_server(TcpListener &listener, std::string expected) -> Task<> {
+    auto stream = (co_await listener.accept()).value();
+    stream.set_write_timeout(50ms);
+    auto borrowed = std::make_unique<std::string>(std::move(expected));
+    auto ret = co_await stream.write_borrowed(*borrowed);
+    assert(!ret && ret.error().value() == Error::TimedOut);
+    std::fill(borrowed->begin(), borrowed->end(), 'z');
+    borrowed.reset();
+
+    // Kept open until the peer has read everything and closed
+    std::array<char, 1> byte{};
+    auto                eof = co_await stream.read(byte);
+    assert(!eof);
+}
+
+auto slow_client(std::string expected) -> Task<> {
+    auto stream
+        = (co_await TcpStream::connect("127.0.0.1", PORT + 1)).value();
+    co_await time::sleep(200ms);
+    std::string received(expected.size(), '\0');
+    auto        ret = co_await stream.read_exact(received);
+    assert(ret);
+    assert(received == expected);
+}
+
+auto test_timed_out_borrow() -> Task<> {
+    auto expected = make_payload(32 * 1024 * 1024, 't');
+
+    TcpListener listener;
+    auto        ret = listener.bind("127.0.0.1", PORT + 1);
+    assert(ret);
+    co_await when_all(timed_out_server(listener, expected),
+                      slow_client(expected));
+}
+
+auto main() -> int {
+    block_on(test_write());
+    block_on(test_timed_out_borrow());
+}
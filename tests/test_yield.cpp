@@ -0,0 +1,58 @@
+#include "uvio/core.hpp"
+
+#include <vector>
+
+using namespace uvio;
+
+std::vector<int> trace;
+std::size_t      ticks = 0;
+
+auto ping_pong(int id) -> Task<> {
+    for (int i = 0; i < 3; i++) {
+        trace.push_back(id);
+        co_await yield();
+    }
+}
+
+auto ready_value(std::size_t i) -> Task<std::size_t> {
+    co_return i;
+}
+
+// Never blocks, like a reader served from its buffer
+auto hot_loop() -> Task<std::size_t> {
+    std::size_t sum = 0;
+    for (std::size_t i = 0; i < 4 * uvio::detail::TASK_BUDGET; i++) {
+        sum += co_await ready_value(i);
+    }
+    co_return sum;
+}
+
+auto ticker() -> Task<> {
+    for (int i = 0; i < 100; i++) {
+        ticks++;
+        co_await yield();
+    }
+}
+
+auto test() -> Task<> {
+    auto a = spawn(ping_pong(1));
+    auto b = spawn(ping_pong(2));
+    co_await a;
+    co_await b;
+    assert((trace == std::vector<int>{1, 2, 1, 2, 1, 2}));
+
+    // The hot loop runs out of budget a few times, letting the ticker run
+    auto t = spawn(ticker());
+    co_await yield();
+    auto before = ticks;
+    auto sum = co_await hot_loop();
+    constexpr auto n = 4 * uvio::detail::TASK_BUDGET;
+    assert(sum == n * (n - 1) / 2);
+    console.info("ticks during the hot loop: {}", ticks - before);
+    assert(ticks - before >= 3);
+    co_await t;
+}
+
+auto main() -> int {
+    block_on(test());
+}
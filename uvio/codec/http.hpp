@@ -8,11 +8,18 @@ namespace uvio::codec {
 using namespace uvio::net;
 
 class HttpCodec : public Codec<HttpCodec> {
+public:
+    // Longest start line, and longest header block, a peer may send before
+    // the connection is failed with `Error::FrameTooLarge`
+    constexpr static std::size_t MAX_HEADER_SIZE{64 * 1024};
+
 public:
     template <typename Reader>
     auto decode(http::HttpRequest &req, Reader &reader) -> Task<Result<void>> {
         std::string request_line;
-        if (auto ret = co_await reader.read_until(request_line, "\r\n"); !ret) {
+        if (auto ret
+            = co_await reader.read_until(request_line, "\r\n", MAX_HEADER_SIZE);
+            !ret) {
             co_return unexpected{ret.error()};
         }
         LOG_DEBUG("{}", request_line);
@@ -36,7 +43,9 @@ public:
             co_return Result<void>{};
         }
 
-        if (auto ret = co_await reader.read_until(request_headers, "\r\n\r\n");
+        if (auto ret = co_await reader.read_until(request_headers,
+                                                  "\r\n\r\n",
+                                                  MAX_HEADER_SIZE);
             !ret) {
             co_return unexpected{ret.error()};
         }
@@ -76,7 +85,9 @@ public:
     auto decode(http::HttpResponse &resp, Reader &reader)
         -> Task<Result<void>> {
         std::string status_line;
-        if (auto ret = co_await reader.read_until(status_line, "\r\n"); !ret) {
+        if (auto ret
+            = co_await reader.read_until(status_line, "\r\n", MAX_HEADER_SIZE);
+            !ret) {
             co_return unexpected{ret.error()};
         }
         LOG_DEBUG("{}", status_line);
@@ -99,7 +110,9 @@ public:
             co_return Result<void>{};
         }
 
-        if (auto ret = co_await reader.read_until(request_headers, "\r\n\r\n");
+        if (auto ret = co_await reader.read_until(request_headers,
+                                                  "\r\n\r\n",
+                                                  MAX_HEADER_SIZE);
             !ret) {
             co_return unexpected{ret.error()};
         }
@@ -145,14 +158,13 @@ public:
     template <typename Writer>
     auto http_response(http::HttpResponse &resp, Writer &writer)
         -> Task<Result<void>> {
-        // 对普通的 HTTP 请求的响应
-        if (auto ret = co_await writer.write(
-                std::format("HTTP/1.0 {} {}\r\nContent-Length: {}\r\n\r\n{}",
-                            resp.status_code,
-                            resp.status_text,
-                            resp.body.size(),
-                            resp.body));
-            !ret) {
+        // 对普通的 HTTP 请求的响应, 响应头与 body 一起写出, 不再拼接
+        auto head = std::format("HTTP/1.0 {} {}\r\nContent-Length: {}\r\n\r\n",
+                                resp.status_code,
+                                resp.status_text,
+                                resp.body.size());
+        std::array<std::span<const char>, 2> response{head, resp.body};
+        if (auto ret = co_await writer.write_vectored(response); !ret) {
             co_return unexpected{ret.error()};
         }
         if (auto ret = co_await writer.flush(); !ret) {
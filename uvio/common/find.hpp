@@ -0,0 +1,151 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define UVIO_SIMD_FIND 1
+#endif
+
+// Length-bounded searches for a delimiter (a char, or a short string such as
+// "\r\n\r\n") in a buffer. Chars go to memchr(), which libc already
+// vectorizes. Strings are searched 16 bytes at a time with SSE2, or 32 at a
+// time with AVX2 where the CPU has it (checked at run time), looking for
+// their first and last chars at once, so only the positions where both match
+// are compared in full (W. Muła, "SIMD-friendly algorithms for substring
+// searching").
+namespace uvio::detail {
+
+#if defined(UVIO_SIMD_FIND)
+
+// Index of the first set bit of `mask`, plus `offset`
+[[nodiscard]]
+static inline auto first_match(unsigned mask, std::size_t offset) noexcept
+    -> std::size_t {
+    return offset + static_cast<std::size_t>(std::countr_zero(mask));
+}
+
+// Whether `flag` starts at each candidate of `mask` (shifted by `offset`)
+[[nodiscard]]
+static inline auto verify_matches(unsigned         mask,
+                                  const char      *data,
+                                  std::size_t      offset,
+                                  std::string_view flag) noexcept
+    -> std::size_t {
+    while (mask != 0) {
+        auto pos = first_match(mask, offset);
+        if (std::memcmp(data + pos + 1, flag.data() + 1, flag.size() - 2)
+            == 0) {
+            return pos;
+        }
+        mask &= mask - 1;
+    }
+    return std::string_view::npos;
+}
+
+// `flag` has at least 2 chars, and `size` is at least `flag.size()`
+[[nodiscard]]
+static inline auto find_flag_sse2(const char      *data,
+                                  std::size_t      size,
+                                  std::string_view flag) noexcept
+    -> std::size_t {
+    auto        first = _mm_set1_epi8(flag.front());
+    auto        last = _mm_set1_epi8(flag.back());
+    auto        last_offset = flag.size() - 1;
+    std::size_t i = 0;
+    for (; i + last_offset + 16 <= size; i += 16) {
+        auto block_first
+            = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        auto block_last = _mm_loadu_si128(
+            reinterpret_cast<const __m128i *>(data + i + last_offset));
+        auto mask = static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first),
+                                            _mm_cmpeq_epi8(block_last, last))));
+        if (auto pos = verify_matches(mask, data, i, flag);
+            pos != std::string_view::npos) {
+            return pos;
+        }
+    }
+    if (auto pos = std::string_view{data + i, size - i}.find(flag);
+        pos != std::string_view::npos) {
+        return pos + i;
+    }
+    return std::string_view::npos;
+}
+
+[[gnu::target("avx2")]] [[nodiscard]]
+static inline auto find_flag_avx2(const char      *data,
+                                  std::size_t      size,
+                                  std::string_view flag) noexcept
+    -> std::size_t {
+    auto        first = _mm256_set1_epi8(flag.front());
+    auto        last = _mm256_set1_epi8(flag.back());
+    auto        last_offset = flag.size() - 1;
+    std::size_t i = 0;
+    for (; i + last_offset + 32 <= size; i += 32) {
+        auto block_first
+            = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        auto block_last = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(data + i + last_offset));
+        auto mask = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(block_first, first),
+                             _mm256_cmpeq_epi8(block_last, last))));
+        if (auto pos = verify_matches(mask, data, i, flag);
+            pos != std::string_view::npos) {
+            return pos;
+        }
+    }
+    if (auto pos = find_flag_sse2(data + i, size - i, flag);
+        pos != std::string_view::npos) {
+        return pos + i;
+    }
+    return std::string_view::npos;
+}
+
+[[nodiscard]]
+static inline auto has_avx2() noexcept -> bool {
+    static const bool supported = __builtin_cpu_supports("avx2") != 0;
+    return supported;
+}
+
+#endif
+
+// Offset of the first `c` in `haystack`, or npos
+[[nodiscard]]
+static inline auto find_char(std::string_view haystack, char c) noexcept
+    -> std::size_t {
+    if (haystack.empty()) {
+        return std::string_view::npos;
+    }
+    auto found = std::memchr(haystack.data(), c, haystack.size());
+    if (found == nullptr) {
+        return std::string_view::npos;
+    }
+    return static_cast<std::size_t>(static_cast<const char *>(found)
+                                    - haystack.data());
+}
+
+// Offset of the first `flag` in `haystack`, or npos
+[[nodiscard]]
+static inline auto find_flag(std::string_view haystack,
+                             std::string_view flag) noexcept -> std::size_t {
+    if (flag.size() <= 1) {
+        return flag.empty() ? 0 : find_char(haystack, flag.front());
+    }
+    if (haystack.size() < flag.size()) {
+        return std::string_view::npos;
+    }
+#if defined(UVIO_SIMD_FIND)
+    if (has_avx2()) {
+        return find_flag_avx2(haystack.data(), haystack.size(), flag);
+    }
+    return find_flag_sse2(haystack.data(), haystack.size(), flag);
+#else
+    return haystack.find(flag);
+#endif
+}
+
+} // namespace uvio::detail
@@ -16,6 +16,14 @@ public:
         WriteZero,
         ReuniteError,
         ResolveFailed,
+        TaskAborted,
+        Cancelled,
+        TimedOut,
+        ChannelClosed,
+        ChannelFull,
+        ChannelEmpty,
+        ChannelLagged,
+        FrameTooLarge,
         Unclassified,
     };
 
@@ -24,6 +32,11 @@ public:
         : error_code_{error_code} {}
 
 public:
+    [[nodiscard]]
+    auto value() const noexcept -> int {
+        return error_code_;
+    }
+
     [[nodiscard]]
     auto message() const noexcept -> std::string_view {
         switch (error_code_) {
@@ -35,6 +48,22 @@ public:
             return "IO reunite error";
         case ResolveFailed:
             return "DNS resolve failed";
+        case TaskAborted:
+            return "Task aborted before completion";
+        case Cancelled:
+            return "Operation cancelled";
+        case TimedOut:
+            return "Operation timed out";
+        case ChannelClosed:
+            return "Channel closed";
+        case ChannelFull:
+            return "Channel full";
+        case ChannelEmpty:
+            return "Channel empty";
+        case ChannelLagged:
+            return "Receiver lagged behind, messages skipped";
+        case FrameTooLarge:
+            return "Frame exceeds the size limit";
         case Unclassified:
             return "Unclassified error";
         default:
@@ -2,5 +2,9 @@
 
 #include "uvio/common/result.hpp"
 #include "uvio/coroutine/task.hpp"
+#include "uvio/coroutine/task_group.hpp"
+#include "uvio/coroutine/when_all.hpp"
+#include "uvio/coroutine/when_any.hpp"
+#include "uvio/coroutine/yield.hpp"
 #include "uvio/macros.hpp"
 #include "uvio/runtime.hpp"
@@ -0,0 +1,201 @@
+#pragma once
+
+#include "uvio/debug.hpp"
+
+#include <memory>
+#include <type_traits>
+
+namespace uvio {
+
+class CancellationRegistration;
+
+// Awaiters that keep waiting when cancelled, e.g. a lock handed out in FIFO
+// order, declare `constexpr static bool IGNORES_CANCELLATION{true};` so that
+// `timeout()` can refuse them
+template <typename Awaiter>
+concept IgnoresCancellation
+    = std::remove_cvref_t<Awaiter>::IGNORES_CANCELLATION;
+
+namespace detail {
+    struct CancellationState {
+        bool                      requested_{false};
+        CancellationRegistration *head_{nullptr};
+    };
+} // namespace detail
+
+// Observes a `CancellationSource`. A default constructed token is never
+// cancelled. Tokens are loop-local: request cancellation on the loop that
+// runs the tasks holding them.
+class CancellationToken {
+    friend class CancellationSource;
+    friend class CancellationRegistration;
+
+public:
+    CancellationToken() = default;
+
+private:
+    explicit CancellationToken(
+        std::shared_ptr<detail::CancellationState> state)
+        : state_{std::move(state)} {}
+
+public:
+    [[nodiscard]]
+    auto can_be_cancelled() const noexcept -> bool {
+        return state_ != nullptr;
+    }
+
+    [[nodiscard]]
+    auto is_cancellation_requested() const noexcept -> bool {
+        return state_ != nullptr && state_->requested_;
+    }
+
+private:
+    std::shared_ptr<detail::CancellationState> state_;
+};
+
+class CancellationSource {
+public:
+    CancellationSource()
+        : state_{std::make_shared<detail::CancellationState>()} {}
+
+public:
+    [[nodiscard]]
+    auto token() const noexcept -> CancellationToken {
+        return CancellationToken{state_};
+    }
+
+    [[nodiscard]]
+    auto is_cancellation_requested() const noexcept -> bool {
+        return state_->requested_;
+    }
+
+    // Run every registered callback once, later registrations fail
+    inline auto request_cancellation() -> void;
+
+private:
+    std::shared_ptr<detail::CancellationState> state_;
+};
+
+// Intrusive node of the callback list of a token, awaiters keep one while they
+// are suspended and stop their pending libuv operation from the callback
+class CancellationRegistration {
+    friend class CancellationSource;
+
+public:
+    using Callback = void (*)(void *data);
+
+public:
+    CancellationRegistration() = default;
+
+    ~CancellationRegistration() {
+        reset();
+    }
+
+    // No copy, no move (linked into the token)
+    CancellationRegistration(const CancellationRegistration &) = delete;
+    auto operator=(const CancellationRegistration &) = delete;
+    CancellationRegistration(CancellationRegistration &&) = delete;
+    auto operator=(CancellationRegistration &&) = delete;
+
+public:
+    // Returns false, without registering, when cancellation was already
+    // requested: the caller must not start waiting
+    [[nodiscard]]
+    auto register_callback(const CancellationToken &token,
+                           Callback                 callback,
+                           void                    *data) -> bool {
+        ASSERT_MSG(state_ == nullptr, "already registered");
+        if (!token.can_be_cancelled()) {
+            return true;
+        }
+        if (token.is_cancellation_requested()) {
+            return false;
+        }
+        state_ = token.state_;
+        callback_ = callback;
+        data_ = data;
+        next_ = state_->head_;
+        if (next_ != nullptr) {
+            next_->prev_ = this;
+        }
+        state_->head_ = this;
+        return true;
+    }
+
+    auto reset() noexcept -> void {
+        if (state_ == nullptr) {
+            return;
+        }
+        if (prev_ != nullptr) {
+            prev_->next_ = next_;
+        } else {
+            state_->head_ = next_;
+        }
+        if (next_ != nullptr) {
+            next_->prev_ = prev_;
+        }
+        prev_ = next_ = nullptr;
+        state_.reset();
+    }
+
+private:
+    std::shared_ptr<detail::CancellationState> state_;
+    CancellationRegistration                  *prev_{nullptr};
+    CancellationRegistration                  *next_{nullptr};
+    Callback                                   callback_{nullptr};
+    void                                      *data_{nullptr};
+};
+
+inline auto CancellationSource::request_cancellation() -> void {
+    if (state_->requested_) {
+        return;
+    }
+    state_->requested_ = true;
+    // A callback may resume a coroutine that drops other registrations, or
+    // even this source, so keep the state alive and always unlink the head
+    // before invoking it
+    auto state = state_;
+    while (auto registration = state->head_) {
+        auto callback = registration->callback_;
+        auto data = registration->data_;
+        registration->reset();
+        callback(data);
+    }
+}
+
+// Source that is also cancelled when `parent` is, combinators use it to cancel
+// their children without touching the token of the caller
+class LinkedCancellationSource {
+public:
+    explicit LinkedCancellationSource(const CancellationToken &parent) {
+        if (!parent_.register_callback(parent, on_parent_cancel, this)) {
+            source_.request_cancellation();
+        }
+    }
+
+public:
+    [[nodiscard]]
+    auto token() const noexcept -> CancellationToken {
+        return source_.token();
+    }
+
+    [[nodiscard]]
+    auto is_cancellation_requested() const noexcept -> bool {
+        return source_.is_cancellation_requested();
+    }
+
+    auto request_cancellation() -> void {
+        source_.request_cancellation();
+    }
+
+private:
+    static auto on_parent_cancel(void *data) -> void {
+        static_cast<LinkedCancellationSource *>(data)->request_cancellation();
+    }
+
+private:
+    CancellationSource       source_;
+    CancellationRegistration parent_;
+};
+
+} // namespace uvio
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <new>
+
+namespace uvio {
+
+struct FramePoolStats {
+    // Frames handed out by the pool
+    std::size_t allocations{0};
+    // Frames given back to the pool
+    std::size_t deallocations{0};
+    // Allocations served from a free list
+    std::size_t reused{0};
+    // Allocations that fell through to the global `operator new`
+    std::size_t heap_allocations{0};
+};
+
+namespace detail {
+    // Thread-local free lists of coroutine frames, grouped in 64-byte size
+    // classes. A frame freed on another thread than the one that allocated it
+    // simply joins the free lists of the freeing thread.
+    class FramePool {
+        struct Block {
+            Block *next_;
+        };
+
+        struct FreeList {
+            Block      *head_{nullptr};
+            std::size_t count_{0};
+        };
+
+    public:
+        constexpr static std::size_t SIZE_CLASS_STEP{64};
+        // Frames bigger than 4 KiB are not pooled
+        constexpr static std::size_t NUM_SIZE_CLASSES{64};
+        constexpr static std::size_t MAX_CACHED_PER_CLASS{1024};
+
+    public:
+        FramePool() = default;
+
+        ~FramePool() {
+            for (auto &list : free_lists_) {
+                while (list.head_ != nullptr) {
+                    auto block = list.head_;
+                    list.head_ = block->next_;
+                    ::operator delete(block);
+                }
+            }
+        }
+
+        // No copy
+        FramePool(const FramePool &) = delete;
+        auto operator=(const FramePool &) = delete;
+
+    public:
+        [[nodiscard]]
+        auto allocate(std::size_t size) -> void * {
+            stats_.allocations++;
+            auto index = size_class(size);
+            if (index >= NUM_SIZE_CLASSES) {
+                stats_.heap_allocations++;
+                return ::operator new(size);
+            }
+
+            auto &list = free_lists_[index];
+            if (list.head_ != nullptr) {
+                auto block = list.head_;
+                list.head_ = block->next_;
+                list.count_--;
+                stats_.reused++;
+                return block;
+            }
+            stats_.heap_allocations++;
+            return ::operator new((index + 1) * SIZE_CLASS_STEP);
+        }
+
+        auto deallocate(void *ptr, std::size_t size) noexcept -> void {
+            stats_.deallocations++;
+            auto index = size_class(size);
+            if (index >= NUM_SIZE_CLASSES
+                || free_lists_[index].count_ >= MAX_CACHED_PER_CLASS) {
+                ::operator delete(ptr);
+                return;
+            }
+
+            auto &list = free_lists_[index];
+            auto  block = static_cast<Block *>(ptr);
+            block->next_ = list.head_;
+            list.head_ = block;
+            list.count_++;
+        }
+
+        [[nodiscard]]
+        auto stats() const noexcept -> const FramePoolStats & {
+            return stats_;
+        }
+
+        [[nodiscard]]
+        static auto local() noexcept -> FramePool & {
+            thread_local FramePool pool;
+            return pool;
+        }
+
+    private:
+        [[nodiscard]]
+        constexpr static auto size_class(std::size_t size) noexcept
+            -> std::size_t {
+            return size == 0 ? 0 : (size - 1) / SIZE_CLASS_STEP;
+        }
+
+    private:
+        std::array<FreeList, NUM_SIZE_CLASSES> free_lists_{};
+        FramePoolStats                         stats_{};
+    };
+} // namespace detail
+
+// Coroutine frame allocation counters of the calling thread
+[[nodiscard]]
+static inline auto frame_pool_stats() noexcept -> FramePoolStats {
+    return uvio::detail::FramePool::local().stats();
+}
+
+} // namespace uvio
@@ -0,0 +1,217 @@
+#pragma once
+
+#include "uvio/common/result.hpp"
+#include "uvio/coroutine/task.hpp"
+#include "uvio/log.hpp"
+#include "uvio/macros.hpp"
+
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace uvio {
+
+namespace detail {
+
+    struct JoinStateBase {
+        bool                    finished_{false};
+        bool                    aborted_{false};
+        std::coroutine_handle<> joiner_{nullptr};
+        // Cancels the spawned task on `abort()`
+        CancellationSource source_{};
+        // Escaped the task, rethrown to the joiner
+        std::exception_ptr exception_{};
+
+        JoinStateBase() = default;
+
+        // No copy, no move (shared by the handle and the task)
+        JoinStateBase(const JoinStateBase &) = delete;
+        auto operator=(const JoinStateBase &) = delete;
+        JoinStateBase(JoinStateBase &&) = delete;
+        auto operator=(JoinStateBase &&) = delete;
+
+        // Nobody joined the task, e.g. it was detached, so the exception
+        // would be lost without a trace
+        ~JoinStateBase() {
+            if (!exception_) [[likely]] {
+                return;
+            }
+            try {
+                std::rethrow_exception(exception_);
+            } catch (const std::exception &e) {
+                uvio::log::console.error(
+                    "Exception escaped a detached task: {}",
+                    e.what());
+            } catch (...) {
+                uvio::log::console.error("Exception escaped a detached task");
+            }
+        }
+    };
+
+    template <typename T>
+    struct JoinState : JoinStateBase {
+        std::optional<T> value_{std::nullopt};
+
+        auto set_value(T &&value) {
+            value_.emplace(std::move(value));
+        }
+
+        [[nodiscard]]
+        auto has_value() const noexcept -> bool {
+            return value_.has_value();
+        }
+
+        auto take_value() -> Result<T> {
+            return std::move(value_).value();
+        }
+    };
+
+    template <>
+    struct JoinState<void> : JoinStateBase {
+        bool has_value_{false};
+
+        auto set_value() {
+            has_value_ = true;
+        }
+
+        [[nodiscard]]
+        auto has_value() const noexcept -> bool {
+            return has_value_;
+        }
+
+        auto take_value() -> Result<void> {
+            return {};
+        }
+    };
+
+    // Marks the join state finished when the spawned frame goes away, either
+    // because the task completed or because it was destroyed half-way
+    template <typename T>
+    struct JoinGuard {
+        std::shared_ptr<JoinState<T>> state_;
+
+        JoinGuard(std::shared_ptr<JoinState<T>> state)
+            : state_{std::move(state)} {}
+
+        // No copy
+        JoinGuard(const JoinGuard &) = delete;
+        auto operator=(const JoinGuard &) = delete;
+
+        ~JoinGuard() {
+            state_->finished_ = true;
+            if (auto joiner = state_->joiner_) {
+                state_->joiner_ = nullptr;
+                joiner.resume();
+            }
+        }
+    };
+
+    template <typename T>
+    auto run_and_join(Task<T> task, std::shared_ptr<JoinState<T>> state)
+        -> Task<> {
+        JoinGuard<T> guard{state};
+        try {
+            if constexpr (std::is_void_v<T>) {
+                co_await task;
+                state->set_value();
+            } else {
+                state->set_value(co_await task);
+            }
+        } catch (...) {
+            state->exception_ = std::current_exception();
+        }
+    }
+
+} // namespace detail
+
+// Result of a spawned task. Awaiting it yields the value returned by the task,
+// or `Error::TaskAborted` when the task was aborted or destroyed before
+// completing, or rethrows an exception that escaped the task. Cancelling the
+// awaiting coroutine yields `Error::Cancelled` and leaves the task running.
+// Dropping the handle detaches the task. A handle must be awaited on the loop
+// the task was spawned on.
+template <typename T = void>
+class JoinHandle {
+public:
+    JoinHandle(std::shared_ptr<detail::JoinState<T>> state)
+        : state_{std::move(state)} {}
+
+public:
+    [[REMEMBER_CO_AWAIT]]
+    auto operator co_await() const noexcept {
+        struct JoinAwaiter {
+            detail::JoinState<T>    *state_;
+            std::coroutine_handle<>  handle_{nullptr};
+            bool                     cancelled_{false};
+            CancellationRegistration cancellation_{};
+
+            auto await_ready() const noexcept -> bool {
+                return state_->finished_;
+            }
+
+            template <typename Promise>
+            auto await_suspend(std::coroutine_handle<Promise> handle) -> bool {
+                if (!cancellation_.register_callback(
+                        detail::cancellation_token_of(handle),
+                        on_cancel,
+                        this)) {
+                    cancelled_ = true;
+                    return false;
+                }
+                handle_ = handle;
+                state_->joiner_ = handle;
+                return true;
+            }
+
+            auto await_resume() -> Result<T> {
+                cancellation_.reset();
+                if (cancelled_) {
+                    return unexpected{make_uvio_error(Error::Cancelled)};
+                }
+                if (state_->aborted_) {
+                    return unexpected{make_uvio_error(Error::TaskAborted)};
+                }
+                if (state_->exception_) [[unlikely]] {
+                    std::rethrow_exception(
+                        std::exchange(state_->exception_, nullptr));
+                }
+                if (!state_->has_value()) {
+                    return unexpected{make_uvio_error(Error::TaskAborted)};
+                }
+                return state_->take_value();
+            }
+
+            // Stops waiting, the task goes on detached
+            static auto on_cancel(void *data) -> void {
+                auto self = static_cast<JoinAwaiter *>(data);
+                self->state_->joiner_ = nullptr;
+                self->cancelled_ = true;
+                detail::schedule(self->handle_);
+            }
+        };
+        return JoinAwaiter{state_.get()};
+    }
+
+    [[nodiscard]]
+    auto is_finished() const noexcept -> bool {
+        return state_->finished_;
+    }
+
+    // Request cancellation of the task, awaiting the handle then yields
+    // `Error::TaskAborted`. Does nothing once the task has finished.
+    auto abort() -> void {
+        if (state_->finished_) {
+            return;
+        }
+        state_->aborted_ = true;
+        state_->source_.request_cancellation();
+    }
+
+private:
+    std::shared_ptr<detail::JoinState<T>> state_;
+};
+
+} // namespace uvio
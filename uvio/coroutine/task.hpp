@@ -1,10 +1,16 @@
 #pragma once
 
+#include "uvio/coroutine/cancellation.hpp"
+#include "uvio/coroutine/frame_pool.hpp"
 #include "uvio/debug.hpp"
+#include "uvio/macros.hpp"
+#include "uvio/runtime/ready_queue.hpp"
 
 #include <coroutine>
 #include <exception>
-#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
 
 namespace uvio {
 
@@ -41,31 +47,72 @@ namespace detail {
             return FinalAwaiter{};
         }
 
-        auto unhandled_exception() {
-            std::terminate();
+#if !defined(UVIO_DISABLE_FRAME_POOL)
+        // Coroutine frames are recycled through thread-local free lists, build
+        // with UVIO_DISABLE_FRAME_POOL to use the global allocator (e.g. when
+        // running under a sanitizer)
+        static auto operator new(std::size_t size) -> void * {
+            return FramePool::local().allocate(size);
+        }
+
+        static auto operator delete(void *ptr, std::size_t size) noexcept
+            -> void {
+            FramePool::local().deallocate(ptr, size);
         }
+#endif
 
     public:
         std::coroutine_handle<> caller_{nullptr};
+        // Inherited from the awaiting task unless set explicitly
+        CancellationToken token_{};
     };
 
+    // Cancellation token of the task suspended on an awaiter, coroutines that
+    // are not tasks are never cancelled
+    template <typename Promise>
+    auto cancellation_token_of(std::coroutine_handle<Promise> handle) noexcept
+        -> CancellationToken {
+        if constexpr (std::is_base_of_v<TaskPromiseBase, Promise>) {
+            return handle.promise().token_;
+        } else {
+            return {};
+        }
+    }
+
+    // The value is constructed in place by `co_return` and moved out once by
+    // the awaiter, an exception escaping the task is rethrown there. A task
+    // nobody awaits has nowhere to rethrow and terminates.
     template <typename T>
     class TaskPromise final : public TaskPromiseBase {
     public:
         inline auto get_return_object() noexcept -> Task<T>;
 
-        template <typename F>
-        auto return_value(F &&value) noexcept {
-            value_ = std::forward<F>(value);
+        template <typename F = T>
+            requires std::is_constructible_v<T, F &&>
+        auto return_value(F &&value) {
+            value_.template emplace<VALUE>(std::forward<F>(value));
         }
 
-        auto result() const noexcept {
-            ASSERT(value_.has_value());
-            return value_.value();
+        auto unhandled_exception() noexcept {
+            if (caller_ == nullptr) {
+                std::terminate();
+            }
+            value_.template emplace<EXCEPTION>(std::current_exception());
+        }
+
+        auto result() -> T {
+            if (value_.index() == EXCEPTION) [[unlikely]] {
+                std::rethrow_exception(std::get<EXCEPTION>(value_));
+            }
+            ASSERT(value_.index() == VALUE);
+            return std::move(std::get<VALUE>(value_));
         }
 
     private:
-        std::optional<T> value_{std::nullopt};
+        constexpr static std::size_t VALUE{1};
+        constexpr static std::size_t EXCEPTION{2};
+
+        std::variant<std::monostate, T, std::exception_ptr> value_{};
     };
 
     template <>
@@ -75,7 +122,21 @@ namespace detail {
 
         auto return_void() const noexcept {}
 
-        auto result() const noexcept {}
+        auto unhandled_exception() noexcept {
+            if (caller_ == nullptr) {
+                std::terminate();
+            }
+            exception_ = std::current_exception();
+        }
+
+        auto result() -> void {
+            if (exception_) [[unlikely]] {
+                std::rethrow_exception(std::exchange(exception_, nullptr));
+            }
+        }
+
+    private:
+        std::exception_ptr exception_{};
     };
 
 } // namespace detail
@@ -110,32 +171,52 @@ public:
     Task(const Task &) = delete;
     auto operator=(const Task &) = delete;
 
-public:
-    auto operator co_await() const & noexcept {
-        struct Awaitable {
-            std::coroutine_handle<promise_type> callee_;
+private:
+    // Not a local class of `operator co_await()`, which could not declare the
+    // member template `await_suspend()`
+    struct Awaitable {
+        std::coroutine_handle<promise_type> callee_;
 
-            Awaitable(std::coroutine_handle<promise_type> callee) noexcept
-                : callee_{callee} {}
+        Awaitable(std::coroutine_handle<promise_type> callee) noexcept
+            : callee_{callee} {}
 
-            auto await_ready() const noexcept -> bool {
-                return !callee_ || callee_.done();
-            }
+        auto await_ready() const noexcept -> bool {
+            return !callee_ || callee_.done();
+        }
 
-            auto await_suspend(std::coroutine_handle<> caller)
-                -> std::coroutine_handle<> {
-                callee_.promise().caller_ = caller;
-                return callee_;
+        template <typename Promise>
+        auto await_suspend(std::coroutine_handle<Promise> caller)
+            -> std::coroutine_handle<> {
+            callee_.promise().caller_ = caller;
+            if (!callee_.promise().token_.can_be_cancelled()) {
+                callee_.promise().token_
+                    = detail::cancellation_token_of(caller);
             }
-
-            auto await_resume() const noexcept {
-                ASSERT_MSG(callee_, "no callee");
-                return callee_.promise().result();
+            if (!detail::consume_budget()) [[unlikely]] {
+                // Out of budget, the callee starts from the ready queue
+                detail::schedule(callee_);
+                return std::noop_coroutine();
             }
-        };
+            return callee_;
+        }
+
+        // Moves the result out, a task is awaited once
+        auto await_resume() const {
+            ASSERT_MSG(callee_, "no callee");
+            return callee_.promise().result();
+        }
+    };
+
+public:
+    auto operator co_await() const & noexcept {
         return Awaitable{handle_};
     }
 
+    // Must be called before the task starts
+    auto set_cancellation_token(CancellationToken token) noexcept -> void {
+        handle_.promise().token_ = std::move(token);
+    }
+
     auto take() -> std::coroutine_handle<promise_type> {
         if (handle_ == nullptr) [[unlikely]] {
             std::terminate();
@@ -160,4 +241,38 @@ inline auto uvio::detail::TaskPromise<void>::get_return_object() noexcept
     return Task<void>{std::coroutine_handle<TaskPromise>::from_promise(*this)};
 }
 
+template <typename T>
+[[nodiscard]]
+auto with_cancellation(CancellationToken token, Task<T> task) -> Task<T> {
+    task.set_cancellation_token(std::move(token));
+    return task;
+}
+
+namespace detail {
+    struct GetTokenAwaiter {
+        CancellationToken token_;
+
+        auto await_ready() const noexcept -> bool {
+            return false;
+        }
+
+        template <typename Promise>
+        auto await_suspend(std::coroutine_handle<Promise> handle) noexcept
+            -> bool {
+            token_ = cancellation_token_of(handle);
+            return false;
+        }
+
+        auto await_resume() noexcept -> CancellationToken {
+            return std::move(token_);
+        }
+    };
+} // namespace detail
+
+// Token of the calling task: `auto token = co_await get_cancellation_token();`
+[[REMEMBER_CO_AWAIT]]
+static inline auto get_cancellation_token() noexcept {
+    return detail::GetTokenAwaiter{};
+}
+
 } // namespace uvio
@@ -0,0 +1,266 @@
+#pragma once
+
+#include "uvio/coroutine/cancellation.hpp"
+#include "uvio/coroutine/task.hpp"
+#include "uvio/debug.hpp"
+#include "uvio/macros.hpp"
+#include "uvio/runtime/ready_queue.hpp"
+
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace uvio {
+
+namespace detail {
+
+    // Shared by a group and its children, which may outlive it
+    class TaskGroupState {
+    public:
+        TaskGroupState(std::size_t              max_concurrency,
+                       const CancellationToken &parent)
+            : max_concurrency_{max_concurrency}
+            , source_{parent} {}
+
+        // No copy, no move (the children point to this object)
+        TaskGroupState(const TaskGroupState &) = delete;
+        auto operator=(const TaskGroupState &) = delete;
+        TaskGroupState(TaskGroupState &&) = delete;
+        auto operator=(TaskGroupState &&) = delete;
+
+    public:
+        // Reserve a slot for a child, unless the group is full or somebody
+        // is already waiting for one
+        [[nodiscard]]
+        auto try_reserve() noexcept -> bool {
+            if (active_ < max_concurrency_ && spawners_.empty()) {
+                active_++;
+                return true;
+            }
+            return false;
+        }
+
+        // Resumed with a slot reserved once a child finishes
+        auto wait_for_slot(std::coroutine_handle<> handle) -> void {
+            spawners_.push_back(handle);
+        }
+
+        auto wait_for_children(std::coroutine_handle<> handle) -> void {
+            joiners_.push_back(handle);
+        }
+
+        // The slot of a finished child goes to the first waiting spawner
+        auto finish() -> void {
+            if (!spawners_.empty()) {
+                auto spawner = spawners_.front();
+                spawners_.pop_front();
+                schedule(spawner);
+                return;
+            }
+            if (--active_ == 0) {
+                for (auto joiner : std::exchange(joiners_, {})) {
+                    schedule(joiner);
+                }
+            }
+        }
+
+        // The first exception cancels the other children
+        auto fail(std::exception_ptr exception) -> void {
+            if (!exception_) {
+                exception_ = std::move(exception);
+                source_.request_cancellation();
+            }
+        }
+
+        auto take_exception() noexcept -> std::exception_ptr {
+            return std::exchange(exception_, nullptr);
+        }
+
+        [[nodiscard]]
+        auto active() const noexcept -> std::size_t {
+            return active_;
+        }
+
+        [[nodiscard]]
+        auto waiting() const noexcept -> std::size_t {
+            return spawners_.size();
+        }
+
+        [[nodiscard]]
+        auto source() noexcept -> LinkedCancellationSource & {
+            return source_;
+        }
+
+    private:
+        std::size_t                          max_concurrency_;
+        std::size_t                          active_{0};
+        std::deque<std::coroutine_handle<>>  spawners_;
+        std::vector<std::coroutine_handle<>> joiners_;
+        std::exception_ptr                   exception_{};
+        LinkedCancellationSource             source_;
+    };
+
+    // Gives the slot back when the child frame goes away, either because the
+    // task completed or because it was destroyed half-way
+    struct TaskGroupGuard {
+        std::shared_ptr<TaskGroupState> state_;
+
+        TaskGroupGuard(std::shared_ptr<TaskGroupState> state)
+            : state_{std::move(state)} {}
+
+        // No copy
+        TaskGroupGuard(const TaskGroupGuard &) = delete;
+        auto operator=(const TaskGroupGuard &) = delete;
+
+        ~TaskGroupGuard() {
+            state_->finish();
+        }
+    };
+
+    inline auto run_in_group(Task<> task, std::shared_ptr<TaskGroupState> state)
+        -> Task<> {
+        TaskGroupGuard guard{state};
+        try {
+            co_await task;
+        } catch (...) {
+            state->fail(std::current_exception());
+        }
+    }
+
+    // Runs the child in a reserved slot until its first suspension point
+    inline auto start_in_group(Task<>                          &&task,
+                               std::shared_ptr<TaskGroupState> state) {
+        auto token = state->source().token();
+        auto child = run_in_group(std::move(task), std::move(state));
+        child.set_cancellation_token(std::move(token));
+        child.take().resume();
+    }
+
+} // namespace detail
+
+// Tasks spawned on the current loop and awaited together, at most
+// `max_concurrency` of them running at a time, e.g. the connections of an
+// accept loop:
+//
+//     TaskGroup connections{1024};
+//     while (auto stream = co_await listener.accept()) {
+//         // Pauses accepting while 1024 connections are served
+//         co_await connections.spawn(serve(std::move(*stream)));
+//     }
+//     co_await connections.join();
+//
+// The first exception escaping a child cancels the others, and the children
+// spawned after it, and is rethrown by `join()`; long-lived groups such as
+// the one above should not let their children throw. Dropping the group
+// detaches the children still running. A group is used from a single loop.
+class TaskGroup {
+    struct SpawnAwaiter {
+        // See `IgnoresCancellation`
+        constexpr static bool IGNORES_CANCELLATION{true};
+
+        std::shared_ptr<uvio::detail::TaskGroupState> state_;
+        Task<>                                        task_;
+
+        auto await_ready() noexcept -> bool {
+            return state_->try_reserve();
+        }
+
+        auto await_suspend(std::coroutine_handle<> handle) -> void {
+            state_->wait_for_slot(handle);
+        }
+
+        // With a slot reserved either way
+        auto await_resume() -> void {
+            uvio::detail::start_in_group(std::move(task_), state_);
+        }
+    };
+
+    struct JoinAwaiter {
+        // Cancel the group instead, see `IgnoresCancellation`
+        constexpr static bool IGNORES_CANCELLATION{true};
+
+        uvio::detail::TaskGroupState *state_;
+
+        auto await_ready() const noexcept -> bool {
+            return state_->active() == 0;
+        }
+
+        auto await_suspend(std::coroutine_handle<> handle) -> void {
+            state_->wait_for_children(handle);
+        }
+
+        auto await_resume() -> void {
+            if (auto exception = state_->take_exception()) [[unlikely]] {
+                std::rethrow_exception(exception);
+            }
+        }
+    };
+
+public:
+    constexpr static std::size_t UNBOUNDED{
+        std::numeric_limits<std::size_t>::max()};
+
+    // Cancelling `parent` cancels every child
+    explicit TaskGroup(std::size_t              max_concurrency = UNBOUNDED,
+                       const CancellationToken &parent = {})
+        : state_{std::make_shared<uvio::detail::TaskGroupState>(
+              max_concurrency,
+              parent)} {
+        ASSERT(max_concurrency > 0);
+    }
+
+    // No copy
+    TaskGroup(const TaskGroup &) = delete;
+    auto operator=(const TaskGroup &) = delete;
+
+public:
+    // Start `task` once fewer than `max_concurrency` children run, waiting
+    // for a slot in FIFO order otherwise
+    [[REMEMBER_CO_AWAIT]]
+    auto spawn(Task<> &&task) {
+        return SpawnAwaiter{state_, std::move(task)};
+    }
+
+    // Start `task` if a slot is free, without waiting, e.g. to shed load
+    [[nodiscard]]
+    auto try_spawn(Task<> &&task) -> bool {
+        if (!state_->try_reserve()) {
+            return false;
+        }
+        uvio::detail::start_in_group(std::move(task), state_);
+        return true;
+    }
+
+    // Wait until every child has finished
+    [[REMEMBER_CO_AWAIT]]
+    auto join() noexcept {
+        return JoinAwaiter{state_.get()};
+    }
+
+    // Request cancellation of every child, running or spawned later
+    auto cancel() -> void {
+        state_->source().request_cancellation();
+    }
+
+    // Children running or holding a slot
+    [[nodiscard]]
+    auto active() const noexcept -> std::size_t {
+        return state_->active();
+    }
+
+    // Spawners waiting for a slot
+    [[nodiscard]]
+    auto waiting() const noexcept -> std::size_t {
+        return state_->waiting();
+    }
+
+private:
+    std::shared_ptr<uvio::detail::TaskGroupState> state_;
+};
+
+} // namespace uvio
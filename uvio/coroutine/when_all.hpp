@@ -0,0 +1,149 @@
+#pragma once
+
+#include "uvio/coroutine/task.hpp"
+#include "uvio/macros.hpp"
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace uvio {
+
+namespace detail {
+
+    // `void` results are reported as `std::monostate`
+    template <typename T>
+    using NonVoid = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+    // Resumes the awaiting coroutine once every child task has arrived, and
+    // rethrows there the first exception escaping a child
+    class WhenAllLatch {
+    public:
+        explicit WhenAllLatch(std::size_t count)
+            : count_{count} {}
+
+        // No copy, children point to this object
+        WhenAllLatch(const WhenAllLatch &) = delete;
+        auto operator=(const WhenAllLatch &) = delete;
+
+        auto arrive() -> void {
+            if (--count_ == 0 && waiter_) {
+                waiter_.resume();
+            }
+        }
+
+        auto fail(std::exception_ptr exception) noexcept -> void {
+            if (!exception_) {
+                exception_ = std::move(exception);
+            }
+        }
+
+        auto await_ready() const noexcept -> bool {
+            return count_ == 0;
+        }
+
+        auto await_suspend(std::coroutine_handle<> handle) noexcept {
+            waiter_ = handle;
+        }
+
+        auto await_resume() const {
+            if (exception_) [[unlikely]] {
+                std::rethrow_exception(exception_);
+            }
+        }
+
+    private:
+        std::size_t             count_;
+        std::coroutine_handle<> waiter_{nullptr};
+        std::exception_ptr      exception_{};
+    };
+
+    template <typename T>
+    auto when_all_item(Task<T>                    task,
+                       std::optional<NonVoid<T>> &slot,
+                       WhenAllLatch              &latch) -> Task<> {
+        try {
+            if constexpr (std::is_void_v<T>) {
+                co_await task;
+                slot.emplace();
+            } else {
+                slot.emplace(co_await task);
+            }
+        } catch (...) {
+            latch.fail(std::current_exception());
+        }
+        latch.arrive();
+    }
+
+    // Children are started eagerly and observe `token`
+    inline auto start_child(Task<> child, const CancellationToken &token) {
+        child.set_cancellation_token(token);
+        child.take().resume();
+    }
+
+    template <typename... Ts, std::size_t... Is>
+    auto start_when_all(std::tuple<std::optional<NonVoid<Ts>>...> &slots,
+                        WhenAllLatch                                &latch,
+                        const CancellationToken                     &token,
+                        std::index_sequence<Is...> /*unused*/,
+                        Task<Ts>... tasks) {
+        (start_child(
+             when_all_item(std::move(tasks), std::get<Is>(slots), latch),
+             token),
+         ...);
+    }
+
+} // namespace detail
+
+// Run all `tasks` concurrently on the current loop and collect their results
+// in order. The tasks share the cancellation token of the caller. The first
+// exception escaping a task is rethrown once all of them have finished.
+template <typename... Ts>
+[[REMEMBER_CO_AWAIT]]
+auto when_all(Task<Ts>... tasks) -> Task<std::tuple<detail::NonVoid<Ts>...>> {
+    std::tuple<std::optional<detail::NonVoid<Ts>>...> slots;
+    detail::WhenAllLatch                              latch{sizeof...(Ts)};
+
+    detail::start_when_all(slots,
+                           latch,
+                           co_await get_cancellation_token(),
+                           std::index_sequence_for<Ts...>{},
+                           std::move(tasks)...);
+    co_await latch;
+
+    co_return std::apply(
+        [](auto &...slot) {
+            return std::tuple<detail::NonVoid<Ts>...>{std::move(*slot)...};
+        },
+        slots);
+}
+
+template <typename T>
+[[REMEMBER_CO_AWAIT]]
+auto when_all(std::vector<Task<T>> tasks)
+    -> Task<std::vector<detail::NonVoid<T>>> {
+    std::vector<std::optional<detail::NonVoid<T>>> slots(tasks.size());
+    detail::WhenAllLatch                           latch{tasks.size()};
+
+    auto token = co_await get_cancellation_token();
+    for (std::size_t i = 0; i < tasks.size(); i++) {
+        detail::start_child(
+            detail::when_all_item(std::move(tasks[i]), slots[i], latch),
+            token);
+    }
+    co_await latch;
+
+    std::vector<detail::NonVoid<T>> results;
+    results.reserve(slots.size());
+    for (auto &slot : slots) {
+        results.push_back(std::move(*slot));
+    }
+    co_return results;
+}
+
+} // namespace uvio
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "uvio/coroutine/task.hpp"
+#include "uvio/coroutine/when_all.hpp"
+#include "uvio/debug.hpp"
+#include "uvio/macros.hpp"
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace uvio {
+
+namespace detail {
+
+    // Lives in the frame of `when_any()`, which only returns once every child
+    // has finished
+    template <typename R>
+    class WhenAnyState {
+    public:
+        // Cancelling the caller cancels every child
+        WhenAnyState(std::size_t count, const CancellationToken &parent)
+            : running_{count}
+            , source_{parent} {}
+
+        // No copy, children point to this object
+        WhenAnyState(const WhenAnyState &) = delete;
+        auto operator=(const WhenAnyState &) = delete;
+
+    public:
+        [[nodiscard]]
+        auto token() const noexcept -> CancellationToken {
+            return source_.token();
+        }
+
+        // The first result wins and cancels the other children
+        template <typename... Args>
+        auto complete(Args &&...args) -> void {
+            if (result_.has_value() || exception_) {
+                return;
+            }
+            result_.emplace(std::forward<Args>(args)...);
+            source_.request_cancellation();
+        }
+
+        // So does the first exception, rethrown to the awaiter
+        auto fail(std::exception_ptr exception) -> void {
+            if (result_.has_value() || exception_) {
+                return;
+            }
+            exception_ = std::move(exception);
+            source_.request_cancellation();
+        }
+
+        auto arrive() -> void {
+            if (--running_ == 0) {
+                if (auto waiter = std::exchange(waiter_, nullptr)) {
+                    waiter.resume();
+                }
+            }
+        }
+
+        auto wait() noexcept {
+            struct WhenAnyAwaiter {
+                WhenAnyState *state_;
+
+                auto await_ready() const noexcept -> bool {
+                    return state_->running_ == 0;
+                }
+
+                auto await_suspend(std::coroutine_handle<> handle) noexcept {
+                    state_->waiter_ = handle;
+                }
+
+                auto await_resume() -> R {
+                    if (state_->exception_) [[unlikely]] {
+                        std::rethrow_exception(state_->exception_);
+                    }
+                    return std::move(*state_->result_);
+                }
+            };
+            return WhenAnyAwaiter{this};
+        }
+
+    private:
+        std::optional<R>         result_{std::nullopt};
+        std::exception_ptr       exception_{};
+        std::size_t              running_;
+        std::coroutine_handle<>  waiter_{nullptr};
+        LinkedCancellationSource source_;
+    };
+
+    template <std::size_t I, typename T, typename R>
+    auto when_any_item(Task<T> task, WhenAnyState<R> &state) -> Task<> {
+        try {
+            if constexpr (std::is_void_v<T>) {
+                co_await task;
+                state.complete(std::in_place_index<I>);
+            } else {
+                state.complete(std::in_place_index<I>, co_await task);
+            }
+        } catch (...) {
+            state.fail(std::current_exception());
+        }
+        state.arrive();
+    }
+
+    template <typename T, typename R>
+    auto when_any_item(std::size_t index, Task<T> task, WhenAnyState<R> &state)
+        -> Task<> {
+        try {
+            if constexpr (std::is_void_v<T>) {
+                co_await task;
+                state.complete(index, std::monostate{});
+            } else {
+                state.complete(index, co_await task);
+            }
+        } catch (...) {
+            state.fail(std::current_exception());
+        }
+        state.arrive();
+    }
+
+    template <typename R, typename... Ts, std::size_t... Is>
+    auto start_when_any(WhenAnyState<R> &state,
+                        std::index_sequence<Is...> /*unused*/,
+                        Task<Ts>... tasks) {
+        (start_child(when_any_item<Is>(std::move(tasks), state), state.token()),
+         ...);
+    }
+
+} // namespace detail
+
+// Run all `tasks` concurrently on the current loop and complete with the
+// result of the first one to finish; `index()` of the variant tells which.
+// The other tasks are cancelled through their token and awaited before
+// returning, so a task blocked on an awaiter that ignores cancellation (a
+// mutex or rwlock lock, a latch, a task group) delays the result. A task
+// finishing first with an exception makes `when_any()` rethrow it.
+template <typename... Ts>
+[[REMEMBER_CO_AWAIT]]
+auto when_any(Task<Ts>... tasks) -> Task<std::variant<detail::NonVoid<Ts>...>> {
+    static_assert(sizeof...(Ts) > 0, "when_any() needs at least one task");
+    using R = std::variant<detail::NonVoid<Ts>...>;
+
+    detail::WhenAnyState<R> state{sizeof...(Ts),
+                                  co_await get_cancellation_token()};
+    detail::start_when_any(state,
+                           std::index_sequence_for<Ts...>{},
+                           std::move(tasks)...);
+    co_return co_await state.wait();
+}
+
+// Range form, completes with the index of the winner and its result
+template <typename T>
+[[REMEMBER_CO_AWAIT]]
+auto when_any(std::vector<Task<T>> tasks)
+    -> Task<std::pair<std::size_t, detail::NonVoid<T>>> {
+    ASSERT_MSG(!tasks.empty(), "when_any() needs at least one task");
+    using R = std::pair<std::size_t, detail::NonVoid<T>>;
+
+    detail::WhenAnyState<R> state{tasks.size(),
+                                  co_await get_cancellation_token()};
+    for (std::size_t i = 0; i < tasks.size(); i++) {
+        detail::start_child(
+            detail::when_any_item(i, std::move(tasks[i]), state),
+            state.token());
+    }
+    co_return co_await state.wait();
+}
+
+} // namespace uvio
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "uvio/macros.hpp"
+#include "uvio/runtime/ready_queue.hpp"
+
+#include <coroutine>
+
+namespace uvio {
+
+namespace detail {
+    struct YieldAwaiter {
+        auto await_ready() const noexcept -> bool {
+            return false;
+        }
+
+        // Back of the ready queue, behind everything already runnable
+        auto await_suspend(std::coroutine_handle<> handle) const -> bool {
+            if (current_context == nullptr
+                || current_context->ready_ == nullptr) [[unlikely]] {
+                return false;
+            }
+            current_context->ready_->push(handle);
+            return true;
+        }
+
+        auto await_resume() const noexcept {}
+    };
+} // namespace detail
+
+// Let the other coroutines of the loop run: `co_await yield();`. Tasks also
+// yield on their own after `detail::TASK_BUDGET` awaits that did not suspend.
+[[REMEMBER_CO_AWAIT]]
+static inline auto yield() noexcept {
+    return detail::YieldAwaiter{};
+}
+
+} // namespace uvio
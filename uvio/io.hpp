@@ -1,6 +1,7 @@
 #pragma once
 
 #include "uvio/io/buffer.hpp"
+#include "uvio/io/bytes.hpp"
 #include "uvio/io/reader.hpp"
 #include "uvio/io/stream.hpp"
 #include "uvio/io/writer.hpp"
@@ -1,37 +1,109 @@
 #pragma once
 
+#include "uvio/common/find.hpp"
 #include "uvio/common/string_utils.hpp"
 #include "uvio/debug.hpp"
+#include "uvio/io/mirrored_memory.hpp"
 
 #include <algorithm>
+#include <bit>
 #include <cstddef>
+#include <limits>
+#include <memory>
 #include <span>
+#include <string>
 #include <string_view>
+#include <utility>
 
 #include <cassert>
 
 namespace uvio::io::detail {
+/// A power-of-two ring over a mirrored mapping (see MirroredMemory), with
+/// monotonic positions: the readable and the writable bytes are both one
+/// contiguous span wherever they wrap, so consumed bytes are reused without
+/// ever moving the unread ones.
+///
 ///             r_begin      r_end/w_begin      w_end
-/// +-------------+---------------+---------------+
-/// |             |     r_slice   |    w_slice    |
-/// +-------------+---------------+---------------+
-/// 0    <=     r_pos_   <=     w_pos_    <=     size
+/// +-------------+---------------+---------------+ - - - - - - - +
+/// |             |     r_slice   |    w_slice    |    (mirror)   |
+/// +-------------+---------------+---------------+ - - - - - - - +
+/// 0    r_pos_ & mask_    w_pos_ & mask_               capacity * 2
 ///               |<-r_remaining->|<-w_remaining->|
+///                               (r_remaining + w_remaining == capacity)
+///
+/// Where mirrors are unavailable (not Linux, out of mappings, or built with
+/// UVIO_DISABLE_MIRRORED_BUFFER) it falls back to a flat buffer of exactly
+/// the requested size, which `reset_data()` compacts by copying.
 
 class StreamBuffer {
 public:
-    StreamBuffer(std::size_t size = DEFAULT_BUF_SIZE)
-        : buf_(size) {}
+    // Without storage, until a sized buffer is moved in
+    StreamBuffer() noexcept = default;
 
+    explicit StreamBuffer(std::size_t size) {
+        if constexpr (MirroredMemory::enabled()) {
+            auto capacity
+                = std::bit_ceil((std::max)(size, MirroredMemory::page_size()));
+            if (auto data = MirroredMemory::local().allocate(capacity)) {
+                data_ = data;
+                capacity_ = capacity;
+                mask_ = capacity - 1;
+                mirrored_ = true;
+                return;
+            }
+        }
+        data_ = new char[size];
+        capacity_ = size;
+    }
+
+    // A flat buffer even where mirrors are available
+    [[nodiscard]]
+    static auto flat(std::size_t size) -> StreamBuffer {
+        StreamBuffer buffer;
+        buffer.data_ = new char[size];
+        buffer.capacity_ = size;
+        return buffer;
+    }
+
+    StreamBuffer(StreamBuffer &&other) noexcept
+        : data_{std::exchange(other.data_, nullptr)}
+        , capacity_{std::exchange(other.capacity_, 0)}
+        , mask_{std::exchange(other.mask_, LINEAR)}
+        , mirrored_{std::exchange(other.mirrored_, false)}
+        , r_pos_{std::exchange(other.r_pos_, 0)}
+        , w_pos_{std::exchange(other.w_pos_, 0)} {}
+
+    auto operator=(StreamBuffer &&other) noexcept -> StreamBuffer & {
+        if (std::addressof(other) != this) [[likely]] {
+            release();
+            data_ = std::exchange(other.data_, nullptr);
+            capacity_ = std::exchange(other.capacity_, 0);
+            mask_ = std::exchange(other.mask_, LINEAR);
+            mirrored_ = std::exchange(other.mirrored_, false);
+            r_pos_ = std::exchange(other.r_pos_, 0);
+            w_pos_ = std::exchange(other.w_pos_, 0);
+        }
+        return *this;
+    }
+
+    ~StreamBuffer() {
+        release();
+    }
+
+    // No copy
+    StreamBuffer(const StreamBuffer &) = delete;
+    auto operator=(const StreamBuffer &) = delete;
+
+public:
     auto r_remaining() const noexcept -> int {
-        return w_pos_ - r_pos_;
+        return static_cast<int>(w_pos_ - r_pos_);
     }
 
-    auto r_begin() const noexcept -> std::vector<char>::const_iterator {
-        return buf_.begin() + r_pos_;
+    auto r_begin() const noexcept -> const char * {
+        return data_ + (r_pos_ & mask_);
     }
 
-    auto r_end() const noexcept -> std::vector<char>::const_iterator {
+    auto r_end() const noexcept -> const char * {
         return r_begin() + r_remaining();
     }
 
@@ -40,14 +112,17 @@ public:
     }
 
     auto w_remaining() const noexcept -> int {
-        return static_cast<int>(buf_.size()) - w_pos_;
+        if (mirrored_) {
+            return static_cast<int>(capacity_ - (w_pos_ - r_pos_));
+        }
+        return static_cast<int>(capacity_ - w_pos_);
     }
 
-    auto w_begin() noexcept -> std::vector<char>::iterator {
-        return buf_.begin() + w_pos_;
+    auto w_begin() noexcept -> char * {
+        return data_ + (w_pos_ & mask_);
     }
 
-    auto w_end() noexcept -> std::vector<char>::iterator {
+    auto w_end() noexcept -> char * {
         return w_begin() + w_remaining();
     }
 
@@ -60,7 +135,12 @@ public:
     }
 
     auto capacity() const noexcept -> std::size_t {
-        return buf_.size();
+        return capacity_;
+    }
+
+    // Whether consumed bytes are reused in place (see MirroredMemory)
+    auto mirrored() const noexcept -> bool {
+        return mirrored_;
     }
 
     auto write_to(std::span<char> dst) noexcept -> std::size_t {
@@ -82,13 +162,32 @@ public:
         return len;
     }
 
+    // Offset of `flag` in the unread bytes, looking no earlier than `from`
+    // (e.g. where the previous search could stop)
+    auto find(std::string_view flag, std::size_t from = 0) const noexcept
+        -> std::size_t {
+        auto readable = std::string_view{r_slice().data(), r_slice().size()};
+        if (from > readable.size()) {
+            return std::string_view::npos;
+        }
+        auto pos = uvio::detail::find_flag(readable.substr(from), flag);
+        return pos == std::string_view::npos ? pos : pos + from;
+    }
+
+    // Copy out and consume `n` unread bytes
+    auto append_to(std::string &dst, std::size_t n) -> void {
+        assert(n <= static_cast<std::size_t>(r_remaining()));
+        dst.append(r_begin(), n);
+        r_increase(n);
+    }
+
     auto find_flag_and_return_slice(std::string_view end_str) const noexcept
         -> std::span<const char> {
-        LOG_DEBUG(
-            "r_slice(): `{}` ({} bytes)",
-            make_visible(std::string_view{r_slice().data(), r_slice().size()}),
-            r_slice().size_bytes());
-        auto pos = std::string_view{r_slice().data()}.find(end_str);
+        auto readable = std::string_view{r_slice().data(), r_slice().size()};
+        LOG_DEBUG("r_slice(): `{}` ({} bytes)",
+                  make_visible(readable),
+                  readable.size());
+        auto pos = uvio::detail::find_flag(readable, end_str);
         if (pos == std::string_view::npos) {
             LOG_DEBUG("not found: `{}` ({} bytes)",
                       make_visible(end_str),
@@ -101,7 +200,8 @@ public:
 
     auto find_flag_and_return_slice(char end_char) const noexcept
         -> std::span<const char> {
-        auto pos = std::string_view{r_slice().data()}.find(end_char);
+        auto readable = std::string_view{r_slice().data(), r_slice().size()};
+        auto pos = uvio::detail::find_char(readable, end_char);
         if (pos == std::string_view::npos) {
             return {};
         } else {
@@ -120,20 +220,26 @@ public:
         r_pos_ = w_pos_ = 0;
     }
 
+    // Make the whole free space writable. A ring only has to keep its
+    // positions small, a flat buffer moves the unread bytes to the front
     void reset_data() noexcept {
-        auto len = r_remaining();
-        std::copy(r_begin(), r_end(), buf_.begin());
-        r_pos_ = 0;
-        w_pos_ = len;
+        auto len = static_cast<std::size_t>(r_remaining());
+        if (mirrored_) {
+            r_pos_ &= mask_;
+        } else {
+            std::copy(r_begin(), r_end(), data_);
+            r_pos_ = 0;
+        }
+        w_pos_ = r_pos_ + len;
     }
 
     auto r_increase(std::size_t n) noexcept -> void {
-        r_pos_ += static_cast<int>(n);
+        r_pos_ += n;
         assert(r_pos_ <= w_pos_);
     }
 
     auto w_increase(std::size_t n) noexcept -> void {
-        w_pos_ += static_cast<int>(n);
+        w_pos_ += n;
         assert(r_pos_ <= w_pos_);
     }
 
@@ -142,10 +248,29 @@ public:
         static_cast<std::size_t>(8 * 1024)};
 
 private:
+    auto release() noexcept -> void {
+        if (data_ == nullptr) {
+            return;
+        }
+        if (mirrored_) {
+            MirroredMemory::local().deallocate(data_, capacity_);
+        } else {
+            delete[] data_;
+        }
+    }
+
+private:
+    // Positions index a flat buffer as they are
+    constexpr static std::size_t LINEAR{
+        std::numeric_limits<std::size_t>::max()};
+
 private:
-    std::vector<char> buf_;
-    int               r_pos_{0};
-    int               w_pos_{0};
+    char       *data_{nullptr};
+    std::size_t capacity_{0};
+    std::size_t mask_{LINEAR};
+    bool        mirrored_{false};
+    std::size_t r_pos_{0};
+    std::size_t w_pos_{0};
 };
 
 } // namespace uvio::io::detail
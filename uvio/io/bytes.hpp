@@ -0,0 +1,556 @@
+#pragma once
+
+#include "uvio/common/find.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <new>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace uvio::io {
+
+namespace detail {
+
+    // Reference counted block of bytes, followed in memory by its data
+    struct Segment {
+        std::atomic<std::size_t> refs_;
+        std::size_t              capacity_;
+
+        [[nodiscard]]
+        auto data() noexcept -> char * {
+            return reinterpret_cast<char *>(this + 1);
+        }
+
+        auto retain() noexcept -> void {
+            refs_.fetch_add(1, std::memory_order::relaxed);
+        }
+
+        // Gives the segment back to the pool of the calling thread
+        auto release() noexcept -> void;
+
+        // Whether no Bytes shares the segment
+        [[nodiscard]]
+        auto unique() const noexcept -> bool {
+            return refs_.load(std::memory_order::acquire) == 1;
+        }
+    };
+
+    // Thread-local free lists of segments, one per power-of-two capacity
+    // from 1 KiB to 64 KiB. A segment released on another thread than the
+    // one that allocated it simply joins the free lists of the releasing
+    // thread.
+    class SegmentPool {
+    public:
+        constexpr static std::size_t MIN_CAPACITY{1024};
+        // Segments bigger than 64 KiB are not pooled
+        constexpr static std::size_t NUM_SIZE_CLASSES{7};
+        constexpr static std::size_t MAX_CACHED_PER_CLASS{256};
+
+    public:
+        SegmentPool() = default;
+
+        ~SegmentPool() {
+            for (auto &list : free_lists_) {
+                for (auto segment : list) {
+                    destroy(segment);
+                }
+            }
+        }
+
+        // No copy
+        SegmentPool(const SegmentPool &) = delete;
+        auto operator=(const SegmentPool &) = delete;
+
+    public:
+        // With a capacity of at least `capacity`, and one reference
+        [[nodiscard]]
+        auto allocate(std::size_t capacity) -> Segment * {
+            auto index = size_class(capacity);
+            if (index < NUM_SIZE_CLASSES) {
+                capacity = MIN_CAPACITY << index;
+                if (auto &list = free_lists_[index]; !list.empty()) {
+                    auto segment = list.back();
+                    list.pop_back();
+                    segment->refs_.store(1, std::memory_order::relaxed);
+                    return segment;
+                }
+            }
+            auto memory = ::operator new(sizeof(Segment) + capacity);
+            return new (memory) Segment{{1}, capacity};
+        }
+
+        auto deallocate(Segment *segment) noexcept -> void {
+            auto index = size_class(segment->capacity_);
+            if (index >= NUM_SIZE_CLASSES
+                || free_lists_[index].size() >= MAX_CACHED_PER_CLASS) {
+                destroy(segment);
+                return;
+            }
+            try {
+                free_lists_[index].push_back(segment);
+            } catch (...) {
+                destroy(segment);
+            }
+        }
+
+        [[nodiscard]]
+        static auto local() noexcept -> SegmentPool & {
+            thread_local SegmentPool pool;
+            return pool;
+        }
+
+    private:
+        [[nodiscard]]
+        constexpr static auto size_class(std::size_t capacity) noexcept
+            -> std::size_t {
+            if (capacity <= MIN_CAPACITY) {
+                return 0;
+            }
+            return std::bit_width(capacity - 1)
+                   - std::bit_width(MIN_CAPACITY - 1);
+        }
+
+        static auto destroy(Segment *segment) noexcept -> void {
+            segment->~Segment();
+            ::operator delete(segment);
+        }
+
+    private:
+        std::array<std::vector<Segment *>, NUM_SIZE_CLASSES> free_lists_{};
+    };
+
+    inline auto Segment::release() noexcept -> void {
+        if (refs_.fetch_sub(1, std::memory_order::acq_rel) == 1) {
+            SegmentPool::local().deallocate(this);
+        }
+    }
+
+} // namespace detail
+
+// Immutable bytes in a reference counted segment. Copies and `slice()`s
+// share the memory, which stays alive until the last of them goes away, so
+// a frame handed out by a reader outlives the read (and the reader).
+class Bytes {
+public:
+    Bytes() noexcept = default;
+
+    // Takes a reference on `segment`
+    Bytes(detail::Segment *segment, const char *data, std::size_t size) noexcept
+        : segment_{segment}
+        , data_{data}
+        , size_{size} {
+        segment_->retain();
+    }
+
+    Bytes(const Bytes &other) noexcept
+        : segment_{other.segment_}
+        , data_{other.data_}
+        , size_{other.size_} {
+        if (segment_ != nullptr) {
+            segment_->retain();
+        }
+    }
+
+    auto operator=(const Bytes &other) noexcept -> Bytes & {
+        if (std::addressof(other) != this) [[likely]] {
+            Bytes copy{other};
+            swap(copy);
+        }
+        return *this;
+    }
+
+    Bytes(Bytes &&other) noexcept
+        : segment_{std::exchange(other.segment_, nullptr)}
+        , data_{std::exchange(other.data_, nullptr)}
+        , size_{std::exchange(other.size_, 0)} {}
+
+    auto operator=(Bytes &&other) noexcept -> Bytes & {
+        if (std::addressof(other) != this) [[likely]] {
+            Bytes moved{std::move(other)};
+            swap(moved);
+        }
+        return *this;
+    }
+
+    ~Bytes() {
+        if (segment_ != nullptr) {
+            segment_->release();
+        }
+    }
+
+public:
+    // Copied into a segment of its own
+    [[nodiscard]]
+    static auto copy_from(std::span<const char> data) -> Bytes {
+        if (data.empty()) {
+            return {};
+        }
+        auto segment = detail::SegmentPool::local().allocate(data.size());
+        std::copy(data.begin(), data.end(), segment->data());
+        Bytes bytes{segment, segment->data(), data.size()};
+        segment->release();
+        return bytes;
+    }
+
+    // Shares the memory, e.g. to drop a frame header
+    [[nodiscard]]
+    auto slice(std::size_t offset,
+               std::size_t count = std::string_view::npos) const noexcept
+        -> Bytes {
+        assert(offset <= size_);
+        count = (std::min)(count, size_ - offset);
+        if (count == 0) {
+            return {};
+        }
+        return {segment_, data_ + offset, count};
+    }
+
+    [[nodiscard]]
+    auto data() const noexcept -> const char * {
+        return data_;
+    }
+
+    [[nodiscard]]
+    auto size() const noexcept -> std::size_t {
+        return size_;
+    }
+
+    [[nodiscard]]
+    auto empty() const noexcept -> bool {
+        return size_ == 0;
+    }
+
+    [[nodiscard]]
+    auto begin() const noexcept -> const char * {
+        return data_;
+    }
+
+    [[nodiscard]]
+    auto end() const noexcept -> const char * {
+        return data_ + size_;
+    }
+
+    [[nodiscard]]
+    auto as_span() const noexcept -> std::span<const char> {
+        return {data_, size_};
+    }
+
+    [[nodiscard]]
+    auto as_string_view() const noexcept -> std::string_view {
+        return {data_, size_};
+    }
+
+    auto swap(Bytes &other) noexcept -> void {
+        std::swap(segment_, other.segment_);
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+    }
+
+private:
+    detail::Segment *segment_{nullptr};
+    const char      *data_{nullptr};
+    std::size_t      size_{0};
+};
+
+// A growable buffer made of a chain of segments taken from a thread-local
+// pool. Bytes are written at the back through `w_slice()`/`w_increase()`,
+// which never runs out of room, and consumed at the front, either copied
+// out or split off as Bytes sharing the segments.
+//
+///   front segment          ...          back segment
+/// +------+-----------+     +-----+     +-----------+----------+
+/// |      | unread    | --> | ... | --> | unread    | w_slice  |
+/// +------+-----------+     +-----+     +-----------+----------+
+class BytesMut {
+    struct Chunk {
+        detail::Segment *segment_;
+        std::size_t      begin_;
+        std::size_t      end_;
+
+        [[nodiscard]]
+        auto readable() const noexcept -> std::span<const char> {
+            return {segment_->data() + begin_, end_ - begin_};
+        }
+    };
+
+public:
+    constexpr static std::size_t DEFAULT_SEGMENT_SIZE{4096};
+
+public:
+    // Nothing is allocated until the first write
+    explicit BytesMut(std::size_t segment_size = DEFAULT_SEGMENT_SIZE) noexcept
+        : segment_size_{segment_size} {}
+
+    BytesMut(BytesMut &&other) noexcept
+        : chunks_{std::move(other.chunks_)}
+        , segment_size_{other.segment_size_}
+        , size_{std::exchange(other.size_, 0)} {
+        other.chunks_.clear();
+    }
+
+    auto operator=(BytesMut &&other) noexcept -> BytesMut & {
+        if (std::addressof(other) != this) [[likely]] {
+            clear();
+            chunks_ = std::move(other.chunks_);
+            segment_size_ = other.segment_size_;
+            size_ = std::exchange(other.size_, 0);
+            other.chunks_.clear();
+        }
+        return *this;
+    }
+
+    ~BytesMut() {
+        clear();
+    }
+
+    // No copy
+    BytesMut(const BytesMut &) = delete;
+    auto operator=(const BytesMut &) = delete;
+
+public:
+    // Unread bytes
+    [[nodiscard]]
+    auto size() const noexcept -> std::size_t {
+        return size_;
+    }
+
+    [[nodiscard]]
+    auto r_remaining() const noexcept -> int {
+        return static_cast<int>(size_);
+    }
+
+    [[nodiscard]]
+    auto empty() const noexcept -> bool {
+        return size_ == 0;
+    }
+
+    // Size of the segments a read goes into
+    [[nodiscard]]
+    auto capacity() const noexcept -> std::size_t {
+        return segment_size_;
+    }
+
+    // Room left in the back segment
+    [[nodiscard]]
+    auto w_remaining() const noexcept -> int {
+        if (chunks_.empty()) {
+            return 0;
+        }
+        auto &back = chunks_.back();
+        return static_cast<int>(back.segment_->capacity_ - back.end_);
+    }
+
+    // Room at the back, starting a new segment if the back one is full
+    [[nodiscard]]
+    auto w_slice() -> std::span<char> {
+        if (w_remaining() == 0) {
+            push_segment(segment_size_);
+        }
+        auto &back = chunks_.back();
+        return {back.segment_->data() + back.end_,
+                back.segment_->capacity_ - back.end_};
+    }
+
+    auto w_increase(std::size_t n) noexcept -> void {
+        assert(n <= static_cast<std::size_t>(w_remaining()));
+        chunks_.back().end_ += n;
+        size_ += n;
+    }
+
+    auto append(std::span<const char> src) -> void {
+        while (!src.empty()) {
+            auto dst = w_slice();
+            auto len = (std::min)(dst.size(), src.size());
+            std::copy_n(src.begin(), len, dst.begin());
+            w_increase(len);
+            src = src.subspan(len);
+        }
+    }
+
+    // Consume `n` unread bytes
+    auto r_increase(std::size_t n) noexcept -> void {
+        assert(n <= size_);
+        size_ -= n;
+        while (n > 0) {
+            auto &front = chunks_.front();
+            auto  len = (std::min)(n, front.end_ - front.begin_);
+            front.begin_ += len;
+            n -= len;
+            pop_consumed();
+        }
+    }
+
+    // Copy out and consume as many unread bytes as `dst` holds
+    auto write_to(std::span<char> dst) noexcept -> std::size_t {
+        auto len = (std::min)(size_, dst.size_bytes());
+        copy_out(dst.data(), len);
+        r_increase(len);
+        return len;
+    }
+
+    // Copy out and consume `n` unread bytes
+    auto append_to(std::string &dst, std::size_t n) -> void {
+        assert(n <= size_);
+        auto offset = dst.size();
+        dst.resize(offset + n);
+        copy_out(dst.data() + offset, n);
+        r_increase(n);
+    }
+
+    // Offset of `flag` in the unread bytes, across segments, looking no
+    // earlier than `from` (e.g. where the previous search could stop)
+    [[nodiscard]]
+    auto find(std::string_view flag, std::size_t from = 0) const
+        -> std::size_t {
+        if (flag.empty()) {
+            return from <= size_ ? from : std::string_view::npos;
+        }
+        // The end of the bytes searched so far, that a match may start in
+        std::string carry;
+        std::size_t offset = 0;
+        for (const auto &chunk : chunks_) {
+            auto readable = chunk.readable();
+            auto view = std::string_view{readable.data(), readable.size()};
+            if (offset + view.size() <= from) {
+                offset += view.size();
+                continue;
+            }
+            if (from > offset) {
+                view.remove_prefix(from - offset);
+                offset = from;
+            }
+            if (!carry.empty()) {
+                auto joined = carry;
+                joined.append(view.substr(0, flag.size() - 1));
+                if (auto pos = uvio::detail::find_flag(joined, flag);
+                    pos != std::string_view::npos) {
+                    return offset - carry.size() + pos;
+                }
+            }
+            if (auto pos = uvio::detail::find_flag(view, flag);
+                pos != std::string_view::npos) {
+                return offset + pos;
+            }
+            carry.append(view);
+            if (carry.size() >= flag.size()) {
+                carry.erase(0, carry.size() - (flag.size() - 1));
+            }
+            offset += view.size();
+        }
+        return std::string_view::npos;
+    }
+
+    // Split off the first `n` unread bytes. Shares the front segment when
+    // they all lie in it, copies them into a segment of their own otherwise
+    [[nodiscard]]
+    auto split_to(std::size_t n) -> Bytes {
+        assert(n <= size_);
+        if (n == 0) {
+            return {};
+        }
+        auto &front = chunks_.front();
+        if (front.end_ - front.begin_ >= n) {
+            Bytes bytes{front.segment_,
+                        front.segment_->data() + front.begin_,
+                        n};
+            r_increase(n);
+            return bytes;
+        }
+        auto segment = detail::SegmentPool::local().allocate(n);
+        copy_out(segment->data(), n);
+        r_increase(n);
+        Bytes bytes{segment, segment->data(), n};
+        segment->release();
+        return bytes;
+    }
+
+    // Make room for `n` more bytes right after the unread ones, in the same
+    // segment, so that splitting them all off copies nothing. The unread
+    // bytes are moved to a new segment when they do not fit with `n` more
+    // in theirs.
+    auto reserve(std::size_t n) -> void {
+        reset_data();
+        if (chunks_.size() == 1) {
+            auto &back = chunks_.back();
+            if (back.segment_->capacity_ - back.end_ >= n) {
+                return;
+            }
+        }
+        if (chunks_.size() > 1 || size_ > 0) {
+            auto size = size_;
+            auto segment = detail::SegmentPool::local().allocate(
+                (std::max)(size + n, segment_size_));
+            copy_out(segment->data(), size);
+            clear();
+            chunks_.push_back({segment, 0, size});
+            size_ = size;
+            return;
+        }
+        clear();
+        push_segment((std::max)(n, segment_size_));
+    }
+
+    // Start over at the front of the back segment once everything has been
+    // read, unless some Bytes still shares it
+    auto reset_data() noexcept -> void {
+        if (size_ == 0 && chunks_.size() == 1
+            && chunks_.front().segment_->unique()) {
+            chunks_.front().begin_ = chunks_.front().end_ = 0;
+        }
+    }
+
+    // Drop the unread bytes and give the segments back
+    auto clear() noexcept -> void {
+        for (auto &chunk : chunks_) {
+            chunk.segment_->release();
+        }
+        chunks_.clear();
+        size_ = 0;
+    }
+
+private:
+    auto push_segment(std::size_t capacity) -> void {
+        auto segment = detail::SegmentPool::local().allocate(capacity);
+        try {
+            chunks_.push_back({segment, 0, 0});
+        } catch (...) {
+            segment->release();
+            throw;
+        }
+    }
+
+    // Fully read segments go, but the back one, which is still written to
+    auto pop_consumed() noexcept -> void {
+        while (chunks_.size() > 1
+               && chunks_.front().begin_ == chunks_.front().end_) {
+            chunks_.front().segment_->release();
+            chunks_.pop_front();
+        }
+    }
+
+    auto copy_out(char *dst, std::size_t n) const noexcept -> void {
+        for (auto it = chunks_.begin(); n > 0; ++it) {
+            auto readable = it->readable();
+            auto len = (std::min)(n, readable.size());
+            dst = std::copy_n(readable.begin(), len, dst);
+            n -= len;
+        }
+    }
+
+private:
+    std::deque<Chunk> chunks_;
+    std::size_t       segment_size_;
+    std::size_t       size_{0};
+};
+
+} // namespace uvio::io
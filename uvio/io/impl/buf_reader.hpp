@@ -2,12 +2,31 @@
 
 #include "uvio/common/result.hpp"
 #include "uvio/coroutine/task.hpp"
+#include "uvio/io/bytes.hpp"
 #include "uvio/macros.hpp"
 
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <string_view>
+
 namespace uvio::io::detail {
 
+// Where to search again for `flag` once `searched` bytes did not contain it:
+// only a match starting in the last `flag.size() - 1` of them may complete
+static inline auto resume_search_at(std::size_t      searched,
+                                    std::string_view flag) noexcept
+    -> std::size_t {
+    return searched < flag.size() ? 0 : searched - (flag.size() - 1);
+}
+
 template <typename Derived>
 class ImplBufRead {
+public:
+    // No limit on the frames of `read_until()`/`read_bytes_until()`
+    constexpr static std::size_t UNLIMITED{
+        std::numeric_limits<std::size_t>::max()};
+
 public:
     [[REMEMBER_CO_AWAIT]]
     auto read(std::span<char> buf) noexcept -> Task<Result<std::size_t>> {
@@ -95,24 +114,45 @@ public:
         }
     }
 
+    // Appends everything up to and including `end_flag` to `buf`, fails with
+    // `Error::FrameTooLarge` once more than `max_size` bytes came without it
     [[REMEMBER_CO_AWAIT]]
-    auto read_until(std::string &buf, std::string_view end_flag) noexcept
+    auto read_until(std::string     &buf,
+                    std::string_view end_flag,
+                    std::size_t      max_size = UNLIMITED) noexcept
         -> Task<Result<std::size_t>> {
         Result<std::size_t> ret;
+        std::size_t         from = 0;
+        auto                initial_size = buf.size();
         while (true) {
-            if (auto slice
-                = static_cast<Derived *>(this)
-                      ->r_stream_.find_flag_and_return_slice(end_flag);
-                !slice.empty()) {
-                buf.append(slice.begin(), slice.end());
-                static_cast<Derived *>(this)->r_stream_.r_increase(
-                    slice.size_bytes());
+            auto buffered = static_cast<std::size_t>(
+                static_cast<Derived *>(this)->r_stream_.r_remaining());
+            if (auto pos = static_cast<Derived *>(this)->r_stream_.find(
+                    end_flag,
+                    from);
+                pos != std::string_view::npos) {
+                if (buf.size() - initial_size + pos + end_flag.size()
+                    > max_size) {
+                    co_return unexpected{
+                        make_uvio_error(Error::FrameTooLarge)};
+                }
+                static_cast<Derived *>(this)->r_stream_.append_to(
+                    buf,
+                    pos + end_flag.size());
                 break;
-            } else {
-                // auto readable
-                //     = static_cast<Derived *>(this)->r_stream_.r_slice();
-                // buf.append(readable.begin(), readable.end());
-                // static_cast<Derived *>(this)->r_stream_.reset_pos();
+            }
+            if (buf.size() - initial_size + buffered >= max_size) {
+                co_return unexpected{make_uvio_error(Error::FrameTooLarge)};
+            }
+            // Bytes already searched are not searched again after the read
+            from = resume_search_at(buffered, end_flag);
+
+            // A full buffer hands the searched bytes over to `buf` instead of
+            // stalling
+            if (static_cast<Derived *>(this)->r_stream_.w_remaining() == 0) {
+                static_cast<Derived *>(this)->r_stream_.append_to(buf, from);
+                static_cast<Derived *>(this)->r_stream_.reset_data();
+                from = 0;
             }
 
             ret = co_await static_cast<Derived *>(this)->io_.read(
@@ -120,18 +160,80 @@ public:
             if (!ret) {
                 co_return unexpected{ret.error()};
             }
-            // if (ret.value() == 0) {
-            //     break;
-            // }
             static_cast<Derived *>(this)->r_stream_.w_increase(ret.value());
         }
 
         co_return buf.size();
     }
 
+    // Exactly `n` bytes, without copying them out of the buffer: they are
+    // read into one segment and shared with the returned Bytes. Needs a
+    // BytesMut buffer (BufReader)
+    [[REMEMBER_CO_AWAIT]]
+    auto read_bytes(std::size_t n) noexcept -> Task<Result<Bytes>> {
+        if (static_cast<Derived *>(this)->r_stream_.size() < n) {
+            static_cast<Derived *>(this)->r_stream_.reserve(
+                n - static_cast<Derived *>(this)->r_stream_.size());
+        }
+        while (static_cast<Derived *>(this)->r_stream_.size() < n) {
+            auto ret = co_await static_cast<Derived *>(this)->io_.read(
+                static_cast<Derived *>(this)->r_stream_.w_slice());
+            if (!ret) {
+                co_return unexpected{ret.error()};
+            }
+            static_cast<Derived *>(this)->r_stream_.w_increase(ret.value());
+        }
+        co_return static_cast<Derived *>(this)->r_stream_.split_to(n);
+    }
+
+    // Everything up to and including `end_flag`, without copying it out of
+    // the buffer, which grows as long as the flag is not found, up to
+    // `max_size` bytes (`Error::FrameTooLarge`). Needs a BytesMut buffer
+    // (BufReader)
+    [[REMEMBER_CO_AWAIT]]
+    auto read_bytes_until(std::string_view end_flag,
+                          std::size_t      max_size = UNLIMITED) noexcept
+        -> Task<Result<Bytes>> {
+        std::size_t from = 0;
+        while (true) {
+            auto buffered = static_cast<std::size_t>(
+                static_cast<Derived *>(this)->r_stream_.r_remaining());
+            if (auto pos = static_cast<Derived *>(this)->r_stream_.find(
+                    end_flag,
+                    from);
+                pos != std::string_view::npos) {
+                if (pos + end_flag.size() > max_size) {
+                    co_return unexpected{
+                        make_uvio_error(Error::FrameTooLarge)};
+                }
+                co_return static_cast<Derived *>(this)->r_stream_.split_to(
+                    pos + end_flag.size());
+            }
+            if (buffered >= max_size) {
+                co_return unexpected{make_uvio_error(Error::FrameTooLarge)};
+            }
+            from = resume_search_at(buffered, end_flag);
+
+            // Doubles the room, keeping the frame in one segment
+            if (static_cast<Derived *>(this)->r_stream_.w_remaining() == 0) {
+                static_cast<Derived *>(this)->r_stream_.reserve((std::max)(
+                    static_cast<Derived *>(this)->r_stream_.size(),
+                    static_cast<Derived *>(this)->r_stream_.capacity()));
+            }
+
+            auto ret = co_await static_cast<Derived *>(this)->io_.read(
+                static_cast<Derived *>(this)->r_stream_.w_slice());
+            if (!ret) {
+                co_return unexpected{ret.error()};
+            }
+            static_cast<Derived *>(this)->r_stream_.w_increase(ret.value());
+        }
+    }
+
     [[REMEMBER_CO_AWAIT]]
-    auto read_line(std::string &buf) noexcept -> Task<Result<std::size_t>> {
-        return read_until(buf, "\n");
+    auto read_line(std::string &buf, std::size_t max_size = UNLIMITED) noexcept
+        -> Task<Result<std::size_t>> {
+        return read_until(buf, "\n", max_size);
     }
 };
 } // namespace uvio::io::detail
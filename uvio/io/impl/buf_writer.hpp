@@ -4,6 +4,9 @@
 #include "uvio/coroutine/task.hpp"
 #include "uvio/macros.hpp"
 
+#include <span>
+#include <vector>
+
 namespace uvio::io::detail {
 
 template <typename Derived>
@@ -19,8 +22,7 @@ public:
 
         Result<std::size_t> written_bytes{};
         if (static_cast<Derived *>(this)->w_stream_.r_remaining() > 0) {
-            auto ret = co_await static_cast<Derived *>(this)->io_.write(
-                static_cast<Derived *>(this)->w_stream_.r_slice());
+            auto ret = co_await write_buffered();
             if (!ret) {
                 co_return ret;
             }
@@ -47,11 +49,58 @@ public:
         co_return written_bytes;
     }
 
+    // What fits is buffered, otherwise the buffered bytes and `bufs` go out
+    // together in one vectored write where `io_` has one. Returns the bytes
+    // taken from `bufs`.
+    [[REMEMBER_CO_AWAIT]]
+    auto write_vectored(std::span<const std::span<const char>> bufs) noexcept
+        -> Task<Result<std::size_t>> {
+        auto &io = static_cast<Derived *>(this)->io_;
+        auto &w_stream = static_cast<Derived *>(this)->w_stream_;
+
+        std::size_t total = 0;
+        for (auto buf : bufs) {
+            total += buf.size();
+        }
+        if (static_cast<std::size_t>(w_stream.w_remaining()) >= total) {
+            for (auto buf : bufs) {
+                w_stream.read_from(buf);
+            }
+            co_return total;
+        }
+
+        if constexpr (requires { io.write_vectored(bufs); }) {
+            std::vector<std::span<const char>> slices;
+            slices.reserve(bufs.size() + 1);
+            if (w_stream.r_remaining() > 0) {
+                slices.push_back(w_stream.r_slice());
+            }
+            slices.insert(slices.end(), bufs.begin(), bufs.end());
+            if (auto ret = co_await io.write_vectored(slices); !ret) {
+                co_return ret;
+            }
+            w_stream.r_increase(w_stream.r_remaining());
+            w_stream.reset_data();
+        } else {
+            if (auto ret = co_await flush(); !ret) {
+                co_return unexpected{ret.error()};
+            }
+            for (auto buf : bufs) {
+                if (buf.empty()) {
+                    continue;
+                }
+                if (auto ret = co_await io.write(buf); !ret) {
+                    co_return ret;
+                }
+            }
+        }
+        co_return total;
+    }
+
     [[REMEMBER_CO_AWAIT]]
     auto flush() noexcept -> Task<Result<void>> {
         while (!static_cast<Derived *>(this)->w_stream_.r_slice().empty()) {
-            auto ret = co_await static_cast<Derived *>(this)->io_.write(
-                static_cast<Derived *>(this)->w_stream_.r_slice());
+            auto ret = co_await write_buffered();
             if (!ret) {
                 co_return unexpected{ret.error()};
             }
@@ -73,5 +122,18 @@ public:
         }
         co_return Result<void>{};
     }
+
+private:
+    // The buffer is left alone until the write completes, so it is lent to
+    // `io_` rather than copied, where `io_` can borrow
+    auto write_buffered() noexcept {
+        auto &io = static_cast<Derived *>(this)->io_;
+        auto  buffered = static_cast<Derived *>(this)->w_stream_.r_slice();
+        if constexpr (requires { io.write_borrowed(buffered); }) {
+            return io.write_borrowed(buffered);
+        } else {
+            return io.write(buffered);
+        }
+    }
 };
 } // namespace uvio::io::detail
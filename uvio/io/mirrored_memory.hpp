@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__) && !defined(UVIO_DISABLE_MIRRORED_BUFFER)
+#include <sys/mman.h>
+#include <unistd.h>
+#define UVIO_MIRRORED_BUFFER 1
+#endif
+
+namespace uvio::io::detail {
+
+// The same `size` bytes mapped twice back to back, so that a ring buffer
+// living in the first half can hand out any `size` bytes starting in it as
+// one contiguous span: `data[i]` and `data[i + size]` are the same byte.
+//
+// Each region costs two memory mappings (see `vm.max_map_count`) and a
+// capacity of at least one page. Released regions are kept in thread-local
+// lists, as new ones take a few system calls.
+class MirroredMemory {
+public:
+    // Regions kept per thread for reuse
+    constexpr static std::size_t MAX_CACHED{64};
+
+public:
+    MirroredMemory() = default;
+
+    ~MirroredMemory() {
+        for (auto [data, size] : cached_) {
+            unmap(data, size);
+        }
+    }
+
+    // No copy
+    MirroredMemory(const MirroredMemory &) = delete;
+    auto operator=(const MirroredMemory &) = delete;
+
+public:
+    // Whether mirrors are supported at all
+    [[nodiscard]]
+    constexpr static auto enabled() noexcept -> bool {
+#if defined(UVIO_MIRRORED_BUFFER)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    [[nodiscard]]
+    static auto page_size() noexcept -> std::size_t {
+#if defined(UVIO_MIRRORED_BUFFER)
+        static const auto size
+            = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        return size;
+#else
+        return 4096;
+#endif
+    }
+
+    // `size` must be a multiple of the page size. Returns nullptr when the
+    // mappings can not be created
+    [[nodiscard]]
+    auto allocate(std::size_t size) noexcept -> char * {
+        for (auto it = cached_.begin(); it != cached_.end(); ++it) {
+            if (it->second == size) {
+                auto data = it->first;
+                *it = cached_.back();
+                cached_.pop_back();
+                return data;
+            }
+        }
+        return map(size);
+    }
+
+    auto deallocate(char *data, std::size_t size) noexcept -> void {
+        if (cached_.size() >= MAX_CACHED) {
+            unmap(data, size);
+            return;
+        }
+        try {
+            cached_.emplace_back(data, size);
+        } catch (...) {
+            unmap(data, size);
+        }
+    }
+
+    [[nodiscard]]
+    static auto local() noexcept -> MirroredMemory & {
+        thread_local MirroredMemory memory;
+        return memory;
+    }
+
+private:
+    [[nodiscard]]
+    static auto map([[maybe_unused]] std::size_t size) noexcept -> char * {
+#if defined(UVIO_MIRRORED_BUFFER)
+        auto fd = ::memfd_create("uvio-stream-buffer", MFD_CLOEXEC);
+        if (fd < 0) {
+            return nullptr;
+        }
+        if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            ::close(fd);
+            return nullptr;
+        }
+
+        // Reserve both halves first, then map the file over each of them
+        auto base = ::mmap(nullptr,
+                           2 * size,
+                           PROT_NONE,
+                           MAP_PRIVATE | MAP_ANONYMOUS,
+                           -1,
+                           0);
+        if (base == MAP_FAILED) {
+            ::close(fd);
+            return nullptr;
+        }
+        auto data = static_cast<char *>(base);
+        auto first = ::mmap(data,
+                            size,
+                            PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_FIXED,
+                            fd,
+                            0);
+        auto second = ::mmap(data + size,
+                             size,
+                             PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_FIXED,
+                             fd,
+                             0);
+        // The mappings keep the file alive
+        ::close(fd);
+        if (first == MAP_FAILED || second == MAP_FAILED) {
+            ::munmap(base, 2 * size);
+            return nullptr;
+        }
+        return data;
+#else
+        return nullptr;
+#endif
+    }
+
+    static auto unmap([[maybe_unused]] char       *data,
+                      [[maybe_unused]] std::size_t size) noexcept -> void {
+#if defined(UVIO_MIRRORED_BUFFER)
+        ::munmap(data, 2 * size);
+#endif
+    }
+
+private:
+    std::vector<std::pair<char *, std::size_t>> cached_;
+};
+
+} // namespace uvio::io::detail
@@ -1,11 +1,14 @@
 #pragma once
 
-#include "uvio/io/buffer.hpp"
+#include "uvio/io/bytes.hpp"
 #include "uvio/io/impl/buf_reader.hpp"
 #include <memory>
 
 namespace uvio::io {
 
+// Reads into a chain of pooled segments (BytesMut) that grows on demand, so
+// that `read_bytes()`/`read_bytes_until()` hand out frames of any size as
+// Bytes sharing the segments. `size` is the size of the segments
 template <typename IO>
     requires requires(IO io, std::span<char> buf) {
         { io.read(buf) };
@@ -42,12 +45,12 @@ public:
     }
 
     auto into_inner() noexcept -> IO {
-        r_stream_.disable();
+        r_stream_.clear();
         return std::move(io_);
     }
 
 private:
-    IO                   io_;
-    detail::StreamBuffer r_stream_;
+    IO       io_;
+    BytesMut r_stream_;
 };
 } // namespace uvio::io
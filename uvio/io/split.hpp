@@ -4,6 +4,7 @@
 #include "uvio/common/result.hpp"
 #include <memory>
 #include <span>
+#include <utility>
 
 namespace uvio::io {
 
@@ -51,6 +52,23 @@ public:
         return stream_->write(buf);
     }
 
+    // Hands an owned buffer over to `IO`
+    template <typename Buffer>
+        requires requires(IO &io, Buffer &&buf) {
+            io.write(std::forward<Buffer>(buf));
+        }
+    auto write(Buffer &&buf) {
+        return stream_->write(std::forward<Buffer>(buf));
+    }
+
+    auto write_borrowed(std::span<const char> buf) noexcept {
+        return stream_->write_borrowed(buf);
+    }
+
+    auto write_vectored(std::span<const std::span<const char>> bufs) noexcept {
+        return stream_->write_vectored(bufs);
+    }
+
     auto reset() {
         this->stream_.reset();
     }
@@ -25,7 +25,7 @@ public:
     BufStream(BufStream &&other) noexcept
         : io_{std::move(other.io_)}
         , r_stream_{std::move(other.r_stream_)}
-        , w_stream_{std::move(other.w_stream)} {}
+        , w_stream_{std::move(other.w_stream_)} {}
 
     auto operator=(BufStream &&other) noexcept -> BufStream & {
         if (std::addressof(other) != this) [[likely]] {
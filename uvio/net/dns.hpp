@@ -1,8 +1,11 @@
 #pragma once
 
 #include "uvio/common/result.hpp"
+#include "uvio/coroutine/task.hpp"
 #include "uvio/debug.hpp"
 #include "uvio/macros.hpp"
+#include "uvio/runtime/ready_queue.hpp"
+#include "uvio/runtime/context.hpp"
 
 #include <coroutine>
 #include <string_view>
@@ -14,13 +17,15 @@ namespace uvio::net {
 class DNS {
 
     struct ResolveAwaiter {
-        std::coroutine_handle<> handle_;
-        uv_getaddrinfo_t        req_{};
-        std::string             address_;
-        std::string             service_;
-        struct addrinfo         hints_ {};
-        std::array<char, 17>    ipv4addr_{};
-        bool                    resolved_{false};
+        std::coroutine_handle<>  handle_;
+        uv_getaddrinfo_t         req_{};
+        std::string              address_;
+        std::string              service_;
+        struct addrinfo          hints_ {};
+        std::array<char, 17>     ipv4addr_{};
+        bool                     resolved_{false};
+        int                      status_{0};
+        CancellationRegistration cancellation_;
 
         ResolveAwaiter(std::string_view address, std::string_view service)
             : address_{address}
@@ -33,11 +38,14 @@ class DNS {
             req_.data = this;
 
             uv_getaddrinfo(
-                uv_default_loop(),
+                current_loop(),
                 &req_,
                 [](uv_getaddrinfo_t *req, int status, struct addrinfo *res) {
                     auto data = static_cast<ResolveAwaiter *>(req->data);
-                    if (status < 0) {
+                    data->status_ = status;
+                    if (status == UV_EAI_CANCELED) {
+                        LOG_DEBUG("uv_getaddrinfo cancelled");
+                    } else if (status < 0) {
                         LOG_ERROR("uv_getaddrinfo callback error {}",
                                   uv_err_name(status));
                     } else {
@@ -48,8 +56,9 @@ class DNS {
                         uv_freeaddrinfo(res);
                     }
                     data->resolved_ = true;
+                    data->cancellation_.reset();
                     if (data->handle_) {
-                        data->handle_.resume();
+                        uvio::detail::schedule(data->handle_);
                     }
                 },
                 address_.data(),
@@ -60,11 +69,22 @@ class DNS {
         auto await_ready() const -> bool {
             return resolved_;
         }
-        auto await_suspend(std::coroutine_handle<> handle) {
+        template <typename Promise>
+        auto await_suspend(std::coroutine_handle<Promise> handle) {
             handle_ = handle;
+            if (!cancellation_.register_callback(
+                    uvio::detail::cancellation_token_of(handle),
+                    on_cancel,
+                    this)) {
+                on_cancel(this);
+            }
         }
         [[nodiscard]]
-        auto await_resume() const -> Result<std::string> {
+        auto await_resume() -> Result<std::string> {
+            cancellation_.reset();
+            if (status_ == UV_EAI_CANCELED) {
+                return unexpected{make_uvio_error(Error::Cancelled)};
+            }
             auto ip_address
                 = std::string{ipv4addr_.data(), std::strlen(ipv4addr_.data())};
             if (!ip_address.empty()) {
@@ -72,6 +92,12 @@ class DNS {
             }
             return unexpected{make_uvio_error(Error::ResolveFailed)};
         }
+
+        // A lookup already running on the thread pool completes normally
+        static auto on_cancel(void *data) -> void {
+            auto self = static_cast<ResolveAwaiter *>(data);
+            uv_cancel(reinterpret_cast<uv_req_t *>(&self->req_));
+        }
     };
 
 public:
@@ -5,6 +5,8 @@
 #include "uvio/debug.hpp"
 #include "uvio/macros.hpp"
 #include "uvio/net/http/http_protocol.hpp"
+#include "uvio/runtime/context.hpp"
+#include "uvio/runtime/ready_queue.hpp"
 
 #include <coroutine>
 
@@ -33,7 +35,7 @@ public:
     static auto request(const HttpRequest &req) {
         struct RequestAwaiter {
             RequestAwaiter(const HttpRequest &req) noexcept {
-                uv_timer_init(uv_default_loop(), &context_.timer_);
+                uv_timer_init(current_loop(), &context_.timer_);
                 context_.timer_.data = this;
                 context_.multi_handle_ = curl_multi_init();
 
@@ -91,7 +93,7 @@ public:
                         curl_easy_cleanup(message->easy_handle);
 
                         if (context->handle_) {
-                            context->handle_.resume();
+                            uvio::detail::schedule(context->handle_);
                         }
                         break;
 
@@ -166,7 +168,7 @@ public:
                         data->context_.curl_sockfd = curl_sockfd;
 
                         uv_check(
-                            uv_poll_init_socket(uv_default_loop(),
+                            uv_poll_init_socket(current_loop(),
                                                 &data->context_.poll_handle,
                                                 curl_sockfd));
                         curl_multi_assign(data->context_.multi_handle_,
@@ -5,7 +5,10 @@
 #include "uvio/net/http/http_frame.hpp"
 #include "uvio/net/http/http_protocol.hpp"
 #include "uvio/net/tcp_listener.hpp"
+#include "uvio/time/timeout.hpp"
 
+#include <chrono>
+#include <exception>
 #include <regex>
 #include <unordered_map>
 
@@ -15,33 +18,102 @@ class HttpServer {
     using HandlerCoro
         = std::function<Task<>(const HttpRequest &req, HttpResponse &resp)>;
 
+    struct Route {
+        std::regex  pattern;
+        HandlerCoro handler;
+    };
+
 public:
     HttpServer(std::string_view host, int port)
         : host_{host}
         , port_{port} {}
 
 public:
+    // `uri` is a regular expression, compiled once here
     auto add_route(std::string_view uri, HandlerCoro &&coro) {
-        map_handles_[uri] = std::move(coro);
+        map_handles_[uri] = Route{
+            .pattern = std::regex{std::string{uri}},
+            .handler = std::move(coro),
+        };
     }
 
-    auto run() {
-        block_on([this]() -> Task<> {
-            auto listener = TcpListener();
-            listener.bind(this->host_, this->port_);
-            console.info("Listening on {}:{} ...", this->host_, this->port_);
-            while (true) {
-                auto stream = (co_await listener.accept()).value();
-                spawn(this->handle_http(std::move(stream)));
-            }
-        }());
+    // Connections idle for longer than `timeout` while reading the request,
+    // or not draining the response, are dropped. Zero disables the deadline.
+    auto set_read_timeout(std::chrono::milliseconds timeout) {
+        read_timeout_ = timeout;
+    }
+
+    auto set_write_timeout(std::chrono::milliseconds timeout) {
+        write_timeout_ = timeout;
+    }
+
+    // Whole time a client gets to send its request line and headers, however
+    // slowly the bytes trickle in (slowloris). Zero disables the deadline.
+    auto set_header_timeout(std::chrono::milliseconds timeout) {
+        header_timeout_ = timeout;
+    }
+
+    // Connections served at once by each worker, accepting pauses while the
+    // limit is reached
+    auto set_max_connections(std::size_t max_connections) {
+        max_connections_ = max_connections;
+    }
+
+    // Serve on `num_workers` loops, each one accepting on its own
+    // SO_REUSEPORT listener and sharing the same route table
+    auto run(std::size_t num_workers = 1) {
+        Runtime runtime{num_workers};
+        runtime.block_on_each([this, reuse_port = num_workers > 1]() {
+            return this->serve(reuse_port);
+        });
     }
 
 private:
+    auto serve(bool reuse_port) -> Task<> {
+        auto listener = TcpListener();
+        if (auto ret = listener.bind(this->host_,
+                                     this->port_,
+                                     {.reuse_port = reuse_port});
+            !ret) {
+            console.error("{}", ret.error().message());
+            co_return;
+        }
+        console.info("Listening on {}:{} ...", this->host_, this->port_);
+        TaskGroup connections{max_connections_};
+        while (true) {
+            auto stream = co_await listener.accept();
+            if (!stream) {
+                console.error("{}", stream.error().message());
+                break;
+            }
+            co_await connections.spawn(
+                this->serve_connection(std::move(stream.value())));
+        }
+        // Drain the connections still being served
+        co_await connections.join();
+    }
+
+    // Nothing may escape into the group, which would cancel every connection
+    // of the worker
+    auto serve_connection(TcpStream stream) -> Task<> {
+        try {
+            co_await this->handle_http(std::move(stream));
+        } catch (const std::exception &e) {
+            console.error("connection failed: {}", e.what());
+        } catch (...) {
+            console.error("connection failed: unknown exception");
+        }
+    }
+
     auto handle_http(TcpStream stream) -> Task<> {
+        stream.set_read_timeout(read_timeout_);
+        stream.set_write_timeout(write_timeout_);
         HttpFramed http_framed{std::move(stream)};
 
-        auto req = co_await http_framed.read_request();
+        auto req = header_timeout_.count() > 0
+                       ? co_await time::timeout(http_framed.read_request(),
+                                                header_timeout_)
+                       : co_await http_framed.read_request();
         if (!req) {
             console.info("client closed");
             co_return;
@@ -54,11 +126,21 @@ private:
         for (auto &route : map_handles_) {
             if (std::regex_match(request.uri,
                                  request.match_,
-                                 std::regex{std::string{route.first}})) {
-                auto handler = route.second;
-                co_await handler(request, resp);
-                resp.status_code = 200;
-                resp.status_text = "OK";
+                                 route.second.pattern)) {
+                auto handler = route.second.handler;
+                // A throwing handler fails its own request only, the client
+                // gets a 500
+                try {
+                    co_await handler(request, resp);
+                    resp.status_code = 200;
+                    resp.status_text = "OK";
+                } catch (const std::exception &e) {
+                    console.error("uri `{}`: {}", request.uri, e.what());
+                    resp = internal_server_error();
+                } catch (...) {
+                    console.error("uri `{}`: unknown exception", request.uri);
+                    resp = internal_server_error();
+                }
                 LOG_DEBUG("uri `{}` matched pattern `{}`",
                           request.uri,
                           route.first);
@@ -96,12 +178,25 @@ private:
         }
     }
 
-private:
-    std::string host_;
-    int         port_;
-    TcpStream   stream_{nullptr};
+    static auto internal_server_error() -> HttpResponse {
+        return HttpResponse{
+            .status_code = 500,
+            .status_text = "Internal Server Error",
+            .headers = {},
+            .body = "Internal Server Error",
+        };
+    }
 
-    std::unordered_map<std::string_view, HandlerCoro> map_handles_;
+private:
+    std::string               host_;
+    int                       port_;
+    TcpStream                 stream_{nullptr};
+    std::chrono::milliseconds read_timeout_{std::chrono::seconds{60}};
+    std::chrono::milliseconds write_timeout_{std::chrono::seconds{60}};
+    std::chrono::milliseconds header_timeout_{std::chrono::seconds{30}};
+    std::size_t               max_connections_{TaskGroup::UNBOUNDED};
+
+    std::unordered_map<std::string_view, Route> map_handles_;
 };
 
 } // namespace uvio::net::http
@@ -1,69 +1,148 @@
 #pragma once
 
 #include "uvio/common/result.hpp"
+#include "uvio/coroutine/task.hpp"
 #include "uvio/debug.hpp"
 #include "uvio/macros.hpp"
 #include "uvio/net/tcp_stream.hpp"
 #include "uvio/net/tcp_util.hpp"
+#include "uvio/runtime/context.hpp"
+#include "uvio/runtime/ready_queue.hpp"
 
 #include <coroutine>
 #include <memory>
 #include <string_view>
+#include <utility>
 
 #if defined(_WIN32)
 #include <winsock2.h>
 #else
 #include <netinet/in.h>
 #include <sys/socket.h>
+#include <unistd.h>
 #endif
 
 #include "uv.h"
 
 namespace uvio::net {
 
+struct ListenOptions {
+    int backlog{64};
+    // Open the socket with SO_REUSEPORT, so that every loop of a runtime can
+    // bind its own listener on the same address and the kernel spreads the
+    // incoming connections across them
+    bool reuse_port{false};
+};
+
 class TcpListener {
 
     struct AcceptAwaiter {
         std::coroutine_handle<>   handle_;
-        uv_tcp_t                 *server_;
+        TcpListener              *listener_;
         std::unique_ptr<uv_tcp_t> client_;
         bool                      ready_{false};
+        bool                      cancelled_{false};
         int                       status_{0};
+        CancellationRegistration  cancellation_;
 
-        AcceptAwaiter(uv_tcp_t *server)
-            : server_{server}
+        AcceptAwaiter(TcpListener *listener)
+            : listener_{listener}
             , client_{std::make_unique<uv_tcp_t>()} {
-            uv_tcp_init(uv_default_loop(), client_.get());
+            uv_tcp_init(current_loop(), client_.get());
+
+            // A connection may have arrived while nobody was accepting
+            if (listener_->pending_) {
+                listener_->pending_ = false;
+                status_ = listener_->pending_status_;
+                ready_ = true;
+            } else {
+                listener_->waiter_ = this;
+            }
+        }
 
-            server_->data = this;
+        ~AcceptAwaiter() {
+            if (listener_->waiter_ == this) {
+                listener_->waiter_ = nullptr;
+            }
+            if (client_) {
+                uv_close(reinterpret_cast<uv_handle_t *>(client_.release()),
+                         [](uv_handle_t *handle) {
+                             delete reinterpret_cast<uv_tcp_t *>(handle);
+                         });
+            }
         }
 
+        // No copy, no move (the listener points to this)
+        AcceptAwaiter(const AcceptAwaiter &) = delete;
+        auto operator=(const AcceptAwaiter &) = delete;
+        AcceptAwaiter(AcceptAwaiter &&) = delete;
+        auto operator=(AcceptAwaiter &&) = delete;
+
         auto await_ready() const -> bool {
-            return ready_;
+            return ready_ && uvio::detail::consume_budget();
         }
-        auto await_suspend(std::coroutine_handle<> handle) {
+        template <typename Promise>
+        auto await_suspend(std::coroutine_handle<Promise> handle) -> bool {
+            if (ready_) {
+                // A backlog of connections, but the budget is spent
+                uvio::detail::schedule(handle);
+                return true;
+            }
+            if (!cancellation_.register_callback(
+                    uvio::detail::cancellation_token_of(handle),
+                    on_cancel,
+                    this)) {
+                listener_->waiter_ = nullptr;
+                cancelled_ = true;
+                return false;
+            }
             handle_ = handle;
+            return true;
         }
         [[nodiscard]]
         auto await_resume() -> Result<TcpStream> {
-            uv_check(uv_accept(reinterpret_cast<uv_stream_t *>(server_),
-                               reinterpret_cast<uv_stream_t *>(client_.get())));
+            cancellation_.reset();
+            if (cancelled_) {
+                return unexpected{make_uvio_error(Error::Cancelled)};
+            }
+            // e.g. EMFILE, nothing to accept
+            if (status_ != 0) [[unlikely]] {
+                return unexpected{make_sys_error(-status_)};
+            }
+            uv_check(uv_accept(
+                reinterpret_cast<uv_stream_t *>(&listener_->listen_socket_),
+                reinterpret_cast<uv_stream_t *>(client_.get())));
+            uvio::net::detail::apply_busy_poll(client_.get());
 
             auto peer = PeerAddress(client_.get());
             LOG_DEBUG("{}:{} is connected", peer.ipv4(), peer.port());
             return TcpStream{std::move(client_)};
         }
+
+        static auto on_cancel(void *data) -> void {
+            auto self = static_cast<AcceptAwaiter *>(data);
+            self->listener_->waiter_ = nullptr;
+            self->cancelled_ = true;
+            uvio::detail::schedule(self->handle_);
+        }
     };
 
-    std::coroutine_handle<> handle_;
-    uv_tcp_t                listen_socket_{};
-    int                     backlog_{64};
+    uv_tcp_t       listen_socket_{};
+    AcceptAwaiter *waiter_{nullptr};
+    // libuv stops watching the socket until the pending connection is accepted
+    bool pending_{false};
+    int  pending_status_{0};
 
 public:
     TcpListener() {
-        uv_check(uv_tcp_init(uv_default_loop(), &listen_socket_));
+        uv_check(uv_tcp_init(current_loop(), &listen_socket_));
+        listen_socket_.data = this;
     }
 
+    // No copy, no move (the socket points to this)
+    TcpListener(const TcpListener &) = delete;
+    auto operator=(const TcpListener &) = delete;
+
     ~TcpListener() {
         if (!static_cast<bool>(uv_is_closing(
                 reinterpret_cast<uv_handle_t *>(&listen_socket_)))) {
@@ -75,31 +154,77 @@ public:
     }
 
 public:
-    auto bind(std::string_view addr, int port) -> Result<void> {
+    auto bind(std::string_view addr, int port, ListenOptions options = {})
+        -> Result<void> {
         struct sockaddr_in bind_addr {};
         uv_check(uv_ip4_addr(addr.data(), port, &bind_addr));
-        uv_check(uv_tcp_bind(&listen_socket_,
-                             reinterpret_cast<const sockaddr *>(&bind_addr),
-                             0));
-
-        uv_check(uv_listen(reinterpret_cast<uv_stream_t *>(&listen_socket_),
-                           backlog_,
-                           [](uv_stream_t *req, int status) {
-                               auto data
-                                   = static_cast<AcceptAwaiter *>(req->data);
-                               data->status_ = status;
-                               // assert(status == 0);
-                               data->ready_ = true;
-                               if (data->handle_) {
-                                   data->handle_.resume();
-                               }
-                           }));
+
+        if (options.reuse_port) {
+            if (auto ret = open_reuse_port_socket(); !ret) {
+                return ret;
+            }
+        }
+
+        if (auto ret = uv_tcp_bind(
+                &listen_socket_,
+                reinterpret_cast<const sockaddr *>(&bind_addr),
+                0);
+            ret != 0) {
+            LOG_ERROR("bind {}:{} failed: {}", addr, port, uv_strerror(ret));
+            return unexpected{make_sys_error(-ret)};
+        }
+
+        if (auto ret = uv_listen(
+                reinterpret_cast<uv_stream_t *>(&listen_socket_),
+                options.backlog,
+                [](uv_stream_t *req, int status) {
+                    auto listener = static_cast<TcpListener *>(req->data);
+                    auto data = std::exchange(listener->waiter_, nullptr);
+                    if (data == nullptr) {
+                        listener->pending_ = true;
+                        listener->pending_status_ = status;
+                        return;
+                    }
+                    data->status_ = status;
+                    data->ready_ = true;
+                    data->cancellation_.reset();
+                    if (data->handle_) {
+                        uvio::detail::schedule(data->handle_);
+                    }
+                });
+            ret != 0) {
+            LOG_ERROR("listen {}:{} failed: {}", addr, port, uv_strerror(ret));
+            return unexpected{make_sys_error(-ret)};
+        }
         return {};
     }
 
     [[REMEMBER_CO_AWAIT]]
     auto accept() noexcept {
-        return AcceptAwaiter{&listen_socket_};
+        return AcceptAwaiter{this};
+    }
+
+private:
+    auto open_reuse_port_socket() -> Result<void> {
+#if defined(SO_REUSEPORT)
+        auto fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) {
+            return unexpected{make_sys_error(errno)};
+        }
+        int on = 1;
+        if (::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) != 0) {
+            auto error = errno;
+            ::close(fd);
+            return unexpected{make_sys_error(error)};
+        }
+        if (auto ret = uv_tcp_open(&listen_socket_, fd); ret != 0) {
+            ::close(fd);
+            return unexpected{make_sys_error(-ret)};
+        }
+        return {};
+#else
+        return unexpected{make_sys_error(ENOTSUP)};
+#endif
     }
 };
 
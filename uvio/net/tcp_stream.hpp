@@ -3,12 +3,24 @@
 #include "uvio/common/result.hpp"
 #include "uvio/coroutine/task.hpp"
 #include "uvio/debug.hpp"
+#include "uvio/io/bytes.hpp"
 #include "uvio/io/split.hpp"
 #include "uvio/log.hpp"
 #include "uvio/macros.hpp"
+#include "uvio/runtime/context.hpp"
+#include "uvio/runtime/ready_queue.hpp"
+#include "uvio/time/timer.hpp"
 
+#include <array>
+#include <chrono>
+#include <concepts>
 #include <coroutine>
 #include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
 
 #include "uv.h"
 #include "uvio/net/tcp_util.hpp"
@@ -17,13 +29,27 @@ namespace uvio::net {
 
 using namespace uvio::log;
 
+namespace detail {
+
+    // Buffers a write can take over: moved strings and vectors, and `Bytes`,
+    // which are shared rather than copied
+    template <typename T>
+    concept OwnedBuffer = (!std::is_lvalue_reference_v<T>
+                           && (std::same_as<T, std::string>
+                               || std::same_as<T, std::vector<char>>))
+                          || std::same_as<std::remove_cvref_t<T>, io::Bytes>;
+
+} // namespace detail
+
 class TcpStream {
 public:
     TcpStream(std::unique_ptr<uv_tcp_t> socket)
         : tcp_handle_{std::move(socket)} {}
 
     TcpStream(TcpStream &&other) noexcept
-        : tcp_handle_{std::move(other.tcp_handle_)} {
+        : tcp_handle_{std::move(other.tcp_handle_)}
+        , read_timeout_{other.read_timeout_}
+        , write_timeout_{other.write_timeout_} {
         other.tcp_handle_ = nullptr;
     }
     auto operator=(TcpStream &&other) noexcept -> TcpStream & {
@@ -37,6 +63,8 @@ public:
         if (std::addressof(other) != this) [[likely]] {
             tcp_handle_ = std::move(other.tcp_handle_);
             other.tcp_handle_ = nullptr;
+            read_timeout_ = other.read_timeout_;
+            write_timeout_ = other.write_timeout_;
         }
         return *this;
     }
@@ -65,82 +93,463 @@ public:
 
 private:
     std::unique_ptr<uv_tcp_t> tcp_handle_;
+    // Milliseconds, 0 waits forever
+    uint64_t read_timeout_{0};
+    uint64_t write_timeout_{0};
 
-public:
-    [[REMEMBER_CO_AWAIT]]
-    auto read(std::span<char> buf) const {
-        struct ReadAwaiter {
-            std::coroutine_handle<> handle_;
-            uv_tcp_t               *socket_;
-            std::span<char>         buf_;
-            ssize_t                 nread_{0};
-
-            ReadAwaiter(uv_tcp_t *socket, std::span<char> buf)
-                : socket_{socket}
-                , buf_{buf} {
-                socket_->data = this;
-
-                uv_check(uv_read_start(
-                    reinterpret_cast<uv_stream_t *>(socket_),
-                    [](uv_handle_t *handle,
-                       size_t       suggested_size,
-                       uv_buf_t    *buf) {
-                        (void) suggested_size;
-                        auto data = static_cast<ReadAwaiter *>(handle->data);
-                        *buf
-                            = uv_buf_init(data->buf_.data(), data->buf_.size());
-                    },
-                    [](uv_stream_t *req, ssize_t nread, const uv_buf_t *buf) {
-                        (void) buf;
-                        auto data = static_cast<ReadAwaiter *>(req->data);
-                        data->nread_ = nread;
-                        if (nread < 0) {
-                            if (nread != UV_EOF) {
-                                console.error(
-                                    "Read error: {}",
-                                    uv_err_name(static_cast<int>(nread)));
-                            } else {
-                                auto peer = PeerAddress(data->socket_);
-                                LOG_DEBUG("{}:{} closed",
-                                          peer.ipv4(),
-                                          peer.port());
-                            }
+private:
+    struct ReadAwaiter {
+        std::coroutine_handle<>    handle_;
+        uv_tcp_t                  *socket_;
+        std::span<char>            buf_;
+        ssize_t                    nread_{0};
+        uint64_t                   timeout_;
+        time::detail::OneShotTimer deadline_;
+        CancellationRegistration   cancellation_;
+
+        ReadAwaiter(uv_tcp_t *socket, std::span<char> buf, uint64_t timeout)
+            : socket_{socket}
+            , buf_{buf}
+            , timeout_{timeout} {
+            socket_->data = this;
+
+            uv_check(uv_read_start(
+                reinterpret_cast<uv_stream_t *>(socket_),
+                [](uv_handle_t *handle,
+                   size_t       suggested_size,
+                   uv_buf_t    *buf) {
+                    (void) suggested_size;
+                    auto data = static_cast<ReadAwaiter *>(handle->data);
+                    *buf = uv_buf_init(data->buf_.data(), data->buf_.size());
+                },
+                [](uv_stream_t *req, ssize_t nread, const uv_buf_t *buf) {
+                    (void) buf;
+                    if (nread == 0) {
+                        // EAGAIN, nothing was read
+                        return;
+                    }
+                    auto data = static_cast<ReadAwaiter *>(req->data);
+                    // Stop right away, libuv would otherwise keep reading
+                    // into the same buffer until the coroutine runs
+                    data->stop(nread);
+                    if (nread < 0) {
+                        if (nread != UV_EOF) {
+                            console.error("Read error: {}",
+                                          uv_err_name(static_cast<int>(nread)));
+                        } else {
+                            auto peer = PeerAddress(data->socket_);
+                            LOG_DEBUG("{}:{} closed", peer.ipv4(), peer.port());
                         }
-                        LOG_DEBUG("read {} bytes", nread);
+                    }
+                    LOG_DEBUG("read {} bytes", nread);
 
-                        if (data->handle_) {
-                            data->handle_.resume();
-                        }
-                    }));
+                    data->cancellation_.reset();
+                    data->deadline_.stop();
+                    data->cancellation_.reset();
+                    if (data->handle_) {
+                        uvio::detail::schedule(data->handle_);
+                    }
+                }));
+        }
+
+        ~ReadAwaiter() {
+            if (socket_->data == this) {
+                stop(0);
             }
+        }
 
-            auto await_ready() const -> bool {
-                return this->nread_ > 0;
+        // No copy, no move (the socket points back to this object)
+        ReadAwaiter(const ReadAwaiter &) = delete;
+        auto operator=(const ReadAwaiter &) = delete;
+        ReadAwaiter(ReadAwaiter &&) = delete;
+        auto operator=(ReadAwaiter &&) = delete;
+
+        auto await_ready() const -> bool {
+            return this->nread_ > 0;
+        }
+        template <typename Promise>
+        auto await_suspend(std::coroutine_handle<Promise> handle) -> bool {
+            if (!cancellation_.register_callback(
+                    uvio::detail::cancellation_token_of(handle),
+                    on_cancel,
+                    this)) {
+                stop(UV_ECANCELED);
+                return false;
             }
-            auto await_suspend(std::coroutine_handle<> handle) {
-                this->handle_ = handle;
+            if (timeout_ > 0) {
+                deadline_.start(timeout_, on_timeout, this);
             }
-            auto await_resume() -> Result<std::size_t> {
-                auto nread = this->nread_;
-                if (nread < 0) {
-                    if (nread == UV_EOF) {
-                        return unexpected{
-                            make_uvio_error(Error::UnexpectedEOF)};
-                    } else {
-                        return unexpected{make_uvio_error(Error::Unclassified)};
-                    }
+            this->handle_ = handle;
+            return true;
+        }
+        auto await_resume() -> Result<std::size_t> {
+            cancellation_.reset();
+            deadline_.stop();
+            auto nread = this->nread_;
+            if (nread < 0) {
+                if (nread == UV_ECANCELED) {
+                    return unexpected{make_uvio_error(Error::Cancelled)};
+                } else if (nread == UV_ETIMEDOUT) {
+                    return unexpected{make_uvio_error(Error::TimedOut)};
+                } else if (nread == UV_EOF) {
+                    return unexpected{make_uvio_error(Error::UnexpectedEOF)};
+                } else {
+                    return unexpected{make_uvio_error(Error::Unclassified)};
                 }
-                this->nread_ = 0;
-                this->handle_ = nullptr;
-                socket_->data = nullptr;
-
-                uv_check(
-                    uv_read_stop(reinterpret_cast<uv_stream_t *>(socket_)));
-                // nread == 0 ?
-                return static_cast<std::size_t>(nread);
             }
+            this->nread_ = 0;
+            this->handle_ = nullptr;
+            return static_cast<std::size_t>(nread);
+        }
+
+        auto stop(ssize_t nread) -> void {
+            nread_ = nread;
+            socket_->data = nullptr;
+            uv_check(uv_read_stop(reinterpret_cast<uv_stream_t *>(socket_)));
+        }
+
+        static auto on_cancel(void *data) -> void {
+            auto self = static_cast<ReadAwaiter *>(data);
+            self->stop(UV_ECANCELED);
+            self->deadline_.stop();
+            uvio::detail::schedule(self->handle_);
+        }
+
+        static auto on_timeout(void *data) -> void {
+            auto self = static_cast<ReadAwaiter *>(data);
+            self->stop(UV_ETIMEDOUT);
+            self->cancellation_.reset();
+            uvio::detail::schedule(self->handle_);
+        }
+    };
+
+    struct WriteAwaiter {
+        // What the request sends: a borrowed span, or a buffer it owns
+        using Payload = std::variant<std::span<const char>,
+                                     std::string,
+                                     std::vector<char>,
+                                     io::Bytes>;
+
+        // libuv cannot cancel a write, so the request and its payload live on
+        // the heap and outlive an awaiter that gave up on them
+        struct Request {
+            uv_write_t    req_{};
+            Payload       payload_;
+            std::size_t   length_{0};
+            WriteAwaiter *awaiter_;
         };
-        return ReadAwaiter{tcp_handle_.get(), buf};
+
+        std::coroutine_handle<>    handle_;
+        int                        status_{1};
+        std::size_t                nwritten_{0};
+        bool                       empty_{false};
+        Request                   *request_;
+        uint64_t                   timeout_;
+        time::detail::OneShotTimer deadline_;
+        CancellationRegistration   cancellation_;
+
+        WriteAwaiter(uv_tcp_t *socket, Payload payload, uint64_t timeout)
+            : WriteAwaiter{std::move(payload), timeout} {
+            // Taken after the move, a short string lives inside the payload
+            std::array<std::span<const char>, 1> message{std::visit(
+                [](const auto &buffer) {
+                    return std::span<const char>{buffer.data(), buffer.size()};
+                },
+                request_->payload_)};
+            submit(socket, message);
+        }
+
+        // The slices are borrowed, only their descriptors are copied
+        WriteAwaiter(uv_tcp_t                              *socket,
+                     std::span<const std::span<const char>> slices,
+                     uint64_t                               timeout)
+            : WriteAwaiter{Payload{}, timeout} {
+            // Nothing to send is not a failed write, libuv is not involved
+            if (slices.empty()) {
+                delete std::exchange(request_, nullptr);
+                status_ = 0;
+                empty_ = true;
+                return;
+            }
+            submit(socket, slices);
+        }
+
+        // A write still pending goes on without the awaiter
+        ~WriteAwaiter() {
+            if (request_ != nullptr) {
+                detach();
+            }
+        }
+
+        // No copy, no move (the request points back to this object)
+        WriteAwaiter(const WriteAwaiter &) = delete;
+        auto operator=(const WriteAwaiter &) = delete;
+        WriteAwaiter(WriteAwaiter &&) = delete;
+        auto operator=(WriteAwaiter &&) = delete;
+
+        auto await_ready() const noexcept -> bool {
+            return status_ <= 0;
+        }
+
+        template <typename Promise>
+        auto await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            handle_ = handle;
+            if (!cancellation_.register_callback(
+                    uvio::detail::cancellation_token_of(handle),
+                    on_cancel,
+                    this)) {
+                on_cancel(this);
+                return;
+            }
+            if (timeout_ > 0) {
+                deadline_.start(timeout_, on_timeout, this);
+            }
+        }
+
+        auto await_resume() noexcept -> Result<std::size_t> {
+            deadline_.stop();
+            cancellation_.reset();
+            handle_ = nullptr;
+            if (status_ == UV_ETIMEDOUT) {
+                return unexpected{make_uvio_error(Error::TimedOut)};
+            }
+            if (status_ == UV_ECANCELED) {
+                return unexpected{make_uvio_error(Error::Cancelled)};
+            }
+            if (status_ != 0) {
+                return unexpected{make_uvio_error(Error::Unclassified)};
+            }
+            if (nwritten_ == 0 && !empty_) {
+                return unexpected{make_uvio_error(Error::WriteZero)};
+            }
+            return nwritten_;
+        }
+
+        // The stream is left with a partial write, the caller is expected to
+        // drop it, which completes the request with UV_ECANCELED
+        static auto on_timeout(void *data) -> void {
+            auto self = static_cast<WriteAwaiter *>(data);
+            self->give_up(UV_ETIMEDOUT);
+        }
+
+        // Same for a cancelled write
+        static auto on_cancel(void *data) -> void {
+            auto self = static_cast<WriteAwaiter *>(data);
+            self->give_up(UV_ECANCELED);
+        }
+
+    private:
+        auto give_up(int status) -> void {
+            deadline_.stop();
+            cancellation_.reset();
+            detach();
+            status_ = status;
+            uvio::detail::schedule(handle_);
+        }
+
+        // Lets the request complete on its own. libuv keeps pointing into a
+        // borrowed payload until then, so the bytes it has not sent yet are
+        // copied into the request first: the caller may free or reuse its
+        // buffer as soon as it resumes.
+        auto detach() -> void {
+            auto request = std::exchange(request_, nullptr);
+            request->awaiter_ = nullptr;
+            if (!std::holds_alternative<std::span<const char>>(
+                    request->payload_)) {
+                return;
+            }
+#if !defined(_WIN32)
+            // Sent bytes are consumed from `bufs[write_index]` on, in place
+            auto       &req = request->req_;
+            std::string unsent;
+            for (auto i = req.write_index; i < req.nbufs; i++) {
+                unsent.append(req.bufs[i].base, req.bufs[i].len);
+            }
+            auto &owned = request->payload_.emplace<std::string>(
+                std::move(unsent));
+            if (req.write_index < req.nbufs) {
+                req.bufs[req.write_index]
+                    = uv_buf_init(owned.data(), owned.size());
+                req.nbufs = req.write_index + 1;
+            }
+#endif
+        }
+
+        WriteAwaiter(Payload payload, uint64_t timeout)
+            : request_{new Request{
+                .payload_ = std::move(payload),
+                .awaiter_ = this,
+            }}
+            , timeout_{timeout} {
+            request_->req_.data = request_;
+        }
+
+        // One uv_write() for all of `slices`, a writev() underneath
+        auto submit(uv_tcp_t                              *socket,
+                    std::span<const std::span<const char>> slices) -> void {
+#if defined(_WIN32)
+            // An overlapped write cannot be detached from its memory, so a
+            // borrowed payload is copied up front
+            std::array<std::span<const char>, 1> joined{};
+            if (std::holds_alternative<std::span<const char>>(
+                    request_->payload_)) {
+                std::string copy;
+                for (auto slice : slices) {
+                    copy.append(slice.data(), slice.size());
+                }
+                auto &owned
+                    = request_->payload_.emplace<std::string>(std::move(copy));
+                joined[0] = std::span<const char>{owned.data(), owned.size()};
+                slices = joined;
+            }
+#endif
+            // libuv copies the descriptors, so a few of them stay on the stack
+            constexpr std::size_t             INLINE_BUFS{8};
+            std::array<uv_buf_t, INLINE_BUFS> inline_bufs{};
+            std::vector<uv_buf_t>             heap_bufs;
+            std::span<uv_buf_t>               bufs{inline_bufs};
+            if (slices.size() > INLINE_BUFS) {
+                heap_bufs.resize(slices.size());
+                bufs = heap_bufs;
+            }
+            bufs = bufs.first(slices.size());
+            for (std::size_t i = 0; i < slices.size(); i++) {
+                bufs[i] = uv_buf_init(const_cast<char *>(slices[i].data()),
+                                      slices[i].size());
+                request_->length_ += slices[i].size();
+            }
+
+            uv_check(uv_write(
+                &request_->req_,
+                reinterpret_cast<uv_stream_t *>(socket),
+                bufs.data(),
+                static_cast<unsigned int>(bufs.size()),
+                [](uv_write_t *req, int status) {
+                    auto request = static_cast<Request *>(req->data);
+                    auto data = request->awaiter_;
+                    auto length = request->length_;
+                    delete request;
+                    if (data == nullptr) {
+                        return;
+                    }
+
+                    data->request_ = nullptr;
+                    data->status_ = status;
+                    if (status != 0) {
+                        console.error("Write error: {}", uv_strerror(status));
+                        data->nwritten_ = 0;
+                    } else {
+                        data->nwritten_ = length;
+                    }
+
+                    data->deadline_.stop();
+                    data->cancellation_.reset();
+                    if (data->handle_) {
+                        uvio::detail::schedule(data->handle_);
+                    }
+                }));
+        }
+    };
+
+    struct ConnectAwaiter {
+
+        std::coroutine_handle<>   handle_;
+        std::unique_ptr<uv_tcp_t> client_;
+        uv_connect_t              connect_req_{};
+        int                       status_{1};
+        bool                      cancelled_{false};
+        CancellationRegistration  cancellation_;
+
+        ConnectAwaiter(std::string_view addr, int port)
+            : client_{std::make_unique<uv_tcp_t>()} {
+            uv_check(uv_tcp_init(current_loop(), client_.get()));
+
+            struct sockaddr_in dest {};
+            uv_check(uv_ip4_addr(addr.data(), port, &dest));
+
+            connect_req_.data = this;
+
+            uv_check(uv_tcp_connect(
+                &connect_req_,
+                client_.get(),
+                reinterpret_cast<const struct sockaddr *>(&dest),
+                [](uv_connect_t *req, int status) {
+                    auto data = static_cast<ConnectAwaiter *>(req->data);
+                    data->status_ = status;
+                    if (status != 0 && !data->cancelled_) {
+                        console.error("Connect failed: {}",
+                                      uv_strerror(status));
+                    }
+
+                    data->cancellation_.reset();
+                    if (data->handle_) {
+                        uvio::detail::schedule(data->handle_);
+                    }
+                }));
+        }
+
+        ~ConnectAwaiter() {
+            close_client();
+        }
+
+        // No copy, no move (connect_req_ points to this)
+        ConnectAwaiter(const ConnectAwaiter &) = delete;
+        auto operator=(const ConnectAwaiter &) = delete;
+        ConnectAwaiter(ConnectAwaiter &&) = delete;
+        auto operator=(ConnectAwaiter &&) = delete;
+
+        auto await_ready() const noexcept -> bool {
+            return status_ <= 0;
+        }
+
+        template <typename Promise>
+        auto await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            handle_ = handle;
+            if (!cancellation_.register_callback(
+                    uvio::detail::cancellation_token_of(handle),
+                    on_cancel,
+                    this)) {
+                on_cancel(this);
+            }
+        }
+
+        [[nodiscard]]
+        auto await_resume() noexcept -> Result<TcpStream> {
+            cancellation_.reset();
+            handle_ = nullptr;
+            if (cancelled_) {
+                return unexpected{make_uvio_error(Error::Cancelled)};
+            }
+            if (status_ != 0) {
+                close_client();
+                return unexpected{make_sys_error(-status_)};
+            }
+            uvio::net::detail::apply_busy_poll(client_.get());
+            return TcpStream{std::move(client_)};
+        }
+
+        auto close_client() noexcept -> void {
+            if (client_) {
+                uv_close(reinterpret_cast<uv_handle_t *>(client_.release()),
+                         [](uv_handle_t *handle) {
+                             delete reinterpret_cast<uv_tcp_t *>(handle);
+                         });
+            }
+        }
+
+        // Closing the handle completes the pending connect request with
+        // UV_ECANCELED, which resumes the awaiting coroutine
+        static auto on_cancel(void *data) -> void {
+            auto self = static_cast<ConnectAwaiter *>(data);
+            self->cancelled_ = true;
+            self->close_client();
+        }
+    };
+
+public:
+    [[REMEMBER_CO_AWAIT]]
+    auto read(std::span<char> buf) const {
+        return ReadAwaiter{tcp_handle_.get(), buf, read_timeout_};
     }
 
     [[REMEMBER_CO_AWAIT]]
@@ -160,126 +569,62 @@ public:
         co_return Result<void>{};
     }
 
+    // `message` is copied, it may go away as soon as this returns
     [[REMEMBER_CO_AWAIT]]
     auto write(std::span<const char> message) {
-        struct WriteAwaiter {
-            std::coroutine_handle<> handle_;
-            uv_tcp_t               *socket_;
-            int                     status_{1};
-            std::size_t             nwritten_{0};
-            std::string             to_write_;
-            uv_write_t              req{};
-
-            WriteAwaiter(uv_tcp_t *socket, std::span<const char> message)
-                : socket_{socket}
-                , to_write_{message.data(), message.size()} {
-                req.data = this;
-
-                uv_buf_t buf = uv_buf_init(to_write_.data(), to_write_.size());
-
-                uv_check(uv_write(
-                    &req,
-                    reinterpret_cast<uv_stream_t *>(socket_),
-                    &buf,
-                    1,
-                    [](uv_write_t *req, int status) {
-                        auto data = static_cast<WriteAwaiter *>(req->data);
-                        data->status_ = status;
-                        if (status != 0) {
-                            console.error("Write error: {}",
-                                          uv_strerror(status));
-                            data->nwritten_ = 0;
-                        } else {
-                            data->nwritten_ = data->to_write_.length();
-                        }
+        return WriteAwaiter{tcp_handle_.get(),
+                            std::string{message.data(), message.size()},
+                            write_timeout_};
+    }
 
-                        if (data->handle_) {
-                            data->handle_.resume();
-                        }
-                    }));
-            }
+    // `message` is handed over and sent without a copy
+    template <typename Buffer>
+        requires detail::OwnedBuffer<Buffer>
+    [[REMEMBER_CO_AWAIT]]
+    auto write(Buffer &&message) {
+        return WriteAwaiter{
+            tcp_handle_.get(),
+            std::remove_cvref_t<Buffer>{std::forward<Buffer>(message)},
+            write_timeout_};
+    }
 
-            auto await_ready() const noexcept -> bool {
-                return status_ <= 0;
-            }
+    // `message` is sent in place and must outlive the awaiter. A write that
+    // timed out, or whose awaiter is gone, copies what it has not sent yet
+    // and goes on without it.
+    [[REMEMBER_CO_AWAIT]]
+    auto write_borrowed(std::span<const char> message) {
+        return WriteAwaiter{tcp_handle_.get(), message, write_timeout_};
+    }
 
-            auto await_suspend(std::coroutine_handle<> handle) noexcept {
-                handle_ = handle;
-            }
+    // `slices` go out in order by a single write, without being joined. Like
+    // `write_borrowed()`, they are sent in place and must outlive the awaiter.
+    [[REMEMBER_CO_AWAIT]]
+    auto write_vectored(std::span<const std::span<const char>> slices) {
+        return WriteAwaiter{tcp_handle_.get(), slices, write_timeout_};
+    }
 
-            auto await_resume() noexcept -> Result<std::size_t> {
-                handle_ = nullptr;
-                if (status_ != 0) {
-                    return unexpected{make_uvio_error(Error::Unclassified)};
-                }
-                if (nwritten_ == 0) {
-                    return unexpected{make_uvio_error(Error::WriteZero)};
-                }
-                return nwritten_;
-            }
-        };
-        return WriteAwaiter{tcp_handle_.get(), message};
+    // A read that sees no data for `timeout` fails with `Error::TimedOut`,
+    // zero disables the deadline
+    auto set_read_timeout(std::chrono::milliseconds timeout) noexcept {
+        read_timeout_ = static_cast<uint64_t>(timeout.count());
+    }
+
+    // A write the peer does not drain within `timeout` fails with
+    // `Error::TimedOut` and leaves the stream unusable
+    auto set_write_timeout(std::chrono::milliseconds timeout) noexcept {
+        write_timeout_ = static_cast<uint64_t>(timeout.count());
     }
 
 public:
     [[REMEMBER_CO_AWAIT]]
     static auto connect(std::string_view addr, int port) {
-        struct ConnectAwaiter {
-
-            std::coroutine_handle<>   handle_;
-            std::unique_ptr<uv_tcp_t> client_;
-            uv_connect_t              connect_req_{};
-            int                       status_{1};
-
-            ConnectAwaiter(std::string_view addr, int port)
-                : client_{std::make_unique<uv_tcp_t>()} {
-                uv_check(uv_tcp_init(uv_default_loop(), client_.get()));
-
-                struct sockaddr_in dest {};
-                uv_check(uv_ip4_addr(addr.data(), port, &dest));
-
-                connect_req_.data = this;
-
-                uv_check(uv_tcp_connect(
-                    &connect_req_,
-                    client_.get(),
-                    reinterpret_cast<const struct sockaddr *>(&dest),
-                    [](uv_connect_t *req, int status) {
-                        auto data = static_cast<ConnectAwaiter *>(req->data);
-                        data->status_ = status;
-                        if (status != 0) {
-                            console.error("Connect failed: {}",
-                                          uv_strerror(status));
-                            return;
-                        }
-
-                        if (data->handle_) {
-                            data->handle_.resume();
-                        }
-                    }));
-            }
-
-            auto await_ready() const noexcept -> bool {
-                return status_ <= 0;
-            }
-
-            auto await_suspend(std::coroutine_handle<> handle) noexcept {
-                handle_ = handle;
-            }
-
-            [[nodiscard]]
-            auto await_resume() noexcept -> Result<TcpStream> {
-                handle_ = nullptr;
-                return TcpStream{std::move(client_)};
-            }
-        };
         return ConnectAwaiter{addr, port};
     }
 
     [[nodiscard]]
     auto into_split() noexcept -> std::pair<io::OwnedReadHalf<TcpStream>,
                                             io::OwnedWriteHalf<TcpStream>> {
-        auto stream = std::make_shared<TcpStream>(std::move(tcp_handle_));
+        auto stream = std::make_shared<TcpStream>(std::move(*this));
         return std::make_pair(io::OwnedReadHalf<TcpStream>{stream},
                               io::OwnedWriteHalf<TcpStream>{stream});
     }
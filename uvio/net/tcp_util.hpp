@@ -1,6 +1,11 @@
 #pragma once
 
+#include "uvio/debug.hpp"
+#include "uvio/runtime/context.hpp"
+
 #include "uv.h"
+#include <cerrno>
+#include <cstring>
 #include <string>
 
 namespace uvio::net {
@@ -28,4 +33,28 @@ public:
 private:
     struct sockaddr_in addrin_ {};
 };
+
+namespace detail {
+    // Apply `RuntimeOptions::socket_busy_poll` of the current runtime, best
+    // effort
+    static inline auto apply_busy_poll(uv_tcp_t *socket) -> void {
+        auto context = uvio::detail::current_context;
+        if (context == nullptr || context->options_ == nullptr
+            || context->options_->socket_busy_poll.count() <= 0) {
+            return;
+        }
+#if defined(SO_BUSY_POLL)
+        uv_os_fd_t fd{};
+        if (uv_fileno(reinterpret_cast<uv_handle_t *>(socket), &fd) != 0) {
+            return;
+        }
+        auto usec
+            = static_cast<int>(context->options_->socket_busy_poll.count());
+        if (::setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &usec, sizeof(usec))
+            != 0) {
+            LOG_WARN("set SO_BUSY_POLL failed: {}", std::strerror(errno));
+        }
+#endif
+    }
+} // namespace detail
 } // namespace uvio::net
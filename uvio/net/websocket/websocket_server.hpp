@@ -32,19 +32,32 @@ public:
         websocket_handler_ = std::move(func);
     }
 
-    auto run() {
-        block_on([this]() -> Task<> {
-            auto listener = TcpListener();
-            listener.bind(this->host_, this->port_);
-            console.info("Listening on {}:{} ...", this->host_, this->port_);
-            while (true) {
-                auto stream = (co_await listener.accept()).value();
-                spawn(this->handle_websocket(std::move(stream)));
-            }
-        }());
+    // Serve on `num_workers` loops, each one accepting on its own
+    // SO_REUSEPORT listener and sharing the same route table
+    auto run(std::size_t num_workers = 1) {
+        Runtime runtime{num_workers};
+        runtime.block_on_each([this, reuse_port = num_workers > 1]() {
+            return this->serve(reuse_port);
+        });
     }
 
 private:
+    auto serve(bool reuse_port) -> Task<> {
+        auto listener = TcpListener();
+        if (auto ret = listener.bind(this->host_,
+                                     this->port_,
+                                     {.reuse_port = reuse_port});
+            !ret) {
+            console.error("{}", ret.error().message());
+            co_return;
+        }
+        console.info("Listening on {}:{} ...", this->host_, this->port_);
+        while (true) {
+            auto stream = (co_await listener.accept()).value();
+            spawn(this->handle_websocket(std::move(stream)));
+        }
+    }
+
     auto handle_websocket(TcpStream stream) -> Task<> {
         WebsocketFramed websocket_framed{std::move(stream)};
 
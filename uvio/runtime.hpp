@@ -1,10 +1,17 @@
 #pragma once
 
+#include "uvio/coroutine/join_handle.hpp"
 #include "uvio/coroutine/task.hpp"
 #include "uvio/log.hpp"
+#include "uvio/runtime/options.hpp"
+#include "uvio/runtime/context.hpp"
+#include "uvio/runtime/submit.hpp"
+#include "uvio/runtime/worker.hpp"
 #include "uvio/work.hpp"
 
+#include <algorithm>
 #include <functional>
+#include <thread>
 
 #include "uv.h"
 
@@ -13,34 +20,165 @@ namespace uvio {
 using namespace uvio::log;
 using namespace uvio::work;
 
-namespace detail {
-    static inline auto run_loop() -> int {
-        int ret = uv_run(uv_default_loop(), UV_RUN_DEFAULT);
-        uv_loop_close(uv_default_loop());
-        return ret;
+// N event loops on N threads. Worker 0 runs on the thread calling `block_on`,
+// the others are started by `block_on` and stopped when it returns. Every
+// awaiter binds to the loop of the thread it runs on (see `current_loop()`).
+class Runtime {
+public:
+    explicit Runtime(std::size_t    num_workers = default_num_workers(),
+                     RuntimeOptions options = {})
+        : options_{std::move(options)} {
+        ASSERT(num_workers >= 1);
+        workers_.reserve(num_workers);
+        for (std::size_t i = 0; i < num_workers; i++) {
+            workers_.emplace_back(
+                std::make_unique<uvio::detail::Worker>(i, this));
+        }
+        for (auto &worker : workers_) {
+            worker->connect(workers_, options_);
+        }
     }
-} // namespace detail
 
-static inline auto block_on(Task<> &&first_coro) {
-    auto handle = std::move(first_coro).take();
-    console.debug("loop run ...");
-    handle.resume();
+    // No copy
+    Runtime(const Runtime &) = delete;
+    auto operator=(const Runtime &) = delete;
+
+public:
+    auto block_on(Task<> &&first_coro) -> void {
+        for (std::size_t i = 1; i < workers_.size(); i++) {
+            threads_.emplace_back([worker = workers_[i].get()]() {
+                worker->run();
+                worker->close();
+            });
+        }
+
+        auto &main_worker = *workers_.front();
+        auto  handle = std::move(first_coro).take();
+        console.debug("loop run ...");
+        auto prev = uvio::detail::current_context;
+        uvio::detail::current_context = main_worker.context();
+        handle.resume();
+        uvio::detail::current_context = prev;
 
 #if !defined(NDEBUG)
-    console.debug("{:*^30}", "[all handles]");
-    uv_print_all_handles(uv_default_loop(), stdout);
-    console.debug("{:*^30}", "[active handles]");
-    uv_print_active_handles(uv_default_loop(), stdout);
+        console.debug("{:*^30}", "[all handles]");
+        uv_print_all_handles(main_worker.loop(), stdout);
+        console.debug("{:*^30}", "[active handles]");
+        uv_print_active_handles(main_worker.loop(), stdout);
 #endif
-    uvio::detail::run_loop();
-    console.debug("loop end.");
+        main_worker.run();
+
+        for (std::size_t i = 1; i < workers_.size(); i++) {
+            workers_[i]->shutdown();
+        }
+        for (auto &thread : threads_) {
+            thread.join();
+        }
+        threads_.clear();
+        main_worker.close();
+        console.debug("loop end.");
+    }
+
+    // Run one coroutine made by `make_coro` on every worker, e.g. a sharded
+    // accept loop per core
+    auto block_on_each(const std::function<Task<>()> &make_coro) -> void {
+        block_on([](Runtime                       *self,
+                    const std::function<Task<>()> &make_coro) -> Task<> {
+            for (std::size_t i = 1; i < self->num_workers(); i++) {
+                self->spawn_on(i, make_coro());
+            }
+            co_await make_coro();
+        }(this, make_coro));
+    }
+
+    // Run `task` on the loop of worker `worker_id`, callable from any thread
+    auto spawn_on(std::size_t worker_id, Task<> &&task) -> void {
+        ASSERT(worker_id < workers_.size());
+        workers_[worker_id]->post(std::move(task).take());
+    }
+
+    // Run a CPU-bound `task` on whichever worker gets to it first. With
+    // `RuntimeOptions::work_stealing` it is queued on the current worker,
+    // where idle workers may steal it before it starts; once started it stays
+    // on that loop. Otherwise it is scheduled on the current loop. From
+    // outside the runtime it goes to worker 0.
+    auto spawn_stealable(Task<> &&task) -> void {
+        auto context = uvio::detail::current_context;
+        if (context == nullptr || context->runtime_ != this) {
+            spawn_on(0, std::move(task));
+        } else if (options_.work_stealing) {
+            context->worker_->push_task(std::move(task).take());
+        } else {
+            uvio::detail::schedule(std::move(task).take());
+        }
+    }
+
+    // Run `task` on the loop of worker `worker_id` and get its result back,
+    // e.g. to reach the worker owning a shard without locking it:
+    // `auto value = co_await runtime.submit_to(shard, lookup(key));`. Only
+    // from a coroutine of this runtime, the task goes there and back through
+    // a lock-free queue per pair of workers.
+    template <typename T>
+    [[REMEMBER_CO_AWAIT]]
+    auto submit_to(std::size_t worker_id, Task<T> &&task) {
+        ASSERT(worker_id < workers_.size());
+        auto context = uvio::detail::current_context;
+        ASSERT_MSG(context != nullptr && context->runtime_ == this,
+                   "submit_to() outside of the runtime");
+        return uvio::detail::SubmitAwaiter<T>{context->worker_,
+                                              workers_[worker_id].get(),
+                                              std::move(task)};
+    }
+
+    [[nodiscard]]
+    auto num_workers() const noexcept -> std::size_t {
+        return workers_.size();
+    }
+
+    // Steal, queue and busy-poll counters of worker `worker_id`, readable
+    // from any thread while the runtime runs
+    [[nodiscard]]
+    auto worker_stats(std::size_t worker_id) const -> WorkerStats {
+        ASSERT(worker_id < workers_.size());
+        return workers_[worker_id]->stats();
+    }
+
+    [[nodiscard]]
+    static auto default_num_workers() noexcept -> std::size_t {
+        return (std::max)(std::thread::hardware_concurrency(), 1u);
+    }
+
+private:
+    std::vector<std::unique_ptr<uvio::detail::Worker>> workers_;
+    std::vector<std::thread>                           threads_;
+    RuntimeOptions                                     options_;
+};
+
+// The runtime driving the calling thread, nullptr outside of a runtime
+[[nodiscard]]
+static inline auto current_runtime() noexcept -> Runtime * {
+    if (uvio::detail::current_context != nullptr) {
+        return uvio::detail::current_context->runtime_;
+    }
+    return nullptr;
+}
+
+static inline auto block_on(Task<> &&first_coro) {
+    Runtime{1}.block_on(std::move(first_coro));
 }
 
-static inline auto spawn(Task<> &&task) {
-    auto handle = std::move(task).take();
+// Run `task` on the current loop until its first suspension point, the
+// returned handle can be awaited for its result or dropped to detach it
+template <typename T>
+static inline auto spawn(Task<T> &&task) -> JoinHandle<T> {
+    auto state = std::make_shared<uvio::detail::JoinState<T>>();
+    auto join = uvio::detail::run_and_join(std::move(task), state);
+    join.set_cancellation_token(state->source_.token());
+    auto handle = join.take();
     console.debug("spawn task ...");
     handle.resume();
     console.debug("spawn end.");
+    return JoinHandle<T>{std::move(state)};
 }
 
 static inline auto spawn(std::function<void()> &&func) {
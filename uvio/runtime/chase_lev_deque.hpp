@@ -0,0 +1,149 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace uvio::detail {
+
+// Work-stealing deque (Chase-Lev, with the C11 orderings of Lê et al.). The
+// owner pushes and pops at the bottom without contention, thieves take the
+// oldest values from the top with a CAS. The ring doubles when full; the old
+// rings stay alive until the deque is destroyed, since a thief may still be
+// reading one.
+template <typename T>
+class ChaseLevDeque {
+    struct Ring {
+        explicit Ring(std::size_t capacity)
+            : mask_{capacity - 1}
+            , slots_{std::make_unique<std::atomic<T>[]>(capacity)} {}
+
+        [[nodiscard]]
+        auto capacity() const noexcept -> std::size_t {
+            return mask_ + 1;
+        }
+
+        auto load(int64_t index) const noexcept -> T {
+            return slots_[static_cast<std::size_t>(index) & mask_].load(
+                std::memory_order::acquire);
+        }
+
+        auto store(int64_t index, T value) noexcept -> void {
+            slots_[static_cast<std::size_t>(index) & mask_].store(
+                value,
+                std::memory_order::release);
+        }
+
+        std::size_t                       mask_;
+        std::unique_ptr<std::atomic<T>[]> slots_;
+    };
+
+    constexpr static std::size_t INITIAL_CAPACITY{64};
+    constexpr static std::size_t CACHE_LINE{64};
+
+public:
+    ChaseLevDeque() {
+        rings_.push_back(std::make_unique<Ring>(INITIAL_CAPACITY));
+        ring_.store(rings_.back().get(), std::memory_order::relaxed);
+    }
+
+    // No copy, no move
+    ChaseLevDeque(const ChaseLevDeque &) = delete;
+    auto operator=(const ChaseLevDeque &) = delete;
+    ChaseLevDeque(ChaseLevDeque &&) = delete;
+    auto operator=(ChaseLevDeque &&) = delete;
+
+public:
+    // Owner only
+    auto push(T value) -> void {
+        auto bottom = bottom_.load(std::memory_order::relaxed);
+        auto top = top_.load(std::memory_order::acquire);
+        auto ring = ring_.load(std::memory_order::relaxed);
+        if (bottom - top > static_cast<int64_t>(ring->capacity()) - 1)
+            [[unlikely]] {
+            ring = grow(ring, top, bottom);
+        }
+        ring->store(bottom, value);
+        std::atomic_thread_fence(std::memory_order::release);
+        bottom_.store(bottom + 1, std::memory_order::relaxed);
+    }
+
+    // Owner only, the newest value
+    [[nodiscard]]
+    auto pop() -> std::optional<T> {
+        auto bottom = bottom_.load(std::memory_order::relaxed) - 1;
+        auto ring = ring_.load(std::memory_order::relaxed);
+        bottom_.store(bottom, std::memory_order::relaxed);
+        std::atomic_thread_fence(std::memory_order::seq_cst);
+        auto top = top_.load(std::memory_order::relaxed);
+        if (top > bottom) {
+            // Empty
+            bottom_.store(bottom + 1, std::memory_order::relaxed);
+            return std::nullopt;
+        }
+        auto value = ring->load(bottom);
+        if (top == bottom) {
+            // The last one, a thief may be taking it
+            auto won = top_.compare_exchange_strong(top,
+                                                    top + 1,
+                                                    std::memory_order::seq_cst,
+                                                    std::memory_order::relaxed);
+            bottom_.store(bottom + 1, std::memory_order::relaxed);
+            if (!won) {
+                return std::nullopt;
+            }
+        }
+        return value;
+    }
+
+    // Any thread, the oldest value. Also empty when losing a race with
+    // another thief or the owner.
+    [[nodiscard]]
+    auto steal() -> std::optional<T> {
+        auto top = top_.load(std::memory_order::acquire);
+        std::atomic_thread_fence(std::memory_order::seq_cst);
+        auto bottom = bottom_.load(std::memory_order::acquire);
+        if (top >= bottom) {
+            return std::nullopt;
+        }
+        auto value = ring_.load(std::memory_order::acquire)->load(top);
+        if (!top_.compare_exchange_strong(top,
+                                          top + 1,
+                                          std::memory_order::seq_cst,
+                                          std::memory_order::relaxed)) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    // A hint while other threads use the deque
+    [[nodiscard]]
+    auto size() const noexcept -> std::size_t {
+        auto bottom = bottom_.load(std::memory_order::relaxed);
+        auto top = top_.load(std::memory_order::relaxed);
+        return bottom > top ? static_cast<std::size_t>(bottom - top) : 0;
+    }
+
+private:
+    auto grow(Ring *ring, int64_t top, int64_t bottom) -> Ring * {
+        auto bigger = std::make_unique<Ring>(ring->capacity() * 2);
+        for (auto i = top; i < bottom; i++) {
+            bigger->store(i, ring->load(i));
+        }
+        rings_.push_back(std::move(bigger));
+        ring_.store(rings_.back().get(), std::memory_order::release);
+        return rings_.back().get();
+    }
+
+private:
+    alignas(CACHE_LINE) std::atomic<int64_t> top_{0};
+    alignas(CACHE_LINE) std::atomic<int64_t> bottom_{0};
+    std::atomic<Ring *> ring_{nullptr};
+    // Owner only, every ring ever used
+    std::vector<std::unique_ptr<Ring>> rings_;
+};
+
+} // namespace uvio::detail
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "uvio/runtime/options.hpp"
+
+#include <cstddef>
+
+#include "uv.h"
+
+namespace uvio {
+
+class Runtime;
+
+namespace time::detail {
+    class TimingWheel;
+} // namespace time::detail
+
+namespace detail {
+    class Worker;
+    class ReadyQueue;
+
+    // Per-thread state of the loop driven by the current thread
+    struct LoopContext {
+        uv_loop_t                       *loop_{nullptr};
+        std::size_t                      worker_id_{0};
+        Worker                          *worker_{nullptr};
+        Runtime                         *runtime_{nullptr};
+        uvio::time::detail::TimingWheel *timers_{nullptr};
+        ReadyQueue                      *ready_{nullptr};
+        const RuntimeOptions            *options_{nullptr};
+    };
+
+    inline thread_local LoopContext *current_context{nullptr};
+} // namespace detail
+
+// The loop driven by the calling thread. Outside of a runtime (e.g. plain
+// libuv code) falls back to the default loop.
+[[nodiscard]]
+static inline auto current_loop() noexcept -> uv_loop_t * {
+    if (uvio::detail::current_context != nullptr) [[likely]] {
+        return uvio::detail::current_context->loop_;
+    }
+    return uv_default_loop();
+}
+
+[[nodiscard]]
+static inline auto current_worker_id() noexcept -> std::size_t {
+    if (uvio::detail::current_context != nullptr) [[likely]] {
+        return uvio::detail::current_context->worker_id_;
+    }
+    return 0;
+}
+
+} // namespace uvio
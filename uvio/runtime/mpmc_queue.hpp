@@ -0,0 +1,120 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <optional>
+#include <utility>
+
+namespace uvio::detail {
+
+// Bounded lock-free multi-producer multi-consumer ring (Vyukov). Every slot
+// carries a sequence number telling whether it is free for the producer of
+// this lap or filled for its consumer, so a push or a pop is a single CAS on
+// its cursor.
+template <typename T>
+class MpmcQueue {
+    struct Slot {
+        std::atomic<std::size_t> sequence_;
+        alignas(T) std::byte storage_[sizeof(T)];
+    };
+
+    constexpr static std::size_t CACHE_LINE{64};
+
+public:
+    // Rounds `capacity` up to a power of two
+    explicit MpmcQueue(std::size_t capacity)
+        : mask_{std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1}
+        , slots_{std::make_unique<Slot[]>(mask_ + 1)} {
+        for (std::size_t i = 0; i <= mask_; i++) {
+            slots_[i].sequence_.store(i, std::memory_order::relaxed);
+        }
+    }
+
+    ~MpmcQueue() {
+        while (try_pop()) {
+        }
+    }
+
+    // No copy, no move
+    MpmcQueue(const MpmcQueue &) = delete;
+    auto operator=(const MpmcQueue &) = delete;
+    MpmcQueue(MpmcQueue &&) = delete;
+    auto operator=(MpmcQueue &&) = delete;
+
+public:
+    // Moves from `value` only if there was room
+    [[nodiscard]]
+    auto try_push(T &&value) -> bool {
+        auto pos = enqueue_pos_.load(std::memory_order::relaxed);
+        while (true) {
+            auto &slot = slots_[pos & mask_];
+            auto  sequence = slot.sequence_.load(std::memory_order::acquire);
+            auto  diff = static_cast<std::ptrdiff_t>(sequence - pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(
+                        pos,
+                        pos + 1,
+                        std::memory_order::relaxed,
+                        std::memory_order::relaxed)) {
+                    std::construct_at(reinterpret_cast<T *>(slot.storage_),
+                                      std::move(value));
+                    slot.sequence_.store(pos + 1, std::memory_order::release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                // Full
+                return false;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order::relaxed);
+            }
+        }
+    }
+
+    [[nodiscard]]
+    auto try_pop() -> std::optional<T> {
+        auto pos = dequeue_pos_.load(std::memory_order::relaxed);
+        while (true) {
+            auto &slot = slots_[pos & mask_];
+            auto  sequence = slot.sequence_.load(std::memory_order::acquire);
+            auto  diff = static_cast<std::ptrdiff_t>(sequence - (pos + 1));
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(
+                        pos,
+                        pos + 1,
+                        std::memory_order::relaxed,
+                        std::memory_order::relaxed)) {
+                    auto value = std::launder(
+                        reinterpret_cast<T *>(slot.storage_));
+                    std::optional<T> result{std::move(*value)};
+                    std::destroy_at(value);
+                    slot.sequence_.store(pos + mask_ + 1,
+                                         std::memory_order::release);
+                    return result;
+                }
+            } else if (diff < 0) {
+                // Empty
+                return std::nullopt;
+            } else {
+                pos = dequeue_pos_.load(std::memory_order::relaxed);
+            }
+        }
+    }
+
+    [[nodiscard]]
+    auto capacity() const noexcept -> std::size_t {
+        return mask_ + 1;
+    }
+
+private:
+    const std::size_t       mask_;
+    std::unique_ptr<Slot[]> slots_;
+    // Producers and consumers do not share cache lines
+    alignas(CACHE_LINE) std::atomic<std::size_t> enqueue_pos_{0};
+    alignas(CACHE_LINE) std::atomic<std::size_t> dequeue_pos_{0};
+};
+
+} // namespace uvio::detail
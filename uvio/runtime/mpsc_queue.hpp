@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace uvio::detail {
+
+// Lock-free multi-producer single-consumer queue. Producers push onto a
+// Treiber stack, the consumer takes the whole stack at once and walks it in
+// push order.
+template <typename T>
+class MpscQueue {
+    struct Node {
+        T     value_;
+        Node *next_;
+    };
+
+public:
+    MpscQueue() = default;
+
+    ~MpscQueue() {
+        consume([](T &&) {});
+    }
+
+    // No copy, no move
+    MpscQueue(const MpscQueue &) = delete;
+    auto operator=(const MpscQueue &) = delete;
+    MpscQueue(MpscQueue &&) = delete;
+    auto operator=(MpscQueue &&) = delete;
+
+public:
+    // Callable from any thread. Returns true if the queue was empty, only
+    // then does the consumer need to be woken up.
+    auto push(T value) -> bool {
+        auto node = new Node{.value_ = std::move(value), .next_ = nullptr};
+        // The node belongs to the consumer once pushed, keep `head` local
+        auto head = head_.load(std::memory_order::relaxed);
+        do {
+            node->next_ = head;
+        } while (!head_.compare_exchange_weak(head,
+                                              node,
+                                              std::memory_order::release,
+                                              std::memory_order::relaxed));
+        return head == nullptr;
+    }
+
+    // Consumer only, calls `func(value)` for every queued value, oldest first
+    template <typename F>
+    auto consume(F &&func) -> std::size_t {
+        auto        node = head_.exchange(nullptr, std::memory_order::acquire);
+        Node       *oldest = nullptr;
+        std::size_t count = 0;
+        while (node != nullptr) {
+            auto next = node->next_;
+            node->next_ = oldest;
+            oldest = node;
+            node = next;
+            count++;
+        }
+        while (oldest != nullptr) {
+            auto next = oldest->next_;
+            func(std::move(oldest->value_));
+            delete oldest;
+            oldest = next;
+        }
+        return count;
+    }
+
+    [[nodiscard]]
+    auto empty() const noexcept -> bool {
+        return head_.load(std::memory_order::relaxed) == nullptr;
+    }
+
+private:
+    std::atomic<Node *> head_{nullptr};
+};
+
+} // namespace uvio::detail
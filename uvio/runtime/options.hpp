@@ -0,0 +1,46 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+namespace uvio {
+
+struct RuntimeOptions {
+    // Queue the tasks of `Runtime::spawn_stealable()` in per-worker deques,
+    // from which idle workers steal
+    bool work_stealing{false};
+    // Spin with `UV_RUN_NOWAIT` for up to this long since the last pass that
+    // resumed a coroutine before blocking in poll, zero to always block. Meant
+    // for workers pinned to dedicated cores, a spinning worker delays the
+    // threads sharing its core.
+    std::chrono::microseconds busy_poll{0};
+    // Pin worker i to CPU `cpus[i % cpus.size()]`, worker 0 pins the thread
+    // calling `block_on()`. Linux only, no pinning when empty.
+    std::vector<int> cpus{};
+    // SO_BUSY_POLL of accepted and connected TCP sockets, Linux only; raising
+    // it above net.core.busy_read needs CAP_NET_ADMIN
+    std::chrono::microseconds socket_busy_poll{0};
+};
+
+// Counters of one worker, see `Runtime::worker_stats()`
+struct WorkerStats {
+    // Tasks queued by `spawn_stealable()` on this worker
+    std::size_t spawned{0};
+    // Queued tasks started by this worker, its own or stolen
+    std::size_t started{0};
+    // Tasks taken from the other workers' deques
+    std::size_t stolen{0};
+    // Attempts to steal that found nothing
+    std::size_t failed_steals{0};
+    // Tasks waiting in the deque, a hint while the runtime runs
+    std::size_t queue_depth{0};
+    std::size_t max_queue_depth{0};
+    // Busy-poll only: time in passes that resumed nothing and in passes that
+    // did, and how often the spin budget ran out and the loop blocked
+    std::chrono::nanoseconds spin_time{0};
+    std::chrono::nanoseconds work_time{0};
+    std::size_t              parks{0};
+};
+
+} // namespace uvio
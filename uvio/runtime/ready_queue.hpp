@@ -0,0 +1,129 @@
+#pragma once
+
+#include "uvio/debug.hpp"
+#include "uvio/runtime/context.hpp"
+
+#include <algorithm>
+#include <coroutine>
+#include <deque>
+
+#include "uv.h"
+
+namespace uvio::detail {
+
+// Awaits a task may complete between two trips through the ready queue, see
+// `consume_budget()`
+constexpr std::size_t TASK_BUDGET{128};
+
+inline thread_local std::size_t task_budget{TASK_BUDGET};
+
+// Coroutines made runnable by libuv callbacks of one loop. The callbacks only
+// push handles; a uv_check_t resumes at most `BUDGET` of them after every
+// poll, and an idle handle keeps the next poll from blocking while some are
+// left, so one busy connection cannot hold the loop for a whole iteration.
+class ReadyQueue {
+public:
+    constexpr static std::size_t BUDGET{128};
+
+public:
+    explicit ReadyQueue(uv_loop_t *loop) {
+        uv_check(uv_check_init(loop, &check_));
+        uv_check(uv_idle_init(loop, &idle_));
+        check_.data = this;
+        uv_check(uv_check_start(&check_, [](uv_check_t *handle) {
+            static_cast<ReadyQueue *>(handle->data)->drain(BUDGET);
+        }));
+        // Only the idle handle, active while handles are queued, keeps the
+        // loop alive
+        uv_unref(reinterpret_cast<uv_handle_t *>(&check_));
+    }
+
+    // No copy, no move (the handles point back to this object)
+    ReadyQueue(const ReadyQueue &) = delete;
+    auto operator=(const ReadyQueue &) = delete;
+    ReadyQueue(ReadyQueue &&) = delete;
+    auto operator=(ReadyQueue &&) = delete;
+
+public:
+    auto push(std::coroutine_handle<> handle) -> void {
+        queue_.push_back(handle);
+        if (uv_is_active(reinterpret_cast<uv_handle_t *>(&idle_)) == 0) {
+            uv_check(uv_idle_start(&idle_, [](uv_idle_t *) {}));
+        }
+    }
+
+    // Resume up to `budget` handles, those queued meanwhile wait for the next
+    // round
+    auto drain(std::size_t budget) -> void {
+        auto count = std::min(budget, queue_.size());
+        for (std::size_t i = 0; i < count; i++) {
+            auto handle = queue_.front();
+            queue_.pop_front();
+            task_budget = TASK_BUDGET;
+            handle.resume();
+        }
+        resumed_ += count;
+        if (queue_.empty()) {
+            uv_check(uv_idle_stop(&idle_));
+        }
+    }
+
+    auto drain_all() -> void {
+        while (!queue_.empty()) {
+            drain(queue_.size());
+        }
+    }
+
+    [[nodiscard]]
+    auto size() const noexcept -> std::size_t {
+        return queue_.size();
+    }
+
+    // Handles resumed so far, tells a busy-polling loop whether a pass did
+    // any work
+    [[nodiscard]]
+    auto resumed() const noexcept -> std::size_t {
+        return resumed_;
+    }
+
+    auto close() -> void {
+        uv_close(reinterpret_cast<uv_handle_t *>(&check_), nullptr);
+        uv_close(reinterpret_cast<uv_handle_t *>(&idle_), nullptr);
+    }
+
+private:
+    uv_check_t                          check_{};
+    uv_idle_t                           idle_{};
+    std::deque<std::coroutine_handle<>> queue_;
+    std::size_t                         resumed_{0};
+};
+
+// Charge one await to the running task. Returns false once the budget is
+// spent, the awaiter must then suspend even if it is ready and go through
+// `schedule()`, so that a task which never blocks (e.g. reading from a full
+// buffer) cannot hold the loop. Never fails outside of a runtime.
+[[nodiscard]]
+static inline auto consume_budget() noexcept -> bool {
+    if (task_budget > 0) [[likely]] {
+        task_budget--;
+        return true;
+    }
+    if (current_context == nullptr || current_context->ready_ == nullptr) {
+        task_budget = TASK_BUDGET;
+        return true;
+    }
+    return false;
+}
+
+// Resume `handle` from the ready queue of the current loop, or right away
+// outside of a runtime
+static inline auto schedule(std::coroutine_handle<> handle) -> void {
+    if (current_context != nullptr && current_context->ready_ != nullptr)
+        [[likely]] {
+        current_context->ready_->push(handle);
+    } else {
+        handle.resume();
+    }
+}
+
+} // namespace uvio::detail
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace uvio::detail {
+
+// Unbounded lock-free single-producer single-consumer queue of small
+// trivially copyable values. Values are stored in fixed-size segments: the
+// producer publishes each one with a release store of the segment's count,
+// and only allocates when a segment is full.
+template <typename T>
+class SpscQueue {
+    constexpr static std::size_t SEGMENT_SIZE{64};
+    constexpr static std::size_t CACHE_LINE{64};
+
+    struct Segment {
+        std::array<T, SEGMENT_SIZE> values_;
+        std::atomic<std::size_t>    count_{0};
+        std::atomic<Segment *>      next_{nullptr};
+    };
+
+public:
+    SpscQueue()
+        : head_{new Segment}
+        , tail_{head_} {}
+
+    ~SpscQueue() {
+        while (head_ != nullptr) {
+            delete std::exchange(head_,
+                                 head_->next_.load(std::memory_order::relaxed));
+        }
+    }
+
+    // No copy, no move
+    SpscQueue(const SpscQueue &) = delete;
+    auto operator=(const SpscQueue &) = delete;
+    SpscQueue(SpscQueue &&) = delete;
+    auto operator=(SpscQueue &&) = delete;
+
+public:
+    // Producer only
+    auto push(T value) -> void {
+        auto count = tail_->count_.load(std::memory_order::relaxed);
+        if (count == SEGMENT_SIZE) [[unlikely]] {
+            auto segment = new Segment;
+            segment->values_[0] = value;
+            segment->count_.store(1, std::memory_order::relaxed);
+            // The consumer frees the full segment once it moved on
+            tail_->next_.store(segment, std::memory_order::release);
+            tail_ = segment;
+            return;
+        }
+        tail_->values_[count] = value;
+        tail_->count_.store(count + 1, std::memory_order::release);
+    }
+
+    // Consumer only, calls `func(value)` for every queued value, oldest first
+    template <typename F>
+    auto consume(F &&func) -> std::size_t {
+        std::size_t consumed = 0;
+        while (true) {
+            auto count = head_->count_.load(std::memory_order::acquire);
+            while (read_ < count) {
+                func(head_->values_[read_++]);
+                consumed++;
+            }
+            if (read_ < SEGMENT_SIZE) {
+                return consumed;
+            }
+            auto next = head_->next_.load(std::memory_order::acquire);
+            if (next == nullptr) {
+                return consumed;
+            }
+            delete std::exchange(head_, next);
+            read_ = 0;
+        }
+    }
+
+private:
+    // Consumer side
+    alignas(CACHE_LINE) Segment *head_;
+    std::size_t read_{0};
+    // Producer side
+    alignas(CACHE_LINE) Segment *tail_;
+};
+
+} // namespace uvio::detail
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "uvio/coroutine/task.hpp"
+#include "uvio/runtime/worker.hpp"
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+
+namespace uvio::detail {
+
+// Sends the task to the target worker through the submitting worker's
+// mailbox there, and is resumed once the task came back the same way
+template <typename T>
+class SubmitAwaiter : Submission {
+public:
+    SubmitAwaiter(Worker *from, Worker *to, Task<T> &&task)
+        : from_{from}
+        , to_{to}
+        , task_{std::move(task)} {}
+
+    auto await_ready() const noexcept -> bool {
+        return false;
+    }
+
+    auto await_suspend(std::coroutine_handle<> handle) -> void {
+        caller_ = handle;
+        // Until the task comes back
+        from_->hold();
+        runner_ = run(this).take();
+        to_->submit(from_->id(), this);
+    }
+
+    auto await_resume() -> T {
+        if (exception_) [[unlikely]] {
+            std::rethrow_exception(exception_);
+        }
+        if constexpr (!std::is_void_v<T>) {
+            return std::move(*value_);
+        }
+    }
+
+private:
+    // On the target loop
+    static auto run(SubmitAwaiter *self) -> Task<> {
+        try {
+            if constexpr (std::is_void_v<T>) {
+                co_await self->task_;
+            } else {
+                self->value_.emplace(co_await self->task_);
+            }
+        } catch (...) {
+            // Rethrown on the submitting loop
+            self->exception_ = std::current_exception();
+        }
+        self->done_ = true;
+        // Last use of `self`, the submitting loop may resume the caller at once
+        self->from_->submit(self->to_->id(), self);
+    }
+
+private:
+    Worker *from_;
+    Worker *to_;
+    Task<T> task_;
+    // Unused for `Task<void>`
+    std::optional<std::conditional_t<std::is_void_v<T>, bool, T>> value_{};
+    std::exception_ptr                                            exception_{};
+};
+
+} // namespace uvio::detail
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "uvio/runtime/context.hpp"
+#include "uvio/runtime/ready_queue.hpp"
+#include "uvio/runtime/worker.hpp"
+
+#include <coroutine>
+#include <utility>
+
+namespace uvio::detail {
+
+// Resumes a suspended coroutine on the loop it was suspended on, from any
+// thread. Obtained by the awaiter with `Waker::current()` before suspending,
+// the loop is kept running until `wake()` is called (exactly once).
+class Waker {
+public:
+    Waker() = default;
+
+    [[nodiscard]]
+    static auto current(std::coroutine_handle<> handle) noexcept -> Waker {
+        Waker waker;
+        waker.handle_ = handle;
+        if (current_context != nullptr) [[likely]] {
+            waker.worker_ = current_context->worker_;
+            waker.worker_->hold();
+        }
+        return waker;
+    }
+
+public:
+    auto wake() const -> void {
+        if (worker_ == nullptr) [[unlikely]] {
+            // Not on a runtime, nowhere to send it to
+            handle_.resume();
+        } else if (current_context == worker_->context()) {
+            current_context->ready_->push(handle_);
+            worker_->release();
+        } else {
+            worker_->post(handle_, true);
+        }
+    }
+
+    // Instead of `wake()`, on the loop that obtained the waker, when the
+    // coroutine did not suspend after all
+    auto forget() -> void {
+        if (worker_ != nullptr) {
+            std::exchange(worker_, nullptr)->release();
+        }
+    }
+
+private:
+    std::coroutine_handle<> handle_{nullptr};
+    Worker                 *worker_{nullptr};
+};
+
+} // namespace uvio::detail
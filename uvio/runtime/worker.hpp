@@ -0,0 +1,455 @@
+#pragma once
+
+#include "uvio/debug.hpp"
+#include "uvio/runtime/chase_lev_deque.hpp"
+#include "uvio/runtime/context.hpp"
+#include "uvio/runtime/mpsc_queue.hpp"
+#include "uvio/runtime/options.hpp"
+#include "uvio/runtime/ready_queue.hpp"
+#include "uvio/runtime/spsc_queue.hpp"
+#include "uvio/time/timing_wheel.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "uv.h"
+
+namespace uvio::detail {
+
+// A task sent to another worker by `Runtime::submit_to()`, which comes back
+// to the submitting worker once done
+struct Submission {
+    // Started on the target loop
+    std::coroutine_handle<> runner_{nullptr};
+    // Resumed on the submitting loop
+    std::coroutine_handle<> caller_{nullptr};
+    bool                    done_{false};
+};
+
+// One event loop and the lock-free inbox used to hand coroutines over to it.
+// Worker 0 drives `uv_default_loop()` on the thread calling `block_on`, so
+// plain libuv code keeps working; the others own a private loop each.
+class Worker {
+public:
+    Worker(std::size_t id, Runtime *runtime)
+        : id_{id} {
+        if (id_ == 0) {
+            loop_ = uv_default_loop();
+        } else {
+            owned_loop_ = std::make_unique<uv_loop_t>();
+            uv_check(uv_loop_init(owned_loop_.get()));
+            loop_ = owned_loop_.get();
+        }
+        timers_ = std::make_unique<uvio::time::detail::TimingWheel>(loop_);
+        ready_ = std::make_unique<ReadyQueue>(loop_);
+        context_ = LoopContext{
+            .loop_ = loop_,
+            .worker_id_ = id_,
+            .worker_ = this,
+            .runtime_ = runtime,
+            .timers_ = timers_.get(),
+            .ready_ = ready_.get(),
+        };
+
+        notifier_.data = this;
+        uv_check(uv_async_init(loop_, &notifier_, [](uv_async_t *handle) {
+            static_cast<Worker *>(handle->data)->on_notified();
+        }));
+        if (id_ == 0) {
+            // The main loop lives as long as it has real work to do
+            uv_unref(reinterpret_cast<uv_handle_t *>(&notifier_));
+        }
+    }
+
+    // No copy
+    Worker(const Worker &) = delete;
+    auto operator=(const Worker &) = delete;
+    // No move (libuv handles point back to this object)
+    Worker(Worker &&) = delete;
+    auto operator=(Worker &&) = delete;
+
+    ~Worker() = default;
+
+public:
+    // Resume `handle` on this worker's loop, callable from any thread. Only
+    // the post finding the inbox empty signals the loop, the others are
+    // picked up by the same wake-up. `held` releases a `hold()` once queued.
+    auto post(std::coroutine_handle<> handle, bool held = false) -> void {
+        if (inbox_.push(Wakeup{.handle_ = handle, .held_ = held})) {
+            uv_check(uv_async_send(&notifier_));
+        }
+    }
+
+    // Called by the runtime with every worker, before any of them runs. One
+    // mailbox per worker submitting tasks to this one, so every mailbox has a
+    // single producer and a single consumer.
+    auto connect(const std::vector<std::unique_ptr<Worker>> &workers,
+                 const RuntimeOptions                       &options) -> void {
+        mailboxes_.reserve(workers.size());
+        for (std::size_t i = 0; i < workers.size(); i++) {
+            mailboxes_.emplace_back(
+                std::make_unique<SpscQueue<Submission *>>());
+        }
+        context_.options_ = &options;
+        busy_poll_ = options.busy_poll;
+        if (!options.cpus.empty()) {
+            cpu_ = options.cpus[id_ % options.cpus.size()];
+        }
+        if (!options.work_stealing) {
+            return;
+        }
+
+        // Victims in order, starting with the next worker
+        for (std::size_t i = 1; i < workers.size(); i++) {
+            peers_.push_back(workers[(id_ + i) % workers.size()].get());
+        }
+        tasks_ = std::make_unique<ChaseLevDeque<void *>>();
+        prepare_.data = this;
+        uv_check(uv_prepare_init(loop_, &prepare_));
+        uv_check(uv_prepare_start(&prepare_, [](uv_prepare_t *handle) {
+            static_cast<Worker *>(handle->data)->find_tasks();
+        }));
+        // Only keeps the loop alive while tasks are queued
+        uv_unref(reinterpret_cast<uv_handle_t *>(&prepare_));
+    }
+
+    // Queue a task that has not started yet, to be started by this worker or
+    // stolen by an idle one. Loop thread only, with work stealing on.
+    auto push_task(std::coroutine_handle<> handle) -> void {
+        tasks_->push(handle.address());
+        bump(counters_.spawned_);
+        auto &max_depth = counters_.max_queue_depth_;
+        auto  depth = tasks_->size();
+        if (depth > max_depth.load(std::memory_order::relaxed)) {
+            max_depth.store(depth, std::memory_order::relaxed);
+        }
+        uv_ref(reinterpret_cast<uv_handle_t *>(&prepare_));
+        wake_sleeper();
+    }
+
+    [[nodiscard]]
+    auto stats() const noexcept -> WorkerStats {
+        return WorkerStats{
+            .spawned = counters_.spawned_.load(std::memory_order::relaxed),
+            .started = counters_.started_.load(std::memory_order::relaxed),
+            .stolen = counters_.stolen_.load(std::memory_order::relaxed),
+            .failed_steals
+            = counters_.failed_steals_.load(std::memory_order::relaxed),
+            .queue_depth = tasks_ != nullptr ? tasks_->size() : 0,
+            .max_queue_depth
+            = counters_.max_queue_depth_.load(std::memory_order::relaxed),
+            .spin_time = std::chrono::nanoseconds{static_cast<int64_t>(
+                counters_.spin_ns_.load(std::memory_order::relaxed))},
+            .work_time = std::chrono::nanoseconds{static_cast<int64_t>(
+                counters_.work_ns_.load(std::memory_order::relaxed))},
+            .parks = counters_.parks_.load(std::memory_order::relaxed),
+        };
+    }
+
+    // From the loop of worker `from` only: start a submission on this loop,
+    // or hand a finished one back. Repeated signals are coalesced by libuv,
+    // submissions from this very loop skip the mailbox.
+    auto submit(std::size_t from, Submission *submission) -> void {
+        if (from == id_) {
+            receive(submission);
+            return;
+        }
+        mailboxes_[from]->push(submission);
+        uv_check(uv_async_send(&notifier_));
+    }
+
+    // Keep the loop running until the matching `release()` although nothing
+    // but another thread can make progress, e.g. a coroutine waiting for a
+    // `Waker`. Loop thread only, the other loops run until `shutdown()`.
+    auto hold() -> void {
+        if (holds_++ == 0 && id_ == 0) {
+            uv_ref(reinterpret_cast<uv_handle_t *>(&notifier_));
+        }
+    }
+
+    auto release() -> void {
+        if (--holds_ == 0 && id_ == 0) {
+            uv_unref(reinterpret_cast<uv_handle_t *>(&notifier_));
+        }
+    }
+
+    // Ask the loop to exit once its remaining work is done, callable from any
+    // thread
+    auto shutdown() -> void {
+        stop_requested_.store(true, std::memory_order::release);
+        uv_check(uv_async_send(&notifier_));
+    }
+
+    auto run() -> void {
+        auto prev = current_context;
+        current_context = &context_;
+        pin_thread();
+        if (busy_poll_.count() > 0) {
+            run_busy_poll();
+        } else {
+            uv_run(loop_, UV_RUN_DEFAULT);
+        }
+        current_context = prev;
+    }
+
+    // Release the loop, must be called after `run()` once nobody posts to this
+    // worker anymore
+    auto close() -> void {
+        auto prev = current_context;
+        current_context = &context_;
+
+        drain_inbox();
+        drain_mailboxes();
+        if (tasks_ != nullptr) {
+            while (auto task = tasks_->pop()) {
+                start(std::coroutine_handle<>::from_address(*task));
+            }
+            uv_close(reinterpret_cast<uv_handle_t *>(&prepare_), nullptr);
+        }
+        ready_->drain_all();
+        if (uv_is_closing(reinterpret_cast<uv_handle_t *>(&notifier_)) == 0) {
+            uv_close(reinterpret_cast<uv_handle_t *>(&notifier_), nullptr);
+        }
+        timers_->close();
+        ready_->close();
+        uv_run(loop_, UV_RUN_DEFAULT);
+        uv_loop_close(loop_);
+
+        current_context = prev;
+    }
+
+    [[nodiscard]]
+    auto id() const noexcept -> std::size_t {
+        return id_;
+    }
+
+    [[nodiscard]]
+    auto loop() const noexcept -> uv_loop_t * {
+        return loop_;
+    }
+
+    [[nodiscard]]
+    auto context() noexcept -> LoopContext * {
+        return &context_;
+    }
+
+private:
+    // Spin on the loop without blocking while it keeps resuming coroutines,
+    // and for `busy_poll_` after that, saving the wake-up latency of poll
+    auto run_busy_poll() -> void {
+        using Clock = std::chrono::steady_clock;
+        auto now = Clock::now();
+        auto last_work = now;
+        while (true) {
+            auto resumed = ready_->resumed();
+            auto alive = uv_run(loop_, UV_RUN_NOWAIT) != 0;
+            auto end = Clock::now();
+            auto elapsed = static_cast<std::size_t>(
+                std::chrono::nanoseconds{end - now}.count());
+            if (ready_->resumed() != resumed) {
+                bump(counters_.work_ns_, elapsed);
+                last_work = end;
+            } else {
+                bump(counters_.spin_ns_, elapsed);
+            }
+            now = end;
+            if (!alive) {
+                break;
+            }
+            if (now - last_work >= busy_poll_) {
+                // Out of spin budget, block until the next event
+                bump(counters_.parks_);
+                if (uv_run(loop_, UV_RUN_ONCE) == 0) {
+                    break;
+                }
+                now = Clock::now();
+                last_work = now;
+            }
+        }
+    }
+
+    auto pin_thread() -> void {
+        if (cpu_ < 0) {
+            return;
+        }
+#if defined(__linux__)
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu_, &cpus);
+        if (auto ret
+            = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+            ret != 0) {
+            LOG_WARN("pin worker {} to cpu {} failed: {}",
+                     id_,
+                     cpu_,
+                     std::strerror(ret));
+        }
+#endif
+    }
+
+    auto on_notified() -> void {
+        drain_inbox();
+        drain_mailboxes();
+        if (stop_requested_.load(std::memory_order::acquire)
+            && uv_is_closing(reinterpret_cast<uv_handle_t *>(&notifier_))
+                   == 0) {
+            uv_close(reinterpret_cast<uv_handle_t *>(&notifier_), nullptr);
+        }
+    }
+
+    auto drain_inbox() -> void {
+        inbox_.consume([this](Wakeup wakeup) {
+            ready_->push(wakeup.handle_);
+            if (wakeup.held_) {
+                release();
+            }
+        });
+    }
+
+    auto drain_mailboxes() -> void {
+        for (auto &mailbox : mailboxes_) {
+            mailbox->consume(
+                [this](Submission *submission) { receive(submission); });
+        }
+    }
+
+    auto receive(Submission *submission) -> void {
+        if (submission->done_) {
+            // Back home, releases the `hold()` of `submit_to()`
+            ready_->push(submission->caller_);
+            release();
+        } else {
+            ready_->push(submission->runner_);
+        }
+    }
+
+    // Before every poll: start a few queued tasks, or steal one when there is
+    // nothing else to run, or tell the other workers that this one sleeps
+    auto find_tasks() -> void {
+        if (sleeping_.load(std::memory_order::relaxed)) {
+            sleeping_.store(false, std::memory_order::relaxed);
+        }
+
+        // Newest first, while they are hot in cache. With other tasks
+        // runnable only one, leaving the rest to the thieves.
+        auto batch = ready_->size() == 0 ? LOCAL_BATCH : 1;
+        for (std::size_t i = 0; i < batch; i++) {
+            auto task = tasks_->pop();
+            if (!task.has_value()) {
+                break;
+            }
+            start(std::coroutine_handle<>::from_address(*task));
+        }
+        if (tasks_->size() == 0) {
+            uv_unref(reinterpret_cast<uv_handle_t *>(&prepare_));
+        }
+        if (ready_->size() > 0 || try_steal()) {
+            return;
+        }
+
+        // Pairs with the fence in `wake_sleeper()`: either a peer queuing a
+        // task sees this worker sleeping, or it sees the task
+        sleeping_.store(true, std::memory_order::relaxed);
+        std::atomic_thread_fence(std::memory_order::seq_cst);
+        if (try_steal()) {
+            sleeping_.store(false, std::memory_order::relaxed);
+        }
+    }
+
+    auto try_steal() -> bool {
+        for (auto peer : peers_) {
+            if (peer->tasks_->size() == 0) {
+                continue;
+            }
+            if (auto task = peer->tasks_->steal()) {
+                bump(counters_.stolen_);
+                start(std::coroutine_handle<>::from_address(*task));
+                return true;
+            }
+        }
+        bump(counters_.failed_steals_);
+        return false;
+    }
+
+    auto wake_sleeper() -> void {
+        std::atomic_thread_fence(std::memory_order::seq_cst);
+        for (auto peer : peers_) {
+            auto &sleeping = peer->sleeping_;
+            if (sleeping.load(std::memory_order::relaxed)
+                && sleeping.exchange(false, std::memory_order::relaxed)) {
+                uv_check(uv_async_send(&peer->notifier_));
+                return;
+            }
+        }
+    }
+
+    auto start(std::coroutine_handle<> task) -> void {
+        bump(counters_.started_);
+        ready_->push(task);
+    }
+
+    // Owner only, so no read-modify-write
+    static auto bump(std::atomic<std::size_t> &counter,
+                     std::size_t               amount = 1) noexcept -> void {
+        counter.store(counter.load(std::memory_order::relaxed) + amount,
+                      std::memory_order::relaxed);
+    }
+
+private:
+    struct Wakeup {
+        std::coroutine_handle<> handle_;
+        bool                    held_;
+    };
+
+private:
+    std::size_t                id_;
+    uv_loop_t                 *loop_{nullptr};
+    std::unique_ptr<uv_loop_t> owned_loop_;
+    LoopContext                context_{};
+    uv_async_t                 notifier_{};
+    MpscQueue<Wakeup>          inbox_;
+    std::size_t                holds_{0};
+    std::atomic<bool>          stop_requested_{false};
+
+    // Timers and runnable coroutines of the tasks running on this loop
+    std::unique_ptr<uvio::time::detail::TimingWheel> timers_;
+    std::unique_ptr<ReadyQueue>                      ready_;
+
+    // Submissions from every worker, indexed by the submitting worker
+    std::vector<std::unique_ptr<SpscQueue<Submission *>>> mailboxes_;
+
+    // Work stealing only: tasks not started yet, the other workers in the
+    // order they are robbed, and whether this one is about to block in poll
+    constexpr static std::size_t           LOCAL_BATCH{16};
+    std::unique_ptr<ChaseLevDeque<void *>> tasks_;
+    std::vector<Worker *>                  peers_;
+    uv_prepare_t                           prepare_{};
+    std::atomic<bool>                      sleeping_{false};
+
+    // Written by the loop only, read by `stats()` from any thread
+    struct {
+        std::atomic<std::size_t> spawned_{0};
+        std::atomic<std::size_t> started_{0};
+        std::atomic<std::size_t> stolen_{0};
+        std::atomic<std::size_t> failed_steals_{0};
+        std::atomic<std::size_t> max_queue_depth_{0};
+        std::atomic<std::size_t> spin_ns_{0};
+        std::atomic<std::size_t> work_ns_{0};
+        std::atomic<std::size_t> parks_{0};
+    } counters_;
+
+    // Spin budget, zero to block in poll, and the CPU to pin to, -1 for none
+    std::chrono::microseconds busy_poll_{0};
+    int                       cpu_{-1};
+};
+
+} // namespace uvio::detail
@@ -1,3 +1,9 @@
 #pragma once
 
+#include "uvio/sync/broadcast.hpp"
+#include "uvio/sync/channel.hpp"
 #include "uvio/sync/latch.hpp"
+#include "uvio/sync/mutex.hpp"
+#include "uvio/sync/oneshot.hpp"
+#include "uvio/sync/rwlock.hpp"
+#include "uvio/sync/semaphore.hpp"
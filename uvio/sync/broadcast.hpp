@@ -0,0 +1,317 @@
+#pragma once
+
+#include "uvio/common/result.hpp"
+#include "uvio/coroutine/task.hpp"
+#include "uvio/macros.hpp"
+#include "uvio/sync/wait_list.hpp"
+
+#include <cassert>
+#include <coroutine>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace uvio::sync {
+
+namespace detail {
+
+    // The last `capacity` values sent, every receiver reads them at its own
+    // position. Senders never wait: a receiver that falls more than
+    // `capacity` values behind skips to the oldest one still kept. The wait
+    // list's lock guards everything, each value is copied out under it.
+    template <typename T>
+    class Broadcast {
+    public:
+        struct RecvAwaiter : Waiter {
+            Broadcast                *broadcast_;
+            uint64_t                 *position_;
+            std::optional<Result<T>> result_{std::nullopt};
+            CancellationRegistration cancellation_;
+
+            RecvAwaiter(Broadcast *broadcast, uint64_t *position)
+                : broadcast_{broadcast}
+                , position_{position} {}
+
+            auto await_ready() -> bool {
+                auto lock = broadcast_->lock();
+                return broadcast_->poll(*position_, result_);
+            }
+
+            template <typename Promise>
+            auto await_suspend(std::coroutine_handle<Promise> handle) -> bool {
+                if (!cancellation_.register_callback(
+                        uvio::detail::cancellation_token_of(handle),
+                        on_cancel,
+                        this)) {
+                    result_.emplace(
+                        unexpected{make_uvio_error(Error::Cancelled)});
+                    return false;
+                }
+                auto lock = broadcast_->lock();
+                if (broadcast_->poll(*position_, result_)) {
+                    return false;
+                }
+                broadcast_->waiters_.push(this, handle);
+                return true;
+            }
+
+            [[nodiscard]]
+            auto await_resume() -> Result<T> {
+                cancellation_.reset();
+                if (!result_.has_value()) {
+                    // Woken up by a send or by the close
+                    auto lock = broadcast_->lock();
+                    broadcast_->poll(*position_, result_);
+                }
+                return std::move(*result_);
+            }
+
+            // On the loop of the receiver, unless a send is already waking
+            // it up. Its position is kept, nothing is skipped.
+            static auto on_cancel(void *data) -> void {
+                auto self = static_cast<RecvAwaiter *>(data);
+                {
+                    auto lock = self->broadcast_->lock();
+                    if (!self->broadcast_->waiters_.remove(self)) {
+                        return;
+                    }
+                }
+                self->result_.emplace(
+                    unexpected{make_uvio_error(Error::Cancelled)});
+                self->waker_.wake();
+            }
+        };
+
+    public:
+        explicit Broadcast(std::size_t capacity)
+            : values_(capacity) {}
+
+    public:
+        auto send(T &&value) -> Result<void> {
+            Waiter *waiters{nullptr};
+            {
+                auto lock = waiters_.lock();
+                if (num_receivers_ == 0) {
+                    return unexpected{make_uvio_error(Error::ChannelClosed)};
+                }
+                values_[tail_ % values_.size()].emplace(std::move(value));
+                tail_++;
+                waiters = waiters_.pop_all();
+            }
+            WaitList::wake(waiters);
+            return {};
+        }
+
+        // The position of a new receiver
+        auto subscribe() -> uint64_t {
+            auto lock = waiters_.lock();
+            num_receivers_++;
+            return tail_;
+        }
+
+        auto unsubscribe() -> void {
+            auto lock = waiters_.lock();
+            num_receivers_--;
+        }
+
+        auto add_sender() -> void {
+            auto lock = waiters_.lock();
+            num_senders_++;
+        }
+
+        auto drop_sender() -> void {
+            Waiter *waiters{nullptr};
+            {
+                auto lock = waiters_.lock();
+                if (--num_senders_ > 0) {
+                    return;
+                }
+                closed_ = true;
+                waiters = waiters_.pop_all();
+            }
+            WaitList::wake(waiters);
+        }
+
+        // With the lock held. True once `result` holds the value at
+        // `position`, or why there is none.
+        auto poll(uint64_t &position, std::optional<Result<T>> &result)
+            -> bool {
+            if (position < tail_) {
+                if (tail_ - position > values_.size()) {
+                    // Overwritten, resume with the oldest value kept
+                    position = tail_ - values_.size();
+                    result.emplace(
+                        unexpected{make_uvio_error(Error::ChannelLagged)});
+                } else {
+                    result.emplace(*values_[position % values_.size()]);
+                    position++;
+                }
+                return true;
+            }
+            if (closed_) {
+                result.emplace(
+                    unexpected{make_uvio_error(Error::ChannelClosed)});
+                return true;
+            }
+            return false;
+        }
+
+        auto lock() -> std::unique_lock<std::mutex> {
+            return waiters_.lock();
+        }
+
+    private:
+        std::vector<std::optional<T>> values_;
+        // Position of the next value sent
+        uint64_t                      tail_{0};
+        std::size_t                   num_senders_{1};
+        std::size_t                   num_receivers_{1};
+        bool                          closed_{false};
+        WaitList                      waiters_;
+    };
+
+} // namespace detail
+
+template <typename T>
+class BroadcastReceiver;
+
+// Sending half of a broadcast channel, copy it for more producers. The
+// channel closes when the last sender is gone.
+template <typename T>
+class BroadcastSender {
+public:
+    explicit BroadcastSender(std::shared_ptr<detail::Broadcast<T>> broadcast)
+        : broadcast_{std::move(broadcast)} {}
+
+    ~BroadcastSender() {
+        reset();
+    }
+
+    BroadcastSender(const BroadcastSender &other)
+        : broadcast_{other.broadcast_} {
+        if (broadcast_ != nullptr) {
+            broadcast_->add_sender();
+        }
+    }
+
+    auto operator=(const BroadcastSender &other) -> BroadcastSender & {
+        if (std::addressof(other) != this) [[likely]] {
+            reset();
+            broadcast_ = other.broadcast_;
+            if (broadcast_ != nullptr) {
+                broadcast_->add_sender();
+            }
+        }
+        return *this;
+    }
+
+    BroadcastSender(BroadcastSender &&other) noexcept
+        : broadcast_{std::move(other.broadcast_)} {}
+
+    auto operator=(BroadcastSender &&other) noexcept -> BroadcastSender & {
+        if (std::addressof(other) != this) [[likely]] {
+            reset();
+            broadcast_ = std::move(other.broadcast_);
+        }
+        return *this;
+    }
+
+public:
+    // To every receiver, never waits. Fails if there is no receiver.
+    auto send(T value) -> Result<void> {
+        return broadcast_->send(std::move(value));
+    }
+
+    // A new receiver, getting the values sent from now on
+    [[nodiscard]]
+    auto subscribe() -> BroadcastReceiver<T> {
+        auto position = broadcast_->subscribe();
+        return BroadcastReceiver<T>{broadcast_, position};
+    }
+
+private:
+    auto reset() -> void {
+        if (broadcast_ != nullptr) {
+            broadcast_->drop_sender();
+            broadcast_.reset();
+        }
+    }
+
+private:
+    std::shared_ptr<detail::Broadcast<T>> broadcast_;
+};
+
+// Receiving half of a broadcast channel, gets a copy of every value
+template <typename T>
+class BroadcastReceiver {
+public:
+    BroadcastReceiver(std::shared_ptr<detail::Broadcast<T>> broadcast,
+                      uint64_t                              position)
+        : broadcast_{std::move(broadcast)}
+        , position_{position} {}
+
+    ~BroadcastReceiver() {
+        if (broadcast_ != nullptr) {
+            broadcast_->unsubscribe();
+        }
+    }
+
+    BroadcastReceiver(BroadcastReceiver &&other) noexcept = default;
+
+    auto operator=(BroadcastReceiver &&other) noexcept -> BroadcastReceiver & {
+        if (std::addressof(other) != this) [[likely]] {
+            if (broadcast_ != nullptr) {
+                broadcast_->unsubscribe();
+            }
+            broadcast_ = std::move(other.broadcast_);
+            position_ = other.position_;
+        }
+        return *this;
+    }
+
+    // No copy
+    BroadcastReceiver(const BroadcastReceiver &) = delete;
+    auto operator=(const BroadcastReceiver &) = delete;
+
+public:
+    // `Result<T> ret = co_await receiver.recv();`. Fails with
+    // `Error::ChannelLagged` once after values were skipped, and with
+    // `Error::ChannelClosed` once the senders are gone and every value kept
+    // was received.
+    [[REMEMBER_CO_AWAIT]]
+    auto recv() {
+        return typename detail::Broadcast<T>::RecvAwaiter{broadcast_.get(),
+                                                         &position_};
+    }
+
+    [[nodiscard]]
+    auto try_recv() -> Result<T> {
+        std::optional<Result<T>> result;
+        auto                     lock = broadcast_->lock();
+        if (!broadcast_->poll(position_, result)) {
+            return unexpected{make_uvio_error(Error::ChannelEmpty)};
+        }
+        return std::move(*result);
+    }
+
+private:
+    std::shared_ptr<detail::Broadcast<T>> broadcast_;
+    uint64_t                              position_;
+};
+
+// Multi-producer multi-consumer channel, every receiver gets every value
+// sent after it subscribed. Keeps the last `capacity` values for the
+// receivers lagging behind. Usable across loops.
+template <typename T>
+[[nodiscard]]
+static inline auto broadcast(std::size_t capacity)
+    -> std::pair<BroadcastSender<T>, BroadcastReceiver<T>> {
+    assert(capacity > 0);
+    auto shared = std::make_shared<detail::Broadcast<T>>(capacity);
+    return {BroadcastSender<T>{shared}, BroadcastReceiver<T>{shared, 0}};
+}
+
+} // namespace uvio::sync
@@ -0,0 +1,543 @@
+#pragma once
+
+#include "uvio/common/result.hpp"
+#include "uvio/coroutine/task.hpp"
+#include "uvio/macros.hpp"
+#include "uvio/runtime/mpmc_queue.hpp"
+#include "uvio/runtime/mpsc_queue.hpp"
+#include "uvio/sync/wait_list.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace uvio::sync {
+
+namespace detail {
+
+    // State shared by the senders and the receiver of a channel. Values go
+    // through a lock-free queue: a ring for a bounded channel, a linked queue
+    // drained in batches for an unbounded one. A bounded channel counts its
+    // free slots like a `Semaphore`, a sender takes one before pushing and
+    // waits for the receiver to free one when there is none.
+    template <typename T, bool bounded>
+    class Channel {
+        // Free slots are counted from bit 1 on, never more than zero while a
+        // sender waits
+        constexpr static uint64_t WAITERS{1};
+        constexpr static uint64_t SLOT{2};
+
+        using Queue = std::conditional_t<bounded,
+                                         uvio::detail::MpmcQueue<T>,
+                                         uvio::detail::MpscQueue<T>>;
+
+    public:
+        struct SendAwaiter : Waiter {
+            Channel                 *channel_;
+            T                        value_;
+            bool                     cancelled_{false};
+            CancellationRegistration cancellation_;
+
+            SendAwaiter(Channel *channel, T &&value)
+                : channel_{channel}
+                , value_{std::move(value)} {}
+
+            auto await_ready() const noexcept -> bool {
+                if constexpr (bounded) {
+                    return channel_->is_closed() || channel_->try_reserve();
+                } else {
+                    return true;
+                }
+            }
+
+            template <typename Promise>
+            auto await_suspend(std::coroutine_handle<Promise> handle) -> bool {
+                if (!cancellation_.register_callback(
+                        uvio::detail::cancellation_token_of(handle),
+                        on_cancel,
+                        this)) {
+                    cancelled_ = true;
+                    return false;
+                }
+                return channel_->wait_for_slot(this, handle);
+            }
+
+            [[nodiscard]]
+            auto await_resume() -> Result<void> {
+                cancellation_.reset();
+                if (cancelled_) {
+                    return unexpected{make_uvio_error(Error::Cancelled)};
+                }
+                if (channel_->is_closed()) {
+                    return unexpected{make_uvio_error(Error::ChannelClosed)};
+                }
+                channel_->push(std::move(value_));
+                return {};
+            }
+
+            // On the loop of the sender. One already handed a slot keeps it.
+            static auto on_cancel(void *data) -> void {
+                auto self = static_cast<SendAwaiter *>(data);
+                if (self->channel_->cancel_sender(self)) {
+                    self->cancelled_ = true;
+                    self->waker_.wake();
+                }
+            }
+        };
+
+        struct RecvAwaiter : Waiter {
+            Channel                 *channel_;
+            std::optional<T>         value_{std::nullopt};
+            bool                     cancelled_{false};
+            CancellationRegistration cancellation_;
+
+            RecvAwaiter(Channel *channel)
+                : channel_{channel} {}
+
+            auto await_ready() -> bool {
+                return channel_->poll(value_);
+            }
+
+            template <typename Promise>
+            auto await_suspend(std::coroutine_handle<Promise> handle) -> bool {
+                if (!cancellation_.register_callback(
+                        uvio::detail::cancellation_token_of(handle),
+                        on_cancel,
+                        this)) {
+                    cancelled_ = true;
+                    return false;
+                }
+                waker_ = uvio::detail::Waker::current(handle);
+                channel_->park(this);
+                if (channel_->poll(value_) && channel_->unpark(this)) {
+                    waker_.forget();
+                    return false;
+                }
+                // Otherwise a sender is waking us up already
+                return true;
+            }
+
+            [[nodiscard]]
+            auto await_resume() -> Result<T> {
+                cancellation_.reset();
+                if (cancelled_) {
+                    return unexpected{make_uvio_error(Error::Cancelled)};
+                }
+                if (!value_.has_value()) {
+                    // Woken up by a push or by the close
+                    channel_->poll(value_);
+                }
+                if (value_.has_value()) {
+                    return std::move(*value_);
+                }
+                return unexpected{make_uvio_error(Error::ChannelClosed)};
+            }
+
+            // On the loop of the receiver, unless a sender is already waking
+            // it up. A value sent meanwhile stays queued.
+            static auto on_cancel(void *data) -> void {
+                auto self = static_cast<RecvAwaiter *>(data);
+                if (self->channel_->unpark(self)) {
+                    self->cancelled_ = true;
+                    self->waker_.wake();
+                }
+            }
+        };
+
+    public:
+        explicit Channel(std::size_t capacity)
+            requires bounded
+            : queue_{capacity}
+            , slots_{capacity * SLOT} {}
+
+        Channel()
+            requires(!bounded)
+        = default;
+
+        // No copy, no move
+        Channel(const Channel &) = delete;
+        auto operator=(const Channel &) = delete;
+        Channel(Channel &&) = delete;
+        auto operator=(Channel &&) = delete;
+
+    public:
+        [[nodiscard]]
+        auto is_closed() const noexcept -> bool {
+            return closed_.load(std::memory_order::acquire);
+        }
+
+        // No more values are sent, the receiver still gets the queued ones
+        auto close() -> void {
+            closed_.store(true, std::memory_order::seq_cst);
+            Waiter *senders{nullptr};
+            {
+                auto lock = senders_.lock();
+                senders = senders_.pop_all();
+                slots_.fetch_and(~WAITERS, std::memory_order::relaxed);
+            }
+            WaitList::wake(senders);
+            notify_receiver();
+        }
+
+        auto add_sender() noexcept -> void {
+            num_senders_.fetch_add(1, std::memory_order::relaxed);
+        }
+
+        auto drop_sender() -> void {
+            if (num_senders_.fetch_sub(1, std::memory_order::acq_rel) == 1) {
+                close();
+            }
+        }
+
+        // Takes a free slot, bounded channels only
+        [[nodiscard]]
+        auto try_reserve() noexcept -> bool {
+            auto state = slots_.load(std::memory_order::relaxed);
+            while (state >= SLOT) {
+                if (slots_.compare_exchange_weak(state,
+                                                 state - SLOT,
+                                                 std::memory_order::acquire,
+                                                 std::memory_order::relaxed)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Into a reserved slot, then wakes the receiver up
+        auto push(T &&value) -> void {
+            if constexpr (bounded) {
+                [[maybe_unused]] auto pushed
+                    = queue_.try_push(std::move(value));
+                assert(pushed);
+            } else {
+                queue_.push(std::move(value));
+            }
+            notify_receiver();
+        }
+
+        // Receiver only. True once `value` holds the next value, or stays
+        // empty because the channel is closed and drained.
+        auto poll(std::optional<T> &value) -> bool {
+            value = try_pop();
+            if (value.has_value()) {
+                return true;
+            }
+            if (!is_closed()) {
+                return false;
+            }
+            // Sent before the close
+            value = try_pop();
+            return true;
+        }
+
+    private:
+        // With no free slot, queues the sender unless a slot was freed or the
+        // channel closed meanwhile
+        auto wait_for_slot(Waiter *waiter, std::coroutine_handle<> handle)
+            -> bool {
+            auto lock = senders_.lock();
+            if (is_closed()) {
+                return false;
+            }
+            auto state = slots_.load(std::memory_order::relaxed);
+            while (true) {
+                if (state >= SLOT) {
+                    if (slots_.compare_exchange_weak(
+                            state,
+                            state - SLOT,
+                            std::memory_order::acquire,
+                            std::memory_order::relaxed)) {
+                        return false;
+                    }
+                } else if (slots_.compare_exchange_weak(
+                               state,
+                               state | WAITERS,
+                               std::memory_order::relaxed,
+                               std::memory_order::relaxed)) {
+                    senders_.push(waiter, handle);
+                    return true;
+                }
+            }
+        }
+
+        auto try_pop() -> std::optional<T> {
+            if constexpr (bounded) {
+                auto value = queue_.try_pop();
+                if (value.has_value()) {
+                    release_slot();
+                }
+                return value;
+            } else {
+                if (drained_.empty()) {
+                    queue_.consume([this](T &&value) {
+                        drained_.push_back(std::move(value));
+                    });
+                }
+                if (drained_.empty()) {
+                    return std::nullopt;
+                }
+                std::optional<T> value{std::move(drained_.front())};
+                drained_.pop_front();
+                return value;
+            }
+        }
+
+        auto release_slot() -> void {
+            auto state = slots_.load(std::memory_order::relaxed);
+            while ((state & WAITERS) == 0) {
+                if (slots_.compare_exchange_weak(state,
+                                                 state + SLOT,
+                                                 std::memory_order::release,
+                                                 std::memory_order::relaxed)) {
+                    return;
+                }
+            }
+
+            // Handed to the first waiting sender
+            Waiter *next{nullptr};
+            {
+                auto lock = senders_.lock();
+                if (senders_.empty()) {
+                    // Closed, or the senders cancelled, meanwhile
+                    slots_.fetch_add(SLOT, std::memory_order::release);
+                    return;
+                }
+                next = senders_.pop();
+                if (senders_.empty()) {
+                    slots_.store(0, std::memory_order::release);
+                }
+            }
+            WaitList::wake(next);
+        }
+
+        // False if the sender was handed a slot, or woken by the close,
+        // already
+        auto cancel_sender(Waiter *sender) -> bool {
+            auto lock = senders_.lock();
+            if (!senders_.remove(sender)) {
+                return false;
+            }
+            if (senders_.empty()) {
+                slots_.fetch_and(~WAITERS, std::memory_order::relaxed);
+            }
+            return true;
+        }
+
+        auto park(Waiter *receiver) -> void {
+            receiver_.store(receiver, std::memory_order::release);
+            // Pairs with the fence in `notify_receiver()`: either the receiver
+            // sees the value or the sender sees the receiver
+            std::atomic_thread_fence(std::memory_order::seq_cst);
+        }
+
+        // False if a sender took the receiver to wake it up
+        auto unpark(Waiter *receiver) -> bool {
+            return receiver_.compare_exchange_strong(
+                receiver,
+                nullptr,
+                std::memory_order::relaxed,
+                std::memory_order::relaxed);
+        }
+
+        auto notify_receiver() -> void {
+            std::atomic_thread_fence(std::memory_order::seq_cst);
+            if (receiver_.load(std::memory_order::relaxed) != nullptr) {
+                auto receiver
+                    = receiver_.exchange(nullptr, std::memory_order::acquire);
+                if (receiver != nullptr) {
+                    receiver->waker_.wake();
+                }
+            }
+        }
+
+    private:
+        Queue                    queue_;
+        // Unbounded channels only, values taken from `queue_` in a batch
+        std::deque<T>            drained_;
+        std::atomic<uint64_t>    slots_{0};
+        WaitList                 senders_;
+        std::atomic<Waiter *>    receiver_{nullptr};
+        std::atomic<bool>        closed_{false};
+        std::atomic<std::size_t> num_senders_{1};
+    };
+
+} // namespace detail
+
+// Sending half of a channel, copy it for more producers. The channel closes
+// when the last sender is gone.
+template <typename T, bool bounded = true>
+class Sender {
+    using Channel = detail::Channel<T, bounded>;
+
+public:
+    explicit Sender(std::shared_ptr<Channel> channel)
+        : channel_{std::move(channel)} {}
+
+    ~Sender() {
+        reset();
+    }
+
+    Sender(const Sender &other)
+        : channel_{other.channel_} {
+        if (channel_ != nullptr) {
+            channel_->add_sender();
+        }
+    }
+
+    auto operator=(const Sender &other) -> Sender & {
+        if (std::addressof(other) != this) [[likely]] {
+            reset();
+            channel_ = other.channel_;
+            if (channel_ != nullptr) {
+                channel_->add_sender();
+            }
+        }
+        return *this;
+    }
+
+    Sender(Sender &&other) noexcept
+        : channel_{std::move(other.channel_)} {}
+
+    auto operator=(Sender &&other) noexcept -> Sender & {
+        if (std::addressof(other) != this) [[likely]] {
+            reset();
+            channel_ = std::move(other.channel_);
+        }
+        return *this;
+    }
+
+public:
+    // `Result<void> ret = co_await sender.send(value);`, waits for a free slot
+    // while a bounded channel is full. Fails once the receiver is gone.
+    [[REMEMBER_CO_AWAIT]]
+    auto send(T value) {
+        return typename Channel::SendAwaiter{channel_.get(), std::move(value)};
+    }
+
+    // Moves from `value` only on success
+    [[nodiscard]]
+    auto try_send(T &&value) -> Result<void> {
+        if (channel_->is_closed()) {
+            return unexpected{make_uvio_error(Error::ChannelClosed)};
+        }
+        if constexpr (bounded) {
+            if (!channel_->try_reserve()) {
+                return unexpected{make_uvio_error(Error::ChannelFull)};
+            }
+        }
+        channel_->push(std::move(value));
+        return {};
+    }
+
+    [[nodiscard]]
+    auto is_closed() const noexcept -> bool {
+        return channel_->is_closed();
+    }
+
+private:
+    auto reset() -> void {
+        if (channel_ != nullptr) {
+            channel_->drop_sender();
+            channel_.reset();
+        }
+    }
+
+private:
+    std::shared_ptr<Channel> channel_;
+};
+
+// Receiving half of a channel, a single consumer. The channel closes when it
+// is gone.
+template <typename T, bool bounded = true>
+class Receiver {
+    using Channel = detail::Channel<T, bounded>;
+
+public:
+    explicit Receiver(std::shared_ptr<Channel> channel)
+        : channel_{std::move(channel)} {}
+
+    ~Receiver() {
+        if (channel_ != nullptr) {
+            channel_->close();
+        }
+    }
+
+    Receiver(Receiver &&other) noexcept = default;
+
+    auto operator=(Receiver &&other) noexcept -> Receiver & {
+        if (std::addressof(other) != this) [[likely]] {
+            if (channel_ != nullptr) {
+                channel_->close();
+            }
+            channel_ = std::move(other.channel_);
+        }
+        return *this;
+    }
+
+    // No copy
+    Receiver(const Receiver &) = delete;
+    auto operator=(const Receiver &) = delete;
+
+public:
+    // `Result<T> ret = co_await receiver.recv();`, fails once the channel is
+    // closed and drained
+    [[REMEMBER_CO_AWAIT]]
+    auto recv() {
+        return typename Channel::RecvAwaiter{channel_.get()};
+    }
+
+    [[nodiscard]]
+    auto try_recv() -> Result<T> {
+        std::optional<T> value;
+        if (!channel_->poll(value)) {
+            return unexpected{make_uvio_error(Error::ChannelEmpty)};
+        }
+        if (!value.has_value()) {
+            return unexpected{make_uvio_error(Error::ChannelClosed)};
+        }
+        return std::move(*value);
+    }
+
+    // Stops the senders, the queued values can still be received
+    auto close() -> void {
+        channel_->close();
+    }
+
+private:
+    std::shared_ptr<Channel> channel_;
+};
+
+template <typename T>
+using UnboundedSender = Sender<T, false>;
+
+template <typename T>
+using UnboundedReceiver = Receiver<T, false>;
+
+// Multi-producer single-consumer channel holding up to `capacity` values,
+// senders wait while it is full. Usable across loops.
+template <typename T>
+[[nodiscard]]
+static inline auto channel(std::size_t capacity)
+    -> std::pair<Sender<T>, Receiver<T>> {
+    assert(capacity > 0);
+    auto shared = std::make_shared<detail::Channel<T, true>>(capacity);
+    return {Sender<T>{shared}, Receiver<T>{shared}};
+}
+
+// Multi-producer single-consumer channel whose senders never wait
+template <typename T>
+[[nodiscard]]
+static inline auto unbounded_channel()
+    -> std::pair<UnboundedSender<T>, UnboundedReceiver<T>> {
+    auto shared = std::make_shared<detail::Channel<T, false>>();
+    return {UnboundedSender<T>{shared}, UnboundedReceiver<T>{shared}};
+}
+
+} // namespace uvio::sync
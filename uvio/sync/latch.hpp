@@ -3,6 +3,7 @@
 
 #include "uvio/macros.hpp"
 #include "uvio/runtime.hpp"
+#include "uvio/runtime/waker.hpp"
 
 #include <atomic>
 
@@ -10,9 +11,13 @@ namespace uvio::sync {
 
 class Latch {
     struct LatchAwaiter {
-        std::coroutine_handle<> handle_;
-        Latch                  *latch_;
-        LatchAwaiter           *next_{};
+        // Waiters sit in a lock-free stack they cannot leave, see
+        // `IgnoresCancellation`
+        constexpr static bool IGNORES_CANCELLATION{true};
+
+        uvio::detail::Waker waker_;
+        Latch              *latch_;
+        LatchAwaiter       *next_{};
 
         LatchAwaiter(Latch *latch)
             : latch_{latch} {}
@@ -22,15 +27,23 @@ class Latch {
         }
 
         auto await_suspend(std::coroutine_handle<> handle) noexcept -> bool {
-            handle_ = handle;
-            next_ = latch_->head_.load(std::memory_order::relaxed);
-            while (!latch_->head_.compare_exchange_weak(
-                next_,
+            // The latch may be counted down on another thread, which sends
+            // the coroutine back to this loop
+            waker_ = uvio::detail::Waker::current(handle);
+            void *state = latch_->state_.load(std::memory_order::acquire);
+            do {
+                if (state == latch_) {
+                    // Released meanwhile
+                    waker_.forget();
+                    return false;
+                }
+                next_ = static_cast<LatchAwaiter *>(state);
+            } while (!latch_->state_.compare_exchange_weak(
+                state,
                 this,
-                std::memory_order::acq_rel,
-                std::memory_order::relaxed)) {
-            }
-            return !latch_->try_wait();
+                std::memory_order::release,
+                std::memory_order::acquire));
+            return true;
         }
 
         auto await_resume() const noexcept {}
@@ -72,16 +85,19 @@ public:
 
 private:
     auto notify_all() -> void {
-        auto head = head_.load(std::memory_order::acquire);
+        auto head = static_cast<LatchAwaiter *>(
+            state_.exchange(this, std::memory_order::acq_rel));
         while (head != nullptr) {
-            head->handle_.resume();
-            head = head->next_;
+            auto next = head->next_;
+            head->waker_.wake();
+            head = next;
         }
     }
 
 private:
     std::atomic<std::ptrdiff_t> expected_;
-    std::atomic<LatchAwaiter *> head_{nullptr};
+    // Waiting awaiters, or `this` once released
+    std::atomic<void *>         state_{nullptr};
 };
 
 } // namespace uvio::sync
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "uvio/macros.hpp"
+#include "uvio/sync/wait_list.hpp"
+
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <utility>
+
+namespace uvio::sync {
+
+class Mutex;
+
+// Unlocks the mutex when destroyed
+class MutexGuard {
+public:
+    explicit MutexGuard(Mutex *mutex)
+        : mutex_{mutex} {}
+
+    inline ~MutexGuard();
+
+    MutexGuard(MutexGuard &&other) noexcept
+        : mutex_{std::exchange(other.mutex_, nullptr)} {}
+
+    auto operator=(MutexGuard &&other) noexcept -> MutexGuard & {
+        if (std::addressof(other) != this) [[likely]] {
+            unlock();
+            mutex_ = std::exchange(other.mutex_, nullptr);
+        }
+        return *this;
+    }
+
+    // No copy
+    MutexGuard(const MutexGuard &) = delete;
+    auto operator=(const MutexGuard &) = delete;
+
+public:
+    inline auto unlock() -> void;
+
+private:
+    Mutex *mutex_;
+};
+
+// Mutex for coroutines, which wait for it without blocking their loop. Locking
+// and unlocking without contention is a single CAS; contended, the lock is
+// handed to the waiters in FIFO order. May be shared by several loops.
+class Mutex {
+    constexpr static uint32_t LOCKED{1};
+    constexpr static uint32_t WAITERS{2};
+
+    struct LockAwaiter : detail::Waiter {
+        // The lock is handed over rather than polled for, see
+        // `IgnoresCancellation`
+        constexpr static bool IGNORES_CANCELLATION{true};
+
+        Mutex *mutex_;
+
+        LockAwaiter(Mutex *mutex)
+            : mutex_{mutex} {}
+
+        auto await_ready() const noexcept -> bool {
+            return mutex_->try_lock();
+        }
+
+        auto await_suspend(std::coroutine_handle<> handle) -> bool {
+            auto lock = mutex_->waiters_.lock();
+            auto state = mutex_->state_.load(std::memory_order::relaxed);
+            while (true) {
+                if ((state & LOCKED) == 0) {
+                    if (mutex_->state_.compare_exchange_weak(
+                            state,
+                            state | LOCKED,
+                            std::memory_order::acquire,
+                            std::memory_order::relaxed)) {
+                        return false;
+                    }
+                } else if (mutex_->state_.compare_exchange_weak(
+                               state,
+                               state | WAITERS,
+                               std::memory_order::relaxed,
+                               std::memory_order::relaxed)) {
+                    mutex_->waiters_.push(this, handle);
+                    return true;
+                }
+            }
+        }
+
+        [[nodiscard]]
+        auto await_resume() const noexcept -> MutexGuard {
+            return MutexGuard{mutex_};
+        }
+    };
+
+public:
+    Mutex() = default;
+
+    // No copy, no move
+    Mutex(const Mutex &) = delete;
+    auto operator=(const Mutex &) = delete;
+    Mutex(Mutex &&) = delete;
+    auto operator=(Mutex &&) = delete;
+
+public:
+    // `auto guard = co_await mutex.lock();`
+    [[REMEMBER_CO_AWAIT]]
+    auto lock() noexcept {
+        return LockAwaiter{this};
+    }
+
+    [[nodiscard]]
+    auto try_lock() noexcept -> bool {
+        uint32_t expected{0};
+        return state_.compare_exchange_strong(expected,
+                                              LOCKED,
+                                              std::memory_order::acquire,
+                                              std::memory_order::relaxed);
+    }
+
+    auto unlock() -> void {
+        uint32_t expected{LOCKED};
+        if (state_.compare_exchange_strong(expected,
+                                           0,
+                                           std::memory_order::release,
+                                           std::memory_order::relaxed))
+            [[likely]] {
+            return;
+        }
+
+        // Still locked, now by the first waiter
+        detail::Waiter *next{nullptr};
+        {
+            auto lock = waiters_.lock();
+            next = waiters_.pop();
+            if (waiters_.empty()) {
+                state_.store(LOCKED, std::memory_order::release);
+            }
+        }
+        detail::WaitList::wake(next);
+    }
+
+private:
+    std::atomic<uint32_t> state_{0};
+    detail::WaitList      waiters_;
+};
+
+inline MutexGuard::~MutexGuard() {
+    unlock();
+}
+
+inline auto MutexGuard::unlock() -> void {
+    if (mutex_ != nullptr) {
+        std::exchange(mutex_, nullptr)->unlock();
+    }
+}
+
+} // namespace uvio::sync
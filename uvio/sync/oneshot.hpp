@@ -0,0 +1,241 @@
+#pragma once
+
+#include "uvio/common/result.hpp"
+#include "uvio/coroutine/task.hpp"
+#include "uvio/macros.hpp"
+#include "uvio/sync/wait_list.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <coroutine>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+
+namespace uvio::sync {
+
+namespace detail {
+
+    // A single value handed from one side to the other, the whole exchange
+    // lives in one atomic word
+    template <typename T>
+    class Oneshot {
+        // Besides these, `state_` holds the waiting receiver
+        constexpr static uintptr_t EMPTY{0};
+        constexpr static uintptr_t VALUE{1};
+        constexpr static uintptr_t CLOSED{2};
+
+    public:
+        struct RecvAwaiter : Waiter {
+            Oneshot                 *oneshot_;
+            bool                     cancelled_{false};
+            CancellationRegistration cancellation_;
+
+            RecvAwaiter(Oneshot *oneshot)
+                : oneshot_{oneshot} {}
+
+            auto await_ready() const noexcept -> bool {
+                return oneshot_->state_.load(std::memory_order::acquire)
+                       != EMPTY;
+            }
+
+            template <typename Promise>
+            auto await_suspend(std::coroutine_handle<Promise> handle) -> bool {
+                if (!cancellation_.register_callback(
+                        uvio::detail::cancellation_token_of(handle),
+                        on_cancel,
+                        this)) {
+                    cancelled_ = true;
+                    return false;
+                }
+                waker_ = uvio::detail::Waker::current(handle);
+                auto expected = EMPTY;
+                auto waiter = static_cast<Waiter *>(this);
+                if (oneshot_->state_.compare_exchange_strong(
+                        expected,
+                        reinterpret_cast<uintptr_t>(waiter),
+                        std::memory_order::release,
+                        std::memory_order::acquire)) {
+                    return true;
+                }
+                // Sent or closed meanwhile
+                waker_.forget();
+                return false;
+            }
+
+            [[nodiscard]]
+            auto await_resume() -> Result<T> {
+                cancellation_.reset();
+                if (cancelled_) {
+                    return unexpected{make_uvio_error(Error::Cancelled)};
+                }
+                return oneshot_->take();
+            }
+
+            // On the loop of the receiver, unless the sender is already
+            // waking it up. The value may still be received later.
+            static auto on_cancel(void *data) -> void {
+                auto self = static_cast<RecvAwaiter *>(data);
+                auto expected
+                    = reinterpret_cast<uintptr_t>(static_cast<Waiter *>(self));
+                if (self->oneshot_->state_.compare_exchange_strong(
+                        expected,
+                        EMPTY,
+                        std::memory_order::relaxed,
+                        std::memory_order::relaxed)) {
+                    self->cancelled_ = true;
+                    self->waker_.wake();
+                }
+            }
+        };
+
+    public:
+        auto send(T &&value) -> Result<void> {
+            value_.emplace(std::move(value));
+            auto state = finish(VALUE);
+            if (state == CLOSED) {
+                return unexpected{make_uvio_error(Error::ChannelClosed)};
+            }
+            return {};
+        }
+
+        // Either side gives up
+        auto close() -> void {
+            finish(CLOSED);
+        }
+
+        [[nodiscard]]
+        auto take() -> Result<T> {
+            if (state_.load(std::memory_order::acquire) != VALUE) {
+                return unexpected{make_uvio_error(Error::ChannelClosed)};
+            }
+            // Taken only once
+            state_.store(CLOSED, std::memory_order::relaxed);
+            return std::move(*value_);
+        }
+
+        [[nodiscard]]
+        auto is_empty() const noexcept -> bool {
+            return state_.load(std::memory_order::acquire) == EMPTY;
+        }
+
+    private:
+        // Sets the final state, wakes the receiver up if it waits
+        auto finish(uintptr_t final_state) -> uintptr_t {
+            auto state
+                = state_.exchange(final_state, std::memory_order::acq_rel);
+            if (state > CLOSED) {
+                reinterpret_cast<Waiter *>(state)->waker_.wake();
+            }
+            return state;
+        }
+
+    private:
+        std::atomic<uintptr_t> state_{EMPTY};
+        std::optional<T>       value_{std::nullopt};
+    };
+
+} // namespace detail
+
+// Sends the single value of a oneshot channel. Dropping it unsent closes the
+// channel.
+template <typename T>
+class OneshotSender {
+public:
+    explicit OneshotSender(std::shared_ptr<detail::Oneshot<T>> oneshot)
+        : oneshot_{std::move(oneshot)} {}
+
+    ~OneshotSender() {
+        if (oneshot_ != nullptr) {
+            oneshot_->close();
+        }
+    }
+
+    OneshotSender(OneshotSender &&other) noexcept = default;
+
+    auto operator=(OneshotSender &&other) noexcept -> OneshotSender & {
+        if (std::addressof(other) != this) [[likely]] {
+            if (oneshot_ != nullptr) {
+                oneshot_->close();
+            }
+            oneshot_ = std::move(other.oneshot_);
+        }
+        return *this;
+    }
+
+    // No copy
+    OneshotSender(const OneshotSender &) = delete;
+    auto operator=(const OneshotSender &) = delete;
+
+public:
+    // Only once, fails if the receiver is gone
+    auto send(T value) -> Result<void> {
+        assert(oneshot_ != nullptr);
+        return std::exchange(oneshot_, nullptr)->send(std::move(value));
+    }
+
+private:
+    std::shared_ptr<detail::Oneshot<T>> oneshot_;
+};
+
+// Receives the single value of a oneshot channel
+template <typename T>
+class OneshotReceiver {
+public:
+    explicit OneshotReceiver(std::shared_ptr<detail::Oneshot<T>> oneshot)
+        : oneshot_{std::move(oneshot)} {}
+
+    ~OneshotReceiver() {
+        if (oneshot_ != nullptr) {
+            oneshot_->close();
+        }
+    }
+
+    OneshotReceiver(OneshotReceiver &&other) noexcept = default;
+
+    auto operator=(OneshotReceiver &&other) noexcept -> OneshotReceiver & {
+        if (std::addressof(other) != this) [[likely]] {
+            if (oneshot_ != nullptr) {
+                oneshot_->close();
+            }
+            oneshot_ = std::move(other.oneshot_);
+        }
+        return *this;
+    }
+
+    // No copy
+    OneshotReceiver(const OneshotReceiver &) = delete;
+    auto operator=(const OneshotReceiver &) = delete;
+
+public:
+    // `Result<T> ret = co_await receiver.recv();`, fails if the sender is gone
+    // without sending
+    [[REMEMBER_CO_AWAIT]]
+    auto recv() {
+        return typename detail::Oneshot<T>::RecvAwaiter{oneshot_.get()};
+    }
+
+    [[nodiscard]]
+    auto try_recv() -> Result<T> {
+        if (oneshot_->is_empty()) {
+            return unexpected{make_uvio_error(Error::ChannelEmpty)};
+        }
+        return oneshot_->take();
+    }
+
+private:
+    std::shared_ptr<detail::Oneshot<T>> oneshot_;
+};
+
+// Channel for a single value, e.g. the reply to a request sent over another
+// channel
+template <typename T>
+[[nodiscard]]
+static inline auto oneshot()
+    -> std::pair<OneshotSender<T>, OneshotReceiver<T>> {
+    auto shared = std::make_shared<detail::Oneshot<T>>();
+    return {OneshotSender<T>{shared}, OneshotReceiver<T>{shared}};
+}
+
+} // namespace uvio::sync
@@ -0,0 +1,249 @@
+#pragma once
+
+#include "uvio/macros.hpp"
+#include "uvio/sync/wait_list.hpp"
+
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <utility>
+
+namespace uvio::sync {
+
+class RwLock;
+
+// Releases the shared (`exclusive` false) or exclusive lock when destroyed
+template <bool exclusive>
+class RwLockGuard {
+public:
+    explicit RwLockGuard(RwLock *lock)
+        : lock_{lock} {}
+
+    ~RwLockGuard() {
+        unlock();
+    }
+
+    RwLockGuard(RwLockGuard &&other) noexcept
+        : lock_{std::exchange(other.lock_, nullptr)} {}
+
+    auto operator=(RwLockGuard &&other) noexcept -> RwLockGuard & {
+        if (std::addressof(other) != this) [[likely]] {
+            unlock();
+            lock_ = std::exchange(other.lock_, nullptr);
+        }
+        return *this;
+    }
+
+    // No copy
+    RwLockGuard(const RwLockGuard &) = delete;
+    auto operator=(const RwLockGuard &) = delete;
+
+public:
+    inline auto unlock() -> void;
+
+private:
+    RwLock *lock_;
+};
+
+using ReadGuard = RwLockGuard<false>;
+using WriteGuard = RwLockGuard<true>;
+
+// Readers-writer lock for coroutines. Taking and releasing it without
+// contention is a single CAS. Waiters are served in FIFO order: a writer
+// waits for the readers ahead of it, and readers arriving after a waiting
+// writer queue behind it, so writers are never starved. May be shared by
+// several loops.
+class RwLock {
+    // Readers are counted from bit 2 on
+    constexpr static uint64_t WAITERS{1};
+    constexpr static uint64_t WRITER{2};
+    constexpr static uint64_t READER{4};
+
+    template <bool exclusive>
+    struct LockAwaiter : detail::Waiter {
+        // The lock is handed over rather than polled for, see
+        // `IgnoresCancellation`
+        constexpr static bool IGNORES_CANCELLATION{true};
+
+        RwLock *lock_;
+
+        LockAwaiter(RwLock *lock)
+            : lock_{lock} {
+            exclusive_ = exclusive;
+        }
+
+        auto await_ready() const noexcept -> bool {
+            if constexpr (exclusive) {
+                return lock_->try_write();
+            } else {
+                return lock_->try_read();
+            }
+        }
+
+        auto await_suspend(std::coroutine_handle<> handle) -> bool {
+            auto guard = lock_->waiters_.lock();
+            auto state = lock_->state_.load(std::memory_order::relaxed);
+            while (true) {
+                if (can_lock(state)) {
+                    if (lock_->state_.compare_exchange_weak(
+                            state,
+                            exclusive ? WRITER : state + READER,
+                            std::memory_order::acquire,
+                            std::memory_order::relaxed)) {
+                        return false;
+                    }
+                } else if (lock_->state_.compare_exchange_weak(
+                               state,
+                               state | WAITERS,
+                               std::memory_order::relaxed,
+                               std::memory_order::relaxed)) {
+                    lock_->waiters_.push(this, handle);
+                    return true;
+                }
+            }
+        }
+
+        [[nodiscard]]
+        auto await_resume() const noexcept -> RwLockGuard<exclusive> {
+            return RwLockGuard<exclusive>{lock_};
+        }
+
+        [[nodiscard]]
+        constexpr static auto can_lock(uint64_t state) noexcept -> bool {
+            if constexpr (exclusive) {
+                return state == 0;
+            } else {
+                return (state & (WRITER | WAITERS)) == 0;
+            }
+        }
+    };
+
+public:
+    RwLock() = default;
+
+    // No copy, no move
+    RwLock(const RwLock &) = delete;
+    auto operator=(const RwLock &) = delete;
+    RwLock(RwLock &&) = delete;
+    auto operator=(RwLock &&) = delete;
+
+public:
+    // `auto guard = co_await lock.read();`
+    [[REMEMBER_CO_AWAIT]]
+    auto read() noexcept {
+        return LockAwaiter<false>{this};
+    }
+
+    // `auto guard = co_await lock.write();`
+    [[REMEMBER_CO_AWAIT]]
+    auto write() noexcept {
+        return LockAwaiter<true>{this};
+    }
+
+    [[nodiscard]]
+    auto try_read() noexcept -> bool {
+        auto state = state_.load(std::memory_order::relaxed);
+        while ((state & (WRITER | WAITERS)) == 0) {
+            if (state_.compare_exchange_weak(state,
+                                             state + READER,
+                                             std::memory_order::acquire,
+                                             std::memory_order::relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    [[nodiscard]]
+    auto try_write() noexcept -> bool {
+        uint64_t expected{0};
+        return state_.compare_exchange_strong(expected,
+                                              WRITER,
+                                              std::memory_order::acquire,
+                                              std::memory_order::relaxed);
+    }
+
+    auto unlock_read() -> void {
+        auto state = state_.load(std::memory_order::relaxed);
+        while ((state & WAITERS) == 0) {
+            if (state_.compare_exchange_weak(state,
+                                             state - READER,
+                                             std::memory_order::release,
+                                             std::memory_order::relaxed)) {
+                return;
+            }
+        }
+
+        detail::Waiter *next{nullptr};
+        {
+            auto guard = waiters_.lock();
+            state = state_.fetch_sub(READER, std::memory_order::release)
+                    - READER;
+            if (state < READER) {
+                next = hand_over();
+            }
+        }
+        detail::WaitList::wake(next);
+    }
+
+    auto unlock_write() -> void {
+        uint64_t expected{WRITER};
+        if (state_.compare_exchange_strong(expected,
+                                           0,
+                                           std::memory_order::release,
+                                           std::memory_order::relaxed))
+            [[likely]] {
+            return;
+        }
+
+        detail::Waiter *next{nullptr};
+        {
+            auto guard = waiters_.lock();
+            next = hand_over();
+        }
+        detail::WaitList::wake(next);
+    }
+
+private:
+    // With the waiters locked and the lock free: give it to the writer at the
+    // front, or to all the readers at the front
+    auto hand_over() -> detail::Waiter * {
+        uint64_t        state{0};
+        detail::Waiter *first{nullptr};
+        detail::Waiter *last{nullptr};
+        if (waiters_.front()->exclusive_) {
+            first = waiters_.pop();
+            state = WRITER;
+        } else {
+            while (!waiters_.empty() && !waiters_.front()->exclusive_) {
+                auto reader = waiters_.pop();
+                (last != nullptr ? last->next_ : first) = reader;
+                last = reader;
+                state += READER;
+            }
+        }
+        if (!waiters_.empty()) {
+            state |= WAITERS;
+        }
+        state_.store(state, std::memory_order::release);
+        return first;
+    }
+
+private:
+    std::atomic<uint64_t> state_{0};
+    detail::WaitList      waiters_;
+};
+
+template <bool exclusive>
+inline auto RwLockGuard<exclusive>::unlock() -> void {
+    if (lock_ == nullptr) {
+        return;
+    }
+    if constexpr (exclusive) {
+        std::exchange(lock_, nullptr)->unlock_write();
+    } else {
+        std::exchange(lock_, nullptr)->unlock_read();
+    }
+}
+
+} // namespace uvio::sync
@@ -0,0 +1,172 @@
+#pragma once
+
+#include "uvio/common/result.hpp"
+#include "uvio/coroutine/task.hpp"
+#include "uvio/macros.hpp"
+#include "uvio/sync/wait_list.hpp"
+
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+
+namespace uvio::sync {
+
+// Counting semaphore for coroutines, e.g. to bound the number of concurrent
+// upstream calls. Acquiring and releasing without contention is a single CAS;
+// once permits run out, released ones are handed to the waiters in FIFO
+// order. May be shared by several loops.
+class Semaphore {
+    // The permits are counted from bit 1 on, never more than zero while
+    // somebody waits
+    constexpr static uint64_t WAITERS{1};
+    constexpr static uint64_t PERMIT{2};
+
+    struct AcquireAwaiter : detail::Waiter {
+        Semaphore               *semaphore_;
+        bool                     cancelled_{false};
+        CancellationRegistration cancellation_;
+
+        AcquireAwaiter(Semaphore *semaphore)
+            : semaphore_{semaphore} {}
+
+        auto await_ready() const noexcept -> bool {
+            return semaphore_->try_acquire();
+        }
+
+        template <typename Promise>
+        auto await_suspend(std::coroutine_handle<Promise> handle) -> bool {
+            if (!cancellation_.register_callback(
+                    uvio::detail::cancellation_token_of(handle),
+                    on_cancel,
+                    this)) {
+                cancelled_ = true;
+                return false;
+            }
+            auto lock = semaphore_->waiters_.lock();
+            auto state = semaphore_->state_.load(std::memory_order::relaxed);
+            while (true) {
+                if (state >= PERMIT) {
+                    if (semaphore_->state_.compare_exchange_weak(
+                            state,
+                            state - PERMIT,
+                            std::memory_order::acquire,
+                            std::memory_order::relaxed)) {
+                        return false;
+                    }
+                } else if (semaphore_->state_.compare_exchange_weak(
+                               state,
+                               state | WAITERS,
+                               std::memory_order::relaxed,
+                               std::memory_order::relaxed)) {
+                    semaphore_->waiters_.push(this, handle);
+                    return true;
+                }
+            }
+        }
+
+        auto await_resume() noexcept -> Result<void> {
+            cancellation_.reset();
+            if (cancelled_) {
+                return unexpected{make_uvio_error(Error::Cancelled)};
+            }
+            return {};
+        }
+
+        // On the loop of the waiter. One already handed a permit keeps it.
+        static auto on_cancel(void *data) -> void {
+            auto self = static_cast<AcquireAwaiter *>(data);
+            auto semaphore = self->semaphore_;
+            {
+                auto lock = semaphore->waiters_.lock();
+                if (!semaphore->waiters_.remove(self)) {
+                    return;
+                }
+                if (semaphore->waiters_.empty()) {
+                    semaphore->state_.fetch_and(~WAITERS,
+                                                std::memory_order::relaxed);
+                }
+            }
+            self->cancelled_ = true;
+            self->waker_.wake();
+        }
+    };
+
+public:
+    explicit Semaphore(std::size_t permits)
+        : state_{permits * PERMIT} {}
+
+    // No copy, no move
+    Semaphore(const Semaphore &) = delete;
+    auto operator=(const Semaphore &) = delete;
+    Semaphore(Semaphore &&) = delete;
+    auto operator=(Semaphore &&) = delete;
+
+public:
+    // Take one permit, give it back with `release()`. Fails with
+    // `Error::Cancelled`, holding no permit, when cancelled while waiting.
+    [[REMEMBER_CO_AWAIT]]
+    auto acquire() noexcept {
+        return AcquireAwaiter{this};
+    }
+
+    [[nodiscard]]
+    auto try_acquire() noexcept -> bool {
+        auto state = state_.load(std::memory_order::relaxed);
+        while (state >= PERMIT) {
+            if (state_.compare_exchange_weak(state,
+                                             state - PERMIT,
+                                             std::memory_order::acquire,
+                                             std::memory_order::relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    auto release(std::size_t permits = 1) -> void {
+        for (std::size_t i = 0; i < permits; i++) {
+            release_one();
+        }
+    }
+
+    // Permits left, a hint while other threads use the semaphore
+    [[nodiscard]]
+    auto available() const noexcept -> std::size_t {
+        return state_.load(std::memory_order::relaxed) / PERMIT;
+    }
+
+private:
+    auto release_one() -> void {
+        auto state = state_.load(std::memory_order::relaxed);
+        while ((state & WAITERS) == 0) {
+            if (state_.compare_exchange_weak(state,
+                                             state + PERMIT,
+                                             std::memory_order::release,
+                                             std::memory_order::relaxed)) {
+                return;
+            }
+        }
+
+        // Handed to the first waiter
+        detail::Waiter *next{nullptr};
+        {
+            auto lock = waiters_.lock();
+            if (waiters_.empty()) {
+                // The waiters were cancelled meanwhile
+                state_.fetch_add(PERMIT, std::memory_order::release);
+                return;
+            }
+            next = waiters_.pop();
+            if (waiters_.empty()) {
+                state_.store(0, std::memory_order::release);
+            }
+        }
+        detail::WaitList::wake(next);
+    }
+
+private:
+    std::atomic<uint64_t> state_;
+    detail::WaitList      waiters_;
+};
+
+} // namespace uvio::sync
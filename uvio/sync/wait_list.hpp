@@ -0,0 +1,102 @@
+#pragma once
+
+#include "uvio/runtime/waker.hpp"
+
+#include <coroutine>
+#include <mutex>
+#include <utility>
+
+namespace uvio::sync::detail {
+
+// Coroutine queued on a `WaitList`, embedded in its awaiter
+struct Waiter {
+    uvio::detail::Waker waker_;
+    Waiter             *next_{nullptr};
+    // For `RwLock`, a writer
+    bool                exclusive_{false};
+};
+
+// FIFO of the coroutines waiting for a sync primitive. Only the slow paths
+// take its lock, the primitives keep their fast path on a single atomic word
+// with a bit telling that the list is not empty.
+class WaitList {
+public:
+    [[nodiscard]]
+    auto lock() -> std::unique_lock<std::mutex> {
+        return std::unique_lock{mutex_};
+    }
+
+    [[nodiscard]]
+    auto empty() const noexcept -> bool {
+        return head_ == nullptr;
+    }
+
+    [[nodiscard]]
+    auto front() const noexcept -> Waiter * {
+        return head_;
+    }
+
+    // With the lock held, `handle` is woken up on its own loop once popped
+    auto push(Waiter *waiter, std::coroutine_handle<> handle) -> void {
+        waiter->waker_ = uvio::detail::Waker::current(handle);
+        waiter->next_ = nullptr;
+        if (tail_ != nullptr) {
+            tail_->next_ = waiter;
+        } else {
+            head_ = waiter;
+        }
+        tail_ = waiter;
+    }
+
+    // With the lock held, pass it to `wake()` once the lock is released
+    auto pop() noexcept -> Waiter * {
+        auto waiter = head_;
+        head_ = waiter->next_;
+        if (head_ == nullptr) {
+            tail_ = nullptr;
+        }
+        waiter->next_ = nullptr;
+        return waiter;
+    }
+
+    // With the lock held, unlinks a waiter that gave up, e.g. cancelled.
+    // False if it was popped already, its wake-up is then on the way.
+    auto remove(Waiter *waiter) noexcept -> bool {
+        Waiter *prev{nullptr};
+        for (auto node = head_; node != nullptr; node = node->next_) {
+            if (node != waiter) {
+                prev = node;
+                continue;
+            }
+            (prev != nullptr ? prev->next_ : head_) = node->next_;
+            if (tail_ == node) {
+                tail_ = prev;
+            }
+            node->next_ = nullptr;
+            return true;
+        }
+        return false;
+    }
+
+    // With the lock held, pops every waiter at once
+    auto pop_all() noexcept -> Waiter * {
+        tail_ = nullptr;
+        return std::exchange(head_, nullptr);
+    }
+
+    // Without the lock, wake `waiters` and the ones linked after it up
+    static auto wake(Waiter *waiters) -> void {
+        while (waiters != nullptr) {
+            auto next = waiters->next_;
+            waiters->waker_.wake();
+            waiters = next;
+        }
+    }
+
+private:
+    std::mutex mutex_;
+    Waiter    *head_{nullptr};
+    Waiter    *tail_{nullptr};
+};
+
+} // namespace uvio::sync::detail
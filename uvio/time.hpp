@@ -1,3 +1,4 @@
 #pragma once
 
 #include "uvio/time/sleep.hpp"
+#include "uvio/time/timeout.hpp"
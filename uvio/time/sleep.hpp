@@ -1,13 +1,14 @@
 #pragma once
 
 #include "uvio/common/result.hpp"
+#include "uvio/coroutine/task.hpp"
 #include "uvio/macros.hpp"
+#include "uvio/runtime/ready_queue.hpp"
+#include "uvio/time/timer.hpp"
 
 #include <chrono>
 #include <coroutine>
 
-#include "uv.h"
-
 namespace uvio::time {
 
 using namespace std::chrono_literals;
@@ -15,41 +16,60 @@ using namespace std::chrono_literals;
 namespace detail {
 
     struct SleepAwaiter {
-        std::coroutine_handle<> handle_;
-        uv_timer_t              timer_{};
-        bool                    ready_{false};
+        std::coroutine_handle<>  handle_;
+        OneShotTimer             timer_;
+        bool                     ready_{false};
+        bool                     cancelled_{false};
+        CancellationRegistration cancellation_;
 
         SleepAwaiter(uint64_t timeout) {
-            uv_timer_init(uv_default_loop(), &timer_);
-            // uv_handle_set_data(reinterpret_cast<uv_handle_t *>(&timer_),
-            // this);
-            timer_.data = this;
-            uv_timer_start(
-                &timer_,
-                [](uv_timer_t *uv_timer) {
-                    auto data = static_cast<SleepAwaiter *>(uv_timer->data);
-                    data->ready_ = true;
-                    if (data->handle_) {
-                        data->handle_.resume();
-                    }
-                },
-                timeout,
-                0);
+            timer_.start(timeout, on_timer, this);
         }
 
         auto await_ready() const noexcept -> bool {
             return ready_;
         }
 
-        auto await_suspend(std::coroutine_handle<> handle) noexcept {
+        template <typename Promise>
+        auto await_suspend(std::coroutine_handle<Promise> handle) noexcept
+            -> bool {
+            if (!cancellation_.register_callback(
+                    uvio::detail::cancellation_token_of(handle),
+                    on_cancel,
+                    this)) {
+                timer_.stop();
+                cancelled_ = true;
+                return false;
+            }
             handle_ = handle;
+            return true;
         }
 
         auto await_resume() noexcept -> Result<void> {
+            cancellation_.reset();
             handle_ = nullptr;
             ready_ = false;
+            if (cancelled_) {
+                return unexpected{make_uvio_error(Error::Cancelled)};
+            }
             return {};
         };
+
+        static auto on_timer(void *data) -> void {
+            auto self = static_cast<SleepAwaiter *>(data);
+            self->ready_ = true;
+            self->cancellation_.reset();
+            if (self->handle_) {
+                uvio::detail::schedule(self->handle_);
+            }
+        }
+
+        static auto on_cancel(void *data) -> void {
+            auto self = static_cast<SleepAwaiter *>(data);
+            self->timer_.stop();
+            self->cancelled_ = true;
+            uvio::detail::schedule(self->handle_);
+        }
     };
 
 } // namespace detail
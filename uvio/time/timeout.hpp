@@ -0,0 +1,128 @@
+#pragma once
+
+#include "uvio/common/result.hpp"
+#include "uvio/coroutine/cancellation.hpp"
+#include "uvio/coroutine/task.hpp"
+#include "uvio/macros.hpp"
+#include "uvio/time/timer.hpp"
+
+#include <chrono>
+#include <type_traits>
+#include <utility>
+
+namespace uvio::time {
+
+namespace detail {
+
+    template <typename T>
+    struct IsResult : std::false_type {};
+
+    template <typename T>
+    struct IsResult<Result<T>> : std::true_type {};
+
+    template <typename T>
+    struct IsTask : std::false_type {};
+
+    template <typename T>
+    struct IsTask<Task<T>> : std::true_type {};
+
+    // A `Result` is returned as is, any other value is wrapped in one
+    template <typename T>
+    using TimeoutResult
+        = std::conditional_t<IsResult<T>::value, T, Result<T>>;
+
+    template <typename Awaitable>
+    concept HasMemberCoAwait = requires(Awaitable &&awaitable) {
+        std::forward<Awaitable>(awaitable).operator co_await();
+    };
+
+    template <typename Awaitable>
+    auto get_awaiter(Awaitable &&awaitable) -> decltype(auto) {
+        if constexpr (HasMemberCoAwait<Awaitable>) {
+            return std::forward<Awaitable>(awaitable).operator co_await();
+        } else {
+            return std::forward<Awaitable>(awaitable);
+        }
+    }
+
+    template <typename Awaitable>
+    using AwaitResult = decltype(get_awaiter(std::declval<Awaitable>())
+                                     .await_resume());
+
+    template <typename T, typename Awaitable>
+    auto await_in_task(Awaitable &&awaitable) -> Task<T> {
+        co_return co_await awaitable;
+    }
+
+    struct TimeoutState {
+        LinkedCancellationSource source_;
+        bool                     timed_out_{false};
+
+        explicit TimeoutState(const CancellationToken &parent)
+            : source_{parent} {}
+
+        static auto on_timer(void *data) -> void {
+            auto self = static_cast<TimeoutState *>(data);
+            self->timed_out_ = true;
+            self->source_.request_cancellation();
+        }
+    };
+
+} // namespace detail
+
+// Run `task` and cancel it once `duration` elapsed, in which case the result
+// is `Error::TimedOut`. A `Result` returned by the task is passed through
+// unless it is the error caused by the timeout, any other value is wrapped in
+// a `Result`. The task is only stopped through its cancellation token: what
+// it awaits at that moment must honour cancellation, as the I/O, timer, work
+// and channel awaiters and `JoinHandle` do, or the timeout waits for it.
+template <typename T>
+[[REMEMBER_CO_AWAIT]]
+auto timeout(Task<T> task, std::chrono::milliseconds duration)
+    -> Task<detail::TimeoutResult<T>> {
+    detail::TimeoutState state{co_await get_cancellation_token()};
+    detail::OneShotTimer timer;
+    timer.start(static_cast<uint64_t>(duration.count()),
+                detail::TimeoutState::on_timer,
+                &state);
+    task.set_cancellation_token(state.source_.token());
+
+    if constexpr (std::is_void_v<T>) {
+        co_await task;
+        if (state.timed_out_) {
+            co_return unexpected{make_uvio_error(Error::TimedOut)};
+        }
+        co_return Result<void>{};
+    } else if constexpr (detail::IsResult<T>::value) {
+        auto ret = co_await task;
+        if (!ret && state.timed_out_) {
+            co_return unexpected{make_uvio_error(Error::TimedOut)};
+        }
+        co_return ret;
+    } else {
+        auto ret = co_await task;
+        if (state.timed_out_) {
+            co_return unexpected{make_uvio_error(Error::TimedOut)};
+        }
+        co_return ret;
+    }
+}
+
+// Same for any cancellable awaitable, e.g.
+// `co_await timeout(stream.read(buf), 5s)`. Awaiters that ignore cancellation
+// (mutex and rwlock locks, latches, task groups) are refused. The awaitable is
+// used by reference, await the returned task in the same expression.
+template <typename Awaitable>
+    requires(!detail::IsTask<std::remove_cvref_t<Awaitable>>::value)
+[[REMEMBER_CO_AWAIT]]
+auto timeout(Awaitable &&awaitable, std::chrono::milliseconds duration) {
+    static_assert(
+        !IgnoresCancellation<decltype(detail::get_awaiter(
+            std::declval<Awaitable>()))>,
+        "timeout() cannot stop an awaiter that ignores cancellation");
+    using T = detail::AwaitResult<Awaitable>;
+    return timeout(detail::await_in_task<T>(std::forward<Awaitable>(awaitable)),
+                   duration);
+}
+
+} // namespace uvio::time
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "uvio/time/timing_wheel.hpp"
+
+#include <cstdint>
+
+namespace uvio::time::detail {
+
+// One-shot timer on the timing wheel of the current loop, invoking
+// `callback(data)` from the loop
+class OneShotTimer {
+public:
+    using Callback = TimerEntry::Callback;
+
+public:
+    OneShotTimer() = default;
+
+    // No copy, no move (linked into the wheel)
+    OneShotTimer(const OneShotTimer &) = delete;
+    auto operator=(const OneShotTimer &) = delete;
+    OneShotTimer(OneShotTimer &&) = delete;
+    auto operator=(OneShotTimer &&) = delete;
+
+public:
+    auto start(uint64_t timeout, Callback callback, void *data) -> void {
+        TimingWheel::current().arm(entry_, timeout, callback, data);
+    }
+
+    auto stop() noexcept -> void {
+        entry_.cancel();
+    }
+
+private:
+    TimerEntry entry_;
+};
+
+} // namespace uvio::time::detail
@@ -0,0 +1,307 @@
+#pragma once
+
+#include "uvio/debug.hpp"
+#include "uvio/runtime/context.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#include "uv.h"
+
+namespace uvio::time::detail {
+
+class TimingWheel;
+
+// Intrusive node of a `TimingWheel`, armed entries are linked into one slot
+// of the wheel so that arming and cancelling never allocate
+class TimerEntry {
+    friend class TimingWheel;
+
+public:
+    using Callback = void (*)(void *data);
+
+public:
+    TimerEntry() = default;
+
+    ~TimerEntry() {
+        cancel();
+    }
+
+    // No copy, no move (linked into the wheel)
+    TimerEntry(const TimerEntry &) = delete;
+    auto operator=(const TimerEntry &) = delete;
+    TimerEntry(TimerEntry &&) = delete;
+    auto operator=(TimerEntry &&) = delete;
+
+public:
+    [[nodiscard]]
+    auto is_armed() const noexcept -> bool {
+        return wheel_ != nullptr;
+    }
+
+    inline auto cancel() noexcept -> void;
+
+private:
+    TimingWheel *wheel_{nullptr};
+    TimerEntry  *prev_{nullptr};
+    TimerEntry  *next_{nullptr};
+    uint64_t     deadline_{0};
+    std::size_t  list_{0};
+    Callback     callback_{nullptr};
+    void        *data_{nullptr};
+};
+
+// Hierarchical timing wheel of one loop, in milliseconds. Six levels of 64
+// slots cover about two years; an entry sits in the level of the highest bit
+// in which its deadline differs from the wheel's clock and is moved down
+// when its slot comes up. Arm and cancel are O(1), and the loop only sees a
+// single uv_timer_t set to the next expiration.
+class TimingWheel {
+    constexpr static std::size_t SLOT_BITS{6};
+    constexpr static std::size_t NUM_SLOTS{1 << SLOT_BITS};
+    constexpr static std::size_t NUM_LEVELS{6};
+    // Index of the list holding the expired entries about to be fired
+    constexpr static std::size_t PENDING{NUM_SLOTS * NUM_LEVELS};
+
+public:
+    // Longer timeouts are clamped (about a year)
+    constexpr static uint64_t MAX_TIMEOUT{uint64_t{1} << 35};
+
+public:
+    explicit TimingWheel(uv_loop_t *loop)
+        : loop_{loop}
+        , start_{uv_now(loop)} {
+        uv_check(uv_timer_init(loop_, &timer_));
+        timer_.data = this;
+    }
+
+    // Entries still armed are detached, `close()` must have been called
+    ~TimingWheel() {
+        for (auto &head : lists_) {
+            for (auto entry = head; entry != nullptr; entry = entry->next_) {
+                entry->wheel_ = nullptr;
+            }
+        }
+    }
+
+    // No copy, no move (the timer points back to this object)
+    TimingWheel(const TimingWheel &) = delete;
+    auto operator=(const TimingWheel &) = delete;
+    TimingWheel(TimingWheel &&) = delete;
+    auto operator=(TimingWheel &&) = delete;
+
+public:
+    // Wheel of the loop driven by the calling thread
+    [[nodiscard]]
+    inline static auto current() -> TimingWheel &;
+
+    // Call `callback(data)` from the loop in `timeout` milliseconds, an entry
+    // that is already armed is moved
+    auto arm(TimerEntry          &entry,
+             uint64_t             timeout,
+             TimerEntry::Callback callback,
+             void                *data) -> void {
+        entry.cancel();
+        entry.wheel_ = this;
+        entry.callback_ = callback;
+        entry.data_ = data;
+        entry.deadline_ = now() + std::min(timeout, MAX_TIMEOUT);
+        insert(entry);
+        size_++;
+        if (!scheduled_ || entry.deadline_ < scheduled_deadline_) {
+            schedule(entry.deadline_);
+        }
+    }
+
+    // Only stops the loop timer once the wheel is empty, so that a cancelled
+    // deadline does not keep the loop alive; otherwise a wake-up for nothing
+    // is cheaper than restarting it
+    auto remove(TimerEntry &entry) noexcept -> void {
+        unlink(entry);
+        entry.wheel_ = nullptr;
+        if (--size_ == 0 && scheduled_) {
+            scheduled_ = false;
+            uv_timer_stop(&timer_);
+        }
+    }
+
+    [[nodiscard]]
+    auto size() const noexcept -> std::size_t {
+        return size_;
+    }
+
+    auto close() -> void {
+        if (uv_is_closing(reinterpret_cast<uv_handle_t *>(&timer_)) == 0) {
+            uv_close(reinterpret_cast<uv_handle_t *>(&timer_), nullptr);
+        }
+    }
+
+private:
+    struct Expiration {
+        std::size_t level_;
+        std::size_t slot_;
+        uint64_t    deadline_;
+    };
+
+    [[nodiscard]]
+    auto now() const noexcept -> uint64_t {
+        return uv_now(loop_) - start_;
+    }
+
+    [[nodiscard]]
+    constexpr static auto list_index(std::size_t level, std::size_t slot)
+        -> std::size_t {
+        return level * NUM_SLOTS + slot;
+    }
+
+    auto insert(TimerEntry &entry) noexcept -> void {
+        auto deadline = std::max(entry.deadline_, elapsed_);
+        // `| (NUM_SLOTS - 1)` keeps deadlines in the current slot on level 0
+        auto significant
+            = std::bit_width((elapsed_ ^ deadline) | (NUM_SLOTS - 1)) - 1;
+        auto level = std::min(static_cast<std::size_t>(significant) / SLOT_BITS,
+                              NUM_LEVELS - 1);
+        auto slot = (deadline >> (level * SLOT_BITS)) & (NUM_SLOTS - 1);
+        link(entry, list_index(level, slot));
+        occupied_[level] |= uint64_t{1} << slot;
+    }
+
+    auto link(TimerEntry &entry, std::size_t list) noexcept -> void {
+        auto &head = lists_[list];
+        entry.list_ = list;
+        entry.prev_ = nullptr;
+        entry.next_ = head;
+        if (head != nullptr) {
+            head->prev_ = &entry;
+        }
+        head = &entry;
+    }
+
+    auto unlink(TimerEntry &entry) noexcept -> void {
+        auto &head = lists_[entry.list_];
+        if (entry.prev_ != nullptr) {
+            entry.prev_->next_ = entry.next_;
+        } else {
+            head = entry.next_;
+        }
+        if (entry.next_ != nullptr) {
+            entry.next_->prev_ = entry.prev_;
+        }
+        entry.prev_ = entry.next_ = nullptr;
+        if (head == nullptr && entry.list_ != PENDING) {
+            occupied_[entry.list_ / NUM_SLOTS]
+                &= ~(uint64_t{1} << (entry.list_ % NUM_SLOTS));
+        }
+    }
+
+    // Earliest occupied slot over all levels, for levels above 0 that is the
+    // time the slot has to be cascaded
+    [[nodiscard]]
+    auto next_expiration() const noexcept -> std::optional<Expiration> {
+        std::optional<Expiration> next{std::nullopt};
+        for (std::size_t level = 0; level < NUM_LEVELS; level++) {
+            if (occupied_[level] == 0) {
+                continue;
+            }
+            auto shift = level * SLOT_BITS;
+            auto pos = (elapsed_ >> shift) & (NUM_SLOTS - 1);
+            auto distance = std::countr_zero(
+                std::rotr(occupied_[level], static_cast<int>(pos)));
+            auto slot = (pos + distance) & (NUM_SLOTS - 1);
+            auto level_range = uint64_t{1} << (shift + SLOT_BITS);
+            auto deadline = (elapsed_ & ~(level_range - 1)) + (slot << shift);
+            if (slot < pos) {
+                deadline += level_range;
+            }
+            if (!next || deadline < next->deadline_) {
+                next = Expiration{level, slot, deadline};
+            }
+        }
+        return next;
+    }
+
+    auto schedule(uint64_t deadline) -> void {
+        auto current = now();
+        scheduled_ = true;
+        scheduled_deadline_ = deadline;
+        uv_check(uv_timer_start(
+            &timer_,
+            [](uv_timer_t *timer) {
+                static_cast<TimingWheel *>(timer->data)->on_timer();
+            },
+            deadline > current ? deadline - current : 0,
+            0));
+    }
+
+    auto on_timer() -> void {
+        auto current = now();
+        while (auto expiration = next_expiration()) {
+            if (expiration->deadline_ > current) {
+                break;
+            }
+            elapsed_ = std::max(elapsed_, expiration->deadline_);
+            auto list = list_index(expiration->level_, expiration->slot_);
+            auto entry = std::exchange(lists_[list], nullptr);
+            occupied_[expiration->level_]
+                &= ~(uint64_t{1} << expiration->slot_);
+            while (entry != nullptr) {
+                auto next = entry->next_;
+                if (entry->deadline_ <= current) {
+                    link(*entry, PENDING);
+                } else {
+                    insert(*entry);
+                }
+                entry = next;
+            }
+        }
+        elapsed_ = current;
+
+        // Callbacks may arm new entries or cancel pending ones
+        while (auto entry = lists_[PENDING]) {
+            remove(*entry);
+            entry->callback_(entry->data_);
+        }
+
+        if (auto next = next_expiration()) {
+            schedule(next->deadline_);
+        } else {
+            scheduled_ = false;
+            uv_check(uv_timer_stop(&timer_));
+        }
+    }
+
+private:
+    uv_loop_t  *loop_;
+    uv_timer_t  timer_{};
+    // Loop time of tick 0
+    uint64_t    start_;
+    uint64_t    elapsed_{0};
+    std::size_t size_{0};
+    bool        scheduled_{false};
+    uint64_t    scheduled_deadline_{0};
+
+    std::array<uint64_t, NUM_LEVELS>      occupied_{};
+    std::array<TimerEntry *, PENDING + 1> lists_{};
+};
+
+inline auto TimerEntry::cancel() noexcept -> void {
+    if (wheel_ != nullptr) {
+        wheel_->remove(*this);
+    }
+}
+
+inline auto TimingWheel::current() -> TimingWheel & {
+    if (auto context = uvio::detail::current_context;
+        context != nullptr && context->timers_ != nullptr) [[likely]] {
+        return *context->timers_;
+    }
+    // Plain libuv code outside of a runtime, never closed
+    thread_local auto *fallback = new TimingWheel{uv_default_loop()};
+    return *fallback;
+}
+
+} // namespace uvio::time::detail
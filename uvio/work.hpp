@@ -1,62 +1,131 @@
 #pragma once
 
+#include "uvio/common/result.hpp"
+#include "uvio/coroutine/task.hpp"
 #include "uvio/debug.hpp"
 #include "uvio/macros.hpp"
+#include "uvio/runtime/waker.hpp"
+#include "uvio/work/blocking_pool.hpp"
+#include "uvio/work/parallel.hpp"
 
 #include <coroutine>
-#include <functional>
-
-#include "uv.h"
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <variant>
 
 namespace uvio::work {
 
 namespace detail {
 
-    struct WorkAwaiter {
-        std::coroutine_handle<> handle_;
-        uv_work_t               work_{};
-        std::function<void()>   func_;
-        int                     status_{1};
-
-        WorkAwaiter(std::function<void()> &&func)
-            : func_{std::move(func)} {
-            work_.data = this;
-
-            uv_check(uv_queue_work(
-                uv_default_loop(),
-                &work_,
-                [](uv_work_t *work_req) {
-                    auto data = static_cast<WorkAwaiter *>(work_req->data);
-                    data->func_();
-                },
-                [](uv_work_t *work_req, int status) {
-                    auto data = static_cast<WorkAwaiter *>(work_req->data);
-                    data->status_ = status;
-
-                    if (data->handle_) {
-                        data->handle_.resume();
-                    }
-                }));
-        }
+    // Runs `func` on the blocking pool and resumes the awaiting coroutine on
+    // its loop with the returned value
+    template <typename F>
+    class BlockingAwaiter : BlockingJob {
+        using R = std::invoke_result_t<F &>;
+        using Value = std::conditional_t<std::is_void_v<R>, std::monostate, R>;
+
+    public:
+        BlockingAwaiter(F func, Lane lane)
+            : BlockingJob{.run_ = run}
+            , func_{std::move(func)}
+            , lane_{lane} {}
+
+        // No copy, no move (queued on the pool)
+        BlockingAwaiter(const BlockingAwaiter &) = delete;
+        auto operator=(const BlockingAwaiter &) = delete;
+        BlockingAwaiter(BlockingAwaiter &&) = delete;
+        auto operator=(BlockingAwaiter &&) = delete;
 
+    public:
         auto await_ready() const noexcept -> bool {
-            return status_ <= 0;
+            return false;
         }
 
-        auto await_suspend(std::coroutine_handle<> handle) noexcept {
-            handle_ = handle;
+        template <typename Promise>
+        auto await_suspend(std::coroutine_handle<Promise> handle) -> bool {
+            if (!cancellation_.register_callback(
+                    uvio::detail::cancellation_token_of(handle),
+                    on_cancel,
+                    this)) {
+                cancelled_ = true;
+                return false;
+            }
+            // Submitted only now, the job may complete right away
+            waker_ = uvio::detail::Waker::current(handle);
+            BlockingPool::global().submit(this, lane_);
+            return true;
         }
 
-        auto await_resume() noexcept {
-            handle_ = nullptr;
-        };
+        auto await_resume() -> Result<R> {
+            cancellation_.reset();
+            if (cancelled_) {
+                return unexpected{make_uvio_error(Error::Cancelled)};
+            }
+            if (exception_) [[unlikely]] {
+                std::rethrow_exception(exception_);
+            }
+            if constexpr (std::is_void_v<R>) {
+                return {};
+            } else {
+                return std::move(*value_);
+            }
+        }
+
+    private:
+        // On a thread of the pool
+        static auto run(BlockingJob *job) -> void {
+            auto self = static_cast<BlockingAwaiter *>(job);
+            try {
+                if constexpr (std::is_void_v<R>) {
+                    self->func_();
+                    self->value_.emplace();
+                } else {
+                    self->value_.emplace(self->func_());
+                }
+            } catch (...) {
+                // Rethrown on the awaiting loop
+                self->exception_ = std::current_exception();
+            }
+            self->waker_.wake();
+        }
+
+        // Only a job still queued can be cancelled, one already running on
+        // the pool completes normally
+        static auto on_cancel(void *data) -> void {
+            auto self = static_cast<BlockingAwaiter *>(data);
+            if (BlockingPool::global().try_cancel(self)) {
+                self->cancelled_ = true;
+                self->waker_.wake();
+            }
+        }
+
+    private:
+        F                        func_;
+        Lane                     lane_;
+        uvio::detail::Waker      waker_;
+        std::optional<Value>     value_;
+        std::exception_ptr       exception_{};
+        bool                     cancelled_{false};
+        CancellationRegistration cancellation_;
     };
 
 } // namespace detail
 
+// Run the blocking call `func` on the blocking pool, without holding up the
+// loop: `auto value = co_await spawn_blocking([] { return compute(); });`
+// yields a `Result` of what `func` returns.
+template <typename F>
+[[REMEMBER_CO_AWAIT]]
+static inline auto spawn_blocking(F &&func, Lane lane = Lane::Normal) {
+    return detail::BlockingAwaiter<std::decay_t<F>>{std::forward<F>(func),
+                                                    lane};
+}
+
+template <typename F>
 [[REMEMBER_CO_AWAIT]]
-static inline auto execute(std::function<void()> func) {
-    return detail::WorkAwaiter{std::move(func)};
+static inline auto execute(F &&func) {
+    return spawn_blocking(std::forward<F>(func));
 }
 
 } // namespace uvio::work
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "uvio/debug.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace uvio::work {
+
+enum class Lane {
+    Normal,
+    // Served before normal jobs, and by threads that never run normal jobs
+    High,
+};
+
+struct BlockingPoolOptions {
+    std::size_t num_threads{
+        std::max<std::size_t>(std::thread::hardware_concurrency(), 4)};
+    // Extra threads reserved to the high-priority lane
+    std::size_t num_high_priority_threads{1};
+};
+
+namespace detail {
+
+    // Job queued on a `BlockingPool`, embedded in the awaiter that submitted
+    // it so that submitting never allocates
+    struct BlockingJob {
+        void (*run_)(BlockingJob *job){nullptr};
+        BlockingJob *next_{nullptr};
+    };
+
+    // Thread pool for blocking calls, separate from the libuv thread pool so
+    // that long jobs cannot hold back DNS resolution or fs requests
+    class BlockingPool {
+        // Intrusive FIFO
+        struct JobList {
+            BlockingJob *head_{nullptr};
+            BlockingJob *tail_{nullptr};
+
+            [[nodiscard]]
+            auto empty() const noexcept -> bool {
+                return head_ == nullptr;
+            }
+
+            auto push(BlockingJob *job) noexcept -> void {
+                job->next_ = nullptr;
+                if (tail_ != nullptr) {
+                    tail_->next_ = job;
+                } else {
+                    head_ = job;
+                }
+                tail_ = job;
+            }
+
+            auto pop() noexcept -> BlockingJob * {
+                auto job = head_;
+                head_ = job->next_;
+                if (head_ == nullptr) {
+                    tail_ = nullptr;
+                }
+                return job;
+            }
+
+            auto remove(BlockingJob *job) noexcept -> bool {
+                BlockingJob *prev = nullptr;
+                for (auto node = head_; node != nullptr; node = node->next_) {
+                    if (node != job) {
+                        prev = node;
+                        continue;
+                    }
+                    (prev != nullptr ? prev->next_ : head_) = node->next_;
+                    if (tail_ == node) {
+                        tail_ = prev;
+                    }
+                    return true;
+                }
+                return false;
+            }
+        };
+
+    public:
+        explicit BlockingPool(BlockingPoolOptions options)
+            : num_threads_{options.num_threads} {
+            ASSERT(num_threads_ >= 1);
+            for (std::size_t i = 0; i < options.num_threads; i++) {
+                threads_.emplace_back([this]() { run(false); });
+            }
+            for (std::size_t i = 0; i < options.num_high_priority_threads;
+                 i++) {
+                threads_.emplace_back([this]() { run(true); });
+            }
+        }
+
+        // Jobs still queued are dropped
+        ~BlockingPool() {
+            {
+                std::lock_guard lock{mutex_};
+                stopped_ = true;
+            }
+            any_job_.notify_all();
+            high_job_.notify_all();
+            for (auto &thread : threads_) {
+                thread.join();
+            }
+        }
+
+        // No copy, no move
+        BlockingPool(const BlockingPool &) = delete;
+        auto operator=(const BlockingPool &) = delete;
+        BlockingPool(BlockingPool &&) = delete;
+        auto operator=(BlockingPool &&) = delete;
+
+    public:
+        // Pool shared by all the runtimes, started on first use
+        [[nodiscard]]
+        static auto global() -> BlockingPool & {
+            static BlockingPool pool{
+                configured().value_or(BlockingPoolOptions{})};
+            return pool;
+        }
+
+        // Must be called before the first blocking job is submitted
+        static auto configure(BlockingPoolOptions options) -> void {
+            configured() = options;
+        }
+
+        auto submit(BlockingJob *job, Lane lane) -> void {
+            {
+                std::lock_guard lock{mutex_};
+                (lane == Lane::High ? high_ : normal_).push(job);
+            }
+            any_job_.notify_one();
+            if (lane == Lane::High) {
+                high_job_.notify_one();
+            }
+        }
+
+        // Threads serving the normal lane
+        [[nodiscard]]
+        auto num_threads() const noexcept -> std::size_t {
+            return num_threads_;
+        }
+
+        // Remove a job nobody started yet, false if it is running or done
+        auto try_cancel(BlockingJob *job) -> bool {
+            std::lock_guard lock{mutex_};
+            return high_.remove(job) || normal_.remove(job);
+        }
+
+    private:
+        static auto configured() -> std::optional<BlockingPoolOptions> & {
+            static std::optional<BlockingPoolOptions> options;
+            return options;
+        }
+
+        auto run(bool high_only) -> void {
+            auto &cond = high_only ? high_job_ : any_job_;
+            while (true) {
+                BlockingJob *job = nullptr;
+                {
+                    std::unique_lock lock{mutex_};
+                    cond.wait(lock, [this, high_only]() {
+                        return stopped_ || !high_.empty()
+                               || (!high_only && !normal_.empty());
+                    });
+                    if (stopped_) {
+                        return;
+                    }
+                    job = !high_.empty() ? high_.pop() : normal_.pop();
+                }
+                job->run_(job);
+            }
+        }
+
+    private:
+        std::size_t              num_threads_;
+        std::mutex               mutex_;
+        std::condition_variable  any_job_;
+        std::condition_variable  high_job_;
+        JobList                  normal_;
+        JobList                  high_;
+        bool                     stopped_{false};
+        std::vector<std::thread> threads_;
+    };
+
+} // namespace detail
+
+// Size the pool used by `spawn_blocking()`, before its first call
+static inline auto configure_blocking_pool(BlockingPoolOptions options) {
+    detail::BlockingPool::configure(options);
+}
+
+} // namespace uvio::work
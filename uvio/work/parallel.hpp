@@ -0,0 +1,259 @@
+#pragma once
+
+#include "uvio/common/result.hpp"
+#include "uvio/coroutine/task.hpp"
+#include "uvio/macros.hpp"
+#include "uvio/runtime/waker.hpp"
+#include "uvio/work/blocking_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace uvio::work {
+
+namespace detail {
+
+    // Hands out the indices of [0, size) in chunks of at least `grain`, large
+    // ones first and smaller ones as the range runs out (guided scheduling),
+    // so that threads done early take over what is left of the others' share
+    class ChunkDispenser {
+    public:
+        using Chunk = std::pair<std::size_t, std::size_t>;
+
+    public:
+        ChunkDispenser(std::size_t size, std::size_t grain, std::size_t parts)
+            : size_{size}
+            , grain_{std::max<std::size_t>(grain, 1)}
+            , parts_{std::max<std::size_t>(parts, 1)} {}
+
+        auto next() noexcept -> std::optional<Chunk> {
+            auto begin = next_.load(std::memory_order::relaxed);
+            while (begin < size_) {
+                auto length = std::max(grain_, (size_ - begin) / parts_);
+                auto end = std::min(size_, begin + length);
+                if (next_.compare_exchange_weak(begin,
+                                                end,
+                                                std::memory_order::relaxed)) {
+                    return Chunk{begin, end};
+                }
+            }
+            return std::nullopt;
+        }
+
+        // Give out nothing more, false if everything was already given out
+        auto stop() noexcept -> bool {
+            return next_.exchange(size_, std::memory_order::relaxed) < size_;
+        }
+
+    private:
+        std::size_t              size_;
+        std::size_t              grain_;
+        std::size_t              parts_;
+        std::atomic<std::size_t> next_{0};
+    };
+
+    // Runs `kernel(partial, begin, end)` over the chunks of [0, size) on the
+    // blocking pool, one `Partial` per helper thread, and resumes the awaiting
+    // coroutine once every helper is done
+    template <typename Kernel, typename Partial>
+    class ParallelAwaiter {
+        struct Helper : BlockingJob {
+            ParallelAwaiter *self_{nullptr};
+            Partial          partial_{};
+        };
+
+    public:
+        ParallelAwaiter(Kernel kernel, std::size_t size, std::size_t grain)
+            : kernel_{std::move(kernel)}
+            , chunks_{size, grain, 2 * BlockingPool::global().num_threads()} {
+            grain = std::max<std::size_t>(grain, 1);
+            helpers_.resize(std::min(BlockingPool::global().num_threads(),
+                                     (size + grain - 1) / grain));
+            for (auto &helper : helpers_) {
+                helper.run_ = run;
+                helper.self_ = this;
+            }
+        }
+
+        // No copy, no move (queued on the pool)
+        ParallelAwaiter(const ParallelAwaiter &) = delete;
+        auto operator=(const ParallelAwaiter &) = delete;
+        ParallelAwaiter(ParallelAwaiter &&) = delete;
+        auto operator=(ParallelAwaiter &&) = delete;
+
+    public:
+        auto await_ready() const noexcept -> bool {
+            return helpers_.empty();
+        }
+
+        template <typename Promise>
+        auto await_suspend(std::coroutine_handle<Promise> handle) -> bool {
+            if (!cancellation_.register_callback(
+                    uvio::detail::cancellation_token_of(handle),
+                    on_cancel,
+                    this)) {
+                chunks_.stop();
+                cancelled_ = true;
+                return false;
+            }
+            waker_ = uvio::detail::Waker::current(handle);
+            running_.store(helpers_.size(), std::memory_order::relaxed);
+            for (auto &helper : helpers_) {
+                BlockingPool::global().submit(&helper, Lane::Normal);
+            }
+            return true;
+        }
+
+        auto await_resume() -> Result<void> {
+            cancellation_.reset();
+            if (exception_) [[unlikely]] {
+                std::rethrow_exception(exception_);
+            }
+            if (cancelled_.load(std::memory_order::relaxed)) {
+                return unexpected{make_uvio_error(Error::Cancelled)};
+            }
+            return {};
+        }
+
+        // What every helper accumulated, once awaited
+        template <typename F>
+        auto for_each_partial(F &&func) -> void {
+            for (auto &helper : helpers_) {
+                func(helper.partial_);
+            }
+        }
+
+    private:
+        // On a thread of the pool
+        static auto run(BlockingJob *job) -> void {
+            auto helper = static_cast<Helper *>(job);
+            auto self = helper->self_;
+            try {
+                while (auto chunk = self->chunks_.next()) {
+                    self->kernel_(helper->partial_,
+                                  chunk->first,
+                                  chunk->second);
+                }
+            } catch (...) {
+                // The first one stops the other helpers, and is rethrown on
+                // the awaiting loop
+                self->chunks_.stop();
+                std::lock_guard lock{self->exception_mutex_};
+                if (!self->exception_) {
+                    self->exception_ = std::current_exception();
+                }
+            }
+            if (self->running_.fetch_sub(1, std::memory_order::acq_rel) == 1) {
+                self->waker_.wake();
+            }
+        }
+
+        // Chunks being run are completed, the others are dropped
+        static auto on_cancel(void *data) -> void {
+            auto self = static_cast<ParallelAwaiter *>(data);
+            if (self->chunks_.stop()) {
+                self->cancelled_.store(true, std::memory_order::relaxed);
+            }
+        }
+
+    private:
+        Kernel                   kernel_;
+        ChunkDispenser           chunks_;
+        std::vector<Helper>      helpers_;
+        std::atomic<std::size_t> running_{0};
+        std::atomic<bool>        cancelled_{false};
+        std::mutex               exception_mutex_;
+        std::exception_ptr       exception_{};
+        uvio::detail::Waker      waker_;
+        CancellationRegistration cancellation_;
+    };
+
+    template <typename V, typename T, typename Map, typename Reduce>
+    auto map_reduce_view(V           view,
+                         std::size_t grain,
+                         T           init,
+                         Map         map,
+                         Reduce      reduce) -> Task<Result<T>> {
+        auto size = static_cast<std::size_t>(std::ranges::distance(view));
+        auto kernel = [&view, &map, &reduce](std::optional<T> &partial,
+                                             std::size_t       begin,
+                                             std::size_t       end) {
+            auto first = std::ranges::begin(view);
+            for (auto i = begin; i < end; i++) {
+                if (partial) {
+                    partial = reduce(std::move(*partial), map(first[i]));
+                } else {
+                    partial.emplace(map(first[i]));
+                }
+            }
+        };
+        ParallelAwaiter<decltype(kernel), std::optional<T>> awaiter{
+            std::move(kernel),
+            size,
+            grain};
+        if (auto ret = co_await awaiter; !ret) {
+            co_return unexpected{ret.error()};
+        }
+
+        awaiter.for_each_partial([&init, &reduce](std::optional<T> &partial) {
+            if (partial) {
+                init = reduce(std::move(init), std::move(*partial));
+            }
+        });
+        co_return std::move(init);
+    }
+
+} // namespace detail
+
+// Call `func(element)` for every element of `range` on the blocking pool, in
+// chunks of at least `grain` elements. `func` runs on several threads at once.
+// e.g. `co_await parallel_for(std::views::iota(0, n), 1024, body);`
+template <std::ranges::random_access_range R, typename F>
+[[REMEMBER_CO_AWAIT]]
+static inline auto parallel_for(R &&range, std::size_t grain, F &&func) {
+    auto size = static_cast<std::size_t>(std::ranges::distance(range));
+    auto kernel = [view = std::views::all(std::forward<R>(range)),
+                   func = std::forward<F>(func)](std::monostate &,
+                                                 std::size_t begin,
+                                                 std::size_t end) {
+        auto first = std::ranges::begin(view);
+        for (auto i = begin; i < end; i++) {
+            func(first[i]);
+        }
+    };
+    return detail::ParallelAwaiter<decltype(kernel), std::monostate>{
+        std::move(kernel),
+        size,
+        grain};
+}
+
+// Fold `reduce(acc, map(element))` over `range` on the blocking pool, starting
+// from `init`. `reduce` must be associative and commutative, as partial
+// results of every thread are combined in no particular order.
+template <std::ranges::random_access_range R,
+          typename T,
+          typename Map,
+          typename Reduce>
+[[REMEMBER_CO_AWAIT]]
+static inline auto map_reduce(R          &&range,
+                              std::size_t grain,
+                              T            init,
+                              Map          map,
+                              Reduce       reduce) -> Task<Result<T>> {
+    // The task starts once awaited, so an rvalue range is moved into it
+    return detail::map_reduce_view(std::views::all(std::forward<R>(range)),
+                                   grain,
+                                   std::move(init),
+                                   std::move(map),
+                                   std::move(reduce));
+}
+
+} // namespace uvio::work